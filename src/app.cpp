@@ -1,5 +1,6 @@
 #include "app.h"
 #include <psp2/ctrl.h>
+#include <psp2/display.h>
 #include <psp2/kernel/processmgr.h>
 #include <psp2/kernel/modulemgr.h>
 #include <psp2/kernel/sysmem.h>
@@ -42,6 +43,14 @@
 #include "image_utils.h"
 #include "sessions.h"
 #include "input.h"
+#include "stream.h"
+#include "net_worker.h"
+#include "payload.h"
+#include "image_resize.h"
+#include "texture_cache.h"
+#include "image_saver.h"
+#include "persist_writer.h"
+#include "text_metrics.h"
 
 // color palette
 #define MONO_BLACK RGBA8(0, 0, 0, 255)           
@@ -54,6 +63,17 @@
 const unsigned int FADE_SPEED = 8;
 const unsigned int CAMERA_FADE_SPEED = 15;
 
+#define TEXT_METRICS_PATH "ux0:data/vela/text_metrics.txt"
+
+struct FramePacingStats {
+    unsigned int drawn = 0;
+    unsigned int skipped = 0;
+    SceUInt64 drawn_us = 0;    // loop time, not counting the wait for vblank
+    SceUInt64 skipped_us = 0;
+};
+
+static FramePacingStats s_pacing;
+
 
 std::string trim_whitespace(const std::string& str) {
     const auto begin = str.find_first_not_of(" \t\n\r\f\v");
@@ -65,6 +85,198 @@ std::string trim_whitespace(const std::string& str) {
     return str.substr(begin, end - begin + 1);
 }
 
+// Updates an LLM message with (possibly partial) response text and rewraps it
+static void set_llm_message_text(vita2d_pgf* pgf, ChatMessage& msg, const std::string& content, const std::string& reasoning) {
+    msg.text = trim_whitespace(content);
+    msg.reasoning = trim_whitespace(reasoning);
+    msg.payload_json.reset();
+    wrap_message(pgf, msg, BUBBLE_CONTENT_WIDTH);
+}
+
+// Queues a chat completion for the current session and adds the reply placeholder
+static void send_chat_request(AppContext& ctx, const std::string& question, vita2d_texture* photo) {
+    NetRequest request;
+    request.kind = NetRequestKind::CHAT;
+    request.endpoint = ctx.settings.endpoint;
+    request.api_key = ctx.settings.apiKey;
+    request.model = (ctx.selected_model_index >= 0 && ctx.selected_model_index < ctx.available_models.size()) ? 
+                    ctx.available_models[ctx.selected_model_index] : MODEL;
+
+    if (photo != NULL) {
+        // Copy the pixels so encoding can happen on the worker without touching the texture,
+        // shrinking them to the upload size for this model on the way
+        int width = vita2d_texture_get_width(photo);
+        int height = vita2d_texture_get_height(photo);
+        const unsigned char* pixels = static_cast<const unsigned char*>(vita2d_texture_get_datap(photo));
+        if (pixels) {
+            int upload_width, upload_height;
+            image_fit_size(width, height, image_max_edge_for(ctx.settings, request.model), upload_width, upload_height);
+            image_downscale_rgba(pixels, width, height, vita2d_texture_get_stride(photo), request.image_rgba, upload_width, upload_height);
+            request.image_width = upload_width;
+            request.image_height = upload_height;
+            request.image_quality = ctx.settings.image_quality;
+        }
+        request.prompt = question;
+    } else {
+        // Only messages added since the last turn get serialized; the rest come from their cached fragments
+        request.body = build_chat_payload(request.model, ctx.sessions[ctx.current_session_index].messages, true);
+    }
+
+    // Add the in-flight LLM message up front so deltas show up as they stream in
+    ChatMessage llm_msg;
+    llm_msg.sender = ChatMessage::LLM;
+    llm_msg.alpha = 0;
+    ChatSession& session = ctx.sessions[ctx.current_session_index];
+    session.messages.push_back(llm_msg);
+    session.dirty = true;
+
+    ctx.reply_session_index = ctx.current_session_index;
+    ctx.reply_message_index = session.messages.size() - 1;
+    ctx.reply_content.clear();
+    ctx.reply_reasoning.clear();
+    ctx.reply_request_id = net_worker_submit(std::move(request));
+}
+
+static void request_models(AppContext& ctx) {
+    if (ctx.models_request_id >= 0) {
+        net_worker_cancel(ctx.models_request_id);
+    }
+
+    NetRequest request;
+    request.kind = NetRequestKind::FETCH_MODELS;
+    request.endpoint = ctx.settings.endpoint;
+    request.api_key = ctx.settings.apiKey;
+    // Taken from memory: the settings file may still be waiting on the persistence writer
+    auto override_it = ctx.settings.models_endpoint_overrides.find(ctx.settings.endpoint);
+    if (override_it != ctx.settings.models_endpoint_overrides.end()) {
+        request.models_url = override_it->second;
+    }
+    ctx.models_request_id = net_worker_submit(std::move(request));
+    ctx.is_fetching_models = true;
+    ctx.fetch_scheduled = true;
+}
+
+static void apply_fetched_models(AppContext& ctx, const std::vector<std::string>& models) {
+    ctx.available_models = models;
+
+    if (ctx.available_models.empty()) {
+        ctx.selected_model_index = -1;
+    } else {
+        // Check if there's a default model for the current endpoint
+        if (ctx.settings.default_models.count(ctx.settings.endpoint) > 0) {
+            const std::string& default_model = ctx.settings.default_models.at(ctx.settings.endpoint);
+            auto it = std::find(ctx.available_models.begin(), ctx.available_models.end(), default_model);
+            if (it != ctx.available_models.end()) {
+                // Default model found, set it as selected
+                ctx.selected_model_index = std::distance(ctx.available_models.begin(), it);
+            } else {
+                // Default model not found in the available list, fallback to first model
+                ctx.selected_model_index = 0;
+            }
+        } else {
+            // No default model, select the first one
+            ctx.selected_model_index = 0;
+        }
+    }
+    
+    ctx.hovered_model_index = ctx.selected_model_index;
+    ctx.connection_failed = ctx.available_models.empty();
+    ctx.is_fetching_models = false;
+    ctx.fetch_scheduled = false;
+    ctx.models_loaded = true;  // Mark models as loaded to trigger the rest of the UI to fade in
+}
+
+// Hands photos whose files are now on disk over to their thumbnails
+static void process_image_saves(AppContext& ctx) {
+    std::vector<ImageSaveResult> results;
+    image_saver_poll(results);
+    if (!results.empty()) {
+        ctx.frame_dirty = true;
+    }
+
+    for (const auto& result : results) {
+        if (apply_image_save_result(ctx.sessions, result)) {
+            save_sessions(ctx.sessions);
+        }
+    }
+}
+
+// Applies everything the network worker finished since the last frame
+static void process_net_events(AppContext& ctx) {
+    std::vector<NetEvent> events;
+    net_worker_poll(events);
+    if (!events.empty()) {
+        ctx.frame_dirty = true;
+    }
+
+    for (const auto& event : events) {
+        if (event.type == NetEventType::MODELS && event.request_id == ctx.models_request_id) {
+            ctx.models_request_id = -1;
+            apply_fetched_models(ctx, event.models);
+        } else if (event.request_id == ctx.reply_request_id) {
+            ChatSession& session = ctx.sessions[ctx.reply_session_index];
+            ChatMessage& msg = session.messages[ctx.reply_message_index];
+            
+            if (event.type == NetEventType::CHAT_DELTA) {
+                ctx.reply_content += event.content;
+                ctx.reply_reasoning += event.reasoning;
+            } else if (event.type == NetEventType::CHAT_DONE) {
+                if (ctx.reply_content.empty() && ctx.reply_reasoning.empty()) {
+                    ctx.reply_content = event.cancelled ? "Cancelled." : event.error;
+                }
+                if (!event.cancelled) {
+                    sceClibPrintf("reply done: finish_reason=%s prompt_tokens=%d completion_tokens=%d\n",
+                                  event.finish_reason.empty() ? "-" : event.finish_reason.c_str(), event.prompt_tokens, event.completion_tokens);
+                }
+                ctx.reply_request_id = -1;
+            }
+            set_llm_message_text(ctx.pgf, msg, ctx.reply_content, ctx.reply_reasoning);
+            chat_layout_invalidate(session, ctx.reply_message_index);
+            msg.dirty = true;
+            session.dirty = true;
+
+            if (ctx.reply_request_id < 0) {
+                // Save sessions after adding an LLM response
+                save_sessions(ctx.sessions);
+            }
+        }
+    }
+}
+
+// Reads a session that was only indexed and wraps whatever hasn't been wrapped yet
+static void open_session(AppContext& ctx, ChatSession& session) {
+    load_session_messages(session);
+    for (size_t i = 0; i < session.messages.size(); i++) {
+        ChatMessage& msg = session.messages[i];
+        if (msg.layout.content_width != BUBBLE_CONTENT_WIDTH) {
+            wrap_message(ctx.pgf, msg, BUBBLE_CONTENT_WIDTH);
+            chat_layout_invalidate(session, i);
+        }
+    }
+    // Chat input runs before the next draw and finds messages through the layout
+    chat_layout_update(ctx.chat_layout, session);
+}
+
+static void draw_chat_frame(AppContext& ctx) {
+    // Get camera texture if camera is active
+    vita2d_texture* camera_tex = NULL;
+    if (ctx.camera_mode_active && camera_is_active() && !ctx.photo_taken) {
+        camera_tex = camera_get_frame_texture();
+    }
+
+    ChatSession& session = ctx.sessions[ctx.current_session_index];
+    chat_layout_update(ctx.chat_layout, session);
+
+    draw_ui(ctx.pgf, session.messages, ctx.chat_layout, ctx.user_question, 
+           ctx.scroll_offset, ctx.current_selection, 
+           ctx.available_models, ctx.model_selection_open ? ctx.hovered_model_index : ctx.selected_model_index, 
+           ctx.model_selection_open, ctx.is_fetching_models, !ctx.available_models.empty() && ctx.reply_request_id < 0, 
+           ctx.ui_alpha, ctx.model_pill_alpha, ctx.camera_mode_active, 
+           ctx.photo_taken ? ctx.staged_photo : camera_tex, ctx.photo_taken, 
+           ctx.staged_photo, ctx.camera_fade_alpha, ctx.model_dropup_h, ctx.hovered_message_index,
+           ctx.start_button_hold_duration);
+}
+
 void initialize_app(AppContext& ctx) {
     // Load system modules
     sceSysmoduleLoadModule(SCE_SYSMODULE_NET);
@@ -83,6 +295,13 @@ void initialize_app(AppContext& ctx) {
     sceNetCtlInit();
     sceHttpInit(1 * 1024 * 1024);
     sceSslInit(1 * 1024 * 1024);
+    net_worker_start(native_transport());
+
+    sceIoMkdir("ux0:data/vela", 0777);
+    sceIoMkdir("ux0:data/vela/images", 0777);
+    image_saver_start(native_image_file_system());
+    persist_writer_start();
+    image_saver_remove_partials("ux0:data/vela/images");
 
     // Init UI and input
     keyboard_init();
@@ -90,6 +309,15 @@ void initialize_app(AppContext& ctx) {
     vita2d_set_clear_color(MONO_BLACK);
     ctx.pgf = vita2d_load_default_pgf();
 
+    // Glyph advances measured on earlier runs
+    text_metrics_init(native_text_metrics_source(ctx.pgf));
+    std::string advance_table;
+    if (persist_read_file(TEXT_METRICS_PATH, advance_table)) {
+        text_metrics_import(advance_table);
+    }
+    text_run_cache_init(native_text_run_backend(ctx.pgf));
+    draw_list_init(native_draw_backend(ctx.pgf));
+
     // Init camera
     ctx.camera_initialized = camera_init();
     ctx.camera_mode_active = false;
@@ -100,6 +328,7 @@ void initialize_app(AppContext& ctx) {
 
     // Load settings
     ctx.settings = load_settings();
+    texture_cache_init(native_texture_allocator(), (size_t)ctx.settings.image_cache_mb * 1024 * 1024);
     ctx.app_state = AppState::CHAT;
     ctx.settings_selection = SettingsSelection::ENDPOINT;
     ctx.settings_model_selection_open = false;
@@ -107,30 +336,18 @@ void initialize_app(AppContext& ctx) {
     
     // Init sessions
     ctx.sessions = load_sessions();
-    ctx.sessions.push_back(ChatSession()); // Add a new blank session
+    ctx.sessions.push_back(new_chat_session()); // Add a new blank session
     ctx.current_session_index = ctx.sessions.size() - 1; // Set the current session to the new blank one
     ctx.session_selection_index = 0;
     ctx.session_scroll_offset = 0;
     ctx.show_delete_confirmation = false;
     ctx.delete_confirmation_selection = false;
 
-    // text wrapping for loaded messages
-    const int BUBBLE_CONTENT_WIDTH = 400 - 30; // Same as when creating new messages
-    for (auto& session : ctx.sessions) {
-        for (auto& msg : session) {
-            msg.wrapped_text = wrap_text(ctx.pgf, msg.text, BUBBLE_CONTENT_WIDTH);
-            if (!msg.reasoning.empty()) {
-                msg.wrapped_reasoning = wrap_text(ctx.pgf, msg.reasoning, BUBBLE_CONTENT_WIDTH - 10);
-            }
-        }
-    }
-
     // Init UI state
     ctx.user_question = "";
     ctx.keyboard_active = false;
     ctx.settings_keyboard_active = false;
     ctx.scroll_offset = 0;
-    ctx.total_history_height = 0;
     ctx.current_selection = UISelection::INPUT_PILL;
     ctx.hovered_message_index = -1; // -1 means no message is hovered
     
@@ -144,12 +361,34 @@ void initialize_app(AppContext& ctx) {
     ctx.models_loaded = false;
     ctx.fetch_scheduled = false;
     ctx.connection_failed = false;
+    ctx.models_request_id = -1;
+
+    // No reply in flight yet
+    ctx.reply_request_id = -1;
+    ctx.reply_session_index = -1;
+    ctx.reply_message_index = -1;
 
     // Initialize animation state
     ctx.model_dropup_h = 0.0f;
     ctx.ui_alpha = 0;  // Start fully transparent
     ctx.model_pill_alpha = 0;  // Model pill also starts fully transparent
     ctx.start_button_hold_duration = 0.0f;
+
+    ctx.frame_dirty = true;
+    idle_pacing_reset(ctx.idle);
+}
+
+// Input that can change the screen: a button down or just released, or a stick pushed
+static bool pad_active(const SceCtrlData& pad, const SceCtrlData& old_pad) {
+    const SceCtrlData* pads[] = { &pad, &old_pad };
+    for (const SceCtrlData* p : pads) {
+        if (p->buttons ||
+            is_left_stick_up(*p) || is_left_stick_down(*p) || is_left_stick_left(*p) || is_left_stick_right(*p) ||
+            is_right_stick_up(*p) || is_right_stick_down(*p) || is_right_stick_left(*p) || is_right_stick_right(*p)) {
+            return true;
+        }
+    }
+    return false;
 }
 
 void run_app(AppContext& ctx) {
@@ -158,7 +397,13 @@ void run_app(AppContext& ctx) {
     
     bool should_exit = false;
     while (!should_exit) {
-        
+        SceUInt64 iteration_start = sceKernelGetProcessTimeWide();
+        bool animating = false;
+
+        process_net_events(ctx);
+        process_image_saves(ctx);
+
+
         if (ctx.photo_to_free) {
             vita2d_free_texture(ctx.photo_to_free);
             ctx.photo_to_free = NULL;
@@ -172,6 +417,7 @@ void run_app(AppContext& ctx) {
             // Fade in model pill at the same rate as the main UI
             ctx.model_pill_alpha += FADE_SPEED;
             if (ctx.model_pill_alpha > 255) ctx.model_pill_alpha = 255;
+            animating = true;
         }
 
         // Handle camera fade-in/out
@@ -179,25 +425,35 @@ void run_app(AppContext& ctx) {
             if (ctx.camera_fade_alpha < 180) { // Target alpha for overlay
                 ctx.camera_fade_alpha += CAMERA_FADE_SPEED;
                 if (ctx.camera_fade_alpha > 180) ctx.camera_fade_alpha = 180;
+                animating = true;
             }
         } else {
             if (ctx.camera_fade_alpha > 0) {
                 ctx.camera_fade_alpha = (ctx.camera_fade_alpha > CAMERA_FADE_SPEED) ? 
                                        ctx.camera_fade_alpha - CAMERA_FADE_SPEED : 0;
+                animating = true;
             }
         }
 
         // Handle model selection slide animation
         float model_dropup_target_h = ctx.model_selection_open ? 
                                      (ctx.available_models.size() * 35 + 15) : 0.0f;
-        ctx.model_dropup_h += (model_dropup_target_h - ctx.model_dropup_h) * 0.25f; // Easing factor
+        if (ctx.model_dropup_h != model_dropup_target_h) {
+            if (fabsf(model_dropup_target_h - ctx.model_dropup_h) < 0.5f) {
+                ctx.model_dropup_h = model_dropup_target_h; // Settle instead of easing forever
+            } else {
+                ctx.model_dropup_h += (model_dropup_target_h - ctx.model_dropup_h) * 0.25f; // Easing factor
+            }
+            animating = true;
+        }
 
         // Handle message fade-in animation
         for (auto& session : ctx.sessions) {
-            for (auto& msg : session) {
+            for (auto& msg : session.messages) {
                 if (msg.alpha < 255) {
                     msg.alpha += 15; // Animation speed
                     if (msg.alpha > 255) msg.alpha = 255;
+                    animating = true;
                 }
             }
         }
@@ -207,44 +463,24 @@ void run_app(AppContext& ctx) {
             ctx.is_fetching_models = true;
         }
         
-        // Perform the actual fetch on the next frame after setting the flag
-        if (ctx.is_fetching_models && !ctx.fetch_scheduled && ctx.startup_counter <= 2) {
-            ctx.fetch_scheduled = true;
-        } else if (ctx.is_fetching_models && ctx.fetch_scheduled && ctx.startup_counter <= 2) {
-            ctx.available_models = fetch_models(ctx.settings.endpoint, ctx.settings.apiKey);
-
-            if (ctx.available_models.empty()) {
-                ctx.selected_model_index = -1;
-            } else {
-                // Check if there's a default model for the current endpoint
-                if (ctx.settings.default_models.count(ctx.settings.endpoint) > 0) {
-                    const std::string& default_model = ctx.settings.default_models.at(ctx.settings.endpoint);
-                    auto it = std::find(ctx.available_models.begin(), ctx.available_models.end(), default_model);
-                    if (it != ctx.available_models.end()) {
-                        // Default model found, set it as selected
-                        ctx.selected_model_index = std::distance(ctx.available_models.begin(), it);
-                    } else {
-                        // Default model not found in the available list, fallback to first model
-                        ctx.selected_model_index = 0;
-                    }
-                } else {
-                    // No default model, select the first one
-                    ctx.selected_model_index = 0;
-                }
-            }
-            
-            ctx.hovered_model_index = ctx.selected_model_index;
-            ctx.is_fetching_models = false;
-            ctx.fetch_scheduled = false;
-            ctx.models_loaded = true;  // Mark models as loaded to trigger the rest of the UI to fade in
+        // Hand the fetch to the network worker on the next frame after setting the flag
+        if (ctx.is_fetching_models && !ctx.fetch_scheduled) {
+            request_models(ctx);
         }
 
         if (ctx.startup_counter < 2) {
             ctx.startup_counter++;
+            animating = true;
         }
 
         sceCtrlPeekBufferPositive(0, &pad, 1);
 
+        // The IME dialog and the camera preview change every frame, and the
+        // frame they close on has to be drawn too
+        if (pad_active(pad, old_pad) || ctx.keyboard_active || ctx.settings_keyboard_active || ctx.camera_mode_active) {
+            ctx.frame_dirty = true;
+        }
+
         // Hold START to exit
         if (pad.buttons & SCE_CTRL_START) {
             ctx.start_button_hold_duration += 1.0f / 60.0f; // Assuming 60 FPS
@@ -268,12 +504,9 @@ void run_app(AppContext& ctx) {
                     ctx.user_question = keyboard_get_text();
                     ctx.keyboard_active = false;
 
-                    const int BUBBLE_CONTENT_WIDTH = 400 - 30; // 400 bubble width, 15px padding each side
-
                     ChatMessage user_msg;
                     user_msg.sender = ChatMessage::USER;
                     user_msg.text = ctx.user_question;
-                    user_msg.wrapped_text = wrap_text(ctx.pgf, ctx.user_question, BUBBLE_CONTENT_WIDTH);
                     user_msg.alpha = 0;
                     
                     // Temporarily hold the photo to be sent. We'll save it later.
@@ -281,174 +514,54 @@ void run_app(AppContext& ctx) {
                     if (ctx.staged_photo) {
                         photo_to_send = ctx.staged_photo;
                         user_msg.image = photo_to_send; // Attach for immediate UI display
+                        user_msg.image_width = vita2d_texture_get_width(photo_to_send);
+                        user_msg.image_height = vita2d_texture_get_height(photo_to_send);
                         ctx.staged_photo = NULL;      // Clear staged photo
                     }
+                    wrap_message(ctx.pgf, user_msg, BUBBLE_CONTENT_WIDTH);
 
-                    ctx.sessions[ctx.current_session_index].push_back(user_msg);
+                    ChatSession& session = ctx.sessions[ctx.current_session_index];
+                    session.messages.push_back(user_msg);
+                    session.dirty = true;
+                    size_t user_msg_index = session.messages.size() - 1;
                     
                     std::string submitted_question = ctx.user_question;
                     ctx.user_question.clear();
 
-                    // --- Animation loop for user message ---
-                    bool user_msg_faded_in = false;
-                    while (!user_msg_faded_in && !should_exit) {
-                        user_msg_faded_in = true;
-                        for (auto& msg : ctx.sessions[ctx.current_session_index]) {
-                            if (msg.alpha < 255) {
-                                msg.alpha += 15;
-                                if (msg.alpha > 255) msg.alpha = 255;
-                                user_msg_faded_in = false; // Still animating
-                            }
-                        }
-
-                        sceCtrlPeekBufferPositive(0, &pad, 1);
-                        // No START check here anymore, handled globally
-                        
-                        // Get camera texture if camera is active
-                        vita2d_texture* camera_tex = NULL;
-                        if (ctx.camera_mode_active && camera_is_active() && !ctx.photo_taken) {
-                            camera_tex = camera_get_frame_texture();
-                        }
-
-                        draw_ui(ctx.pgf, ctx.sessions[ctx.current_session_index], ctx.user_question, 
-                               ctx.scroll_offset, ctx.total_history_height, ctx.current_selection, 
-                               ctx.available_models, ctx.model_selection_open ? ctx.hovered_model_index : ctx.selected_model_index, 
-                               ctx.model_selection_open, ctx.is_fetching_models, !ctx.available_models.empty(), 
-                               ctx.ui_alpha, ctx.model_pill_alpha, ctx.camera_mode_active, 
-                               ctx.photo_taken ? ctx.staged_photo : camera_tex, ctx.photo_taken, 
-                               ctx.staged_photo, ctx.camera_fade_alpha, ctx.model_dropup_h, ctx.hovered_message_index,
-                               ctx.start_button_hold_duration);
-                        vita2d_common_dialog_update();
-                        vita2d_swap_buffers();
-                    }
-                    if(should_exit) continue;
-
-                    // --- Now, save the image and make the network request ---
-
-                    // If there was a photo, save it to a file now and update the message path
+                    // Queue the photo for saving in the background. The message keeps drawing
+                    // the texture until process_image_saves sees the file land on disk.
                     if (photo_to_send) {
-                        std::string image_filename = generate_image_filename(ctx.current_session_index, ctx.sessions[ctx.current_session_index].size() - 1);
-                        if (save_texture_to_file(photo_to_send, image_filename)) {
-                            // Find the message we just added and update its image_path
-                            ctx.sessions[ctx.current_session_index].back().image_path = image_filename;
-                        }
+                        std::string image_filename = generate_image_filename(session.id, user_msg_index);
+                        session.messages[user_msg_index].image_path = image_filename;
+                        image_saver_submit(image_filename, thumbnail_path_for(image_filename), THUMBNAIL_HEIGHT,
+                                           copy_texture_pixels(photo_to_send), user_msg.image_width, user_msg.image_height);
                     }
 
                     // Save sessions right after potentially adding an image path
                     save_sessions(ctx.sessions);
 
-                    std::string model_name = (ctx.selected_model_index >= 0 && ctx.selected_model_index < ctx.available_models.size()) ? 
-                                           ctx.available_models[ctx.selected_model_index] : MODEL;
-                    std::string response_text;
-
-                    if (photo_to_send != NULL) {
-                        // We have an image to send
-                        std::string base64_image = encode_texture_to_base64_png(photo_to_send);
-                        if (!base64_image.empty()) {
-                            response_text = nativePostRequestWithImage(ctx.settings.endpoint, submitted_question, 
-                                                                     base64_image, model_name, ctx.settings.apiKey);
-                        } else {
-                            // Handle encoding error
-                            response_text = "Error: Could not encode image.";
-                        }
-                    } else {
-                        // Build the json obj w conversation history
-                        Json::Value root;
-                        root["model"] = model_name;
-                        
-                        Json::Value messages(Json::arrayValue);
-                        for (const auto& msg : ctx.sessions[ctx.current_session_index]) {
-                            Json::Value message;
-                            if (msg.sender == ChatMessage::USER) {
-                                message["role"] = "user";
-                            } else {
-                                message["role"] = "assistant";
-                            }
-                            message["content"] = msg.text;
-                            messages.append(message);
-                        }
-                        root["messages"] = messages;
-                        
-                        Json::StreamWriterBuilder writer;
-                        std::string json_payload = Json::writeString(writer, root);
-                        
-                        response_text = nativePostRequest(ctx.settings.endpoint, json_payload, ctx.settings.apiKey);
-                    }
-
-                    // --- Parse JSON response ---
-                    Json::Value root;
-                    Json::CharReaderBuilder reader_builder;
-                    std::unique_ptr<Json::CharReader> const reader(reader_builder.newCharReader());
-                    JSONCPP_STRING errs;
-                    std::string parsed_content = response_text; // fallback to raw response
-                    std::string reasoning_text = ""; 
-
-                    if (reader->parse(response_text.c_str(), response_text.c_str() + response_text.length(), &root, &errs)) {
-                        if (root.isObject() && root.isMember("choices") && root["choices"].isArray() && root["choices"].size() > 0) {
-                            const Json::Value& first_choice = root["choices"][0];
-                            if (first_choice.isObject() && first_choice.isMember("message") && first_choice["message"].isObject() && first_choice["message"].isMember("content")) {
-                                std::string full_content = first_choice["message"]["content"].asString();
-                                
-                                // parse think tags for formatting and presentation
-                                size_t thought_start = full_content.find("<think>");
-                                size_t thought_end = full_content.find("</think>");
-                                
-                                if (thought_start != std::string::npos && thought_end != std::string::npos && thought_end > thought_start) {
-                                    
-                                    reasoning_text = full_content.substr(thought_start + 7, thought_end - thought_start - 7);
-                                    
-                                    parsed_content = full_content.substr(0, thought_start);
-                                    if (thought_end + 8 < full_content.length()) {
-                                        parsed_content += full_content.substr(thought_end + 8);
-                                    }
-                                } else {
-                                    parsed_content = full_content;
-                                }
-                            }
-                        }
-                    }
-                    
-                    // Trim whitespace from parsed_content and reasoning_text
-                    parsed_content = trim_whitespace(parsed_content);
-                    reasoning_text = trim_whitespace(reasoning_text);
-                    // --- End of JSON parsing ---
-
-                    // Add the new message from the LLM to the chat history
-                    ChatMessage llm_msg;
-                    llm_msg.sender = ChatMessage::LLM;
-                    llm_msg.text = parsed_content;
-                    llm_msg.wrapped_text = wrap_text(ctx.pgf, parsed_content, BUBBLE_CONTENT_WIDTH);
-                    llm_msg.alpha = 0;
-                    
-                    // Store reasoning if available
-                    if (!reasoning_text.empty()) {
-                        llm_msg.reasoning = reasoning_text;
-                        llm_msg.wrapped_reasoning = wrap_text(ctx.pgf, reasoning_text, BUBBLE_CONTENT_WIDTH - 10);
-                    }
-                    
-                    ctx.sessions[ctx.current_session_index].push_back(llm_msg);
-
-                    // Save sessions after adding an LLM response
-                    save_sessions(ctx.sessions);
-
-                    // Save sessions whenever a message is sent
-                    if ((pad.buttons & SCE_CTRL_CROSS) && !(old_pad.buttons & SCE_CTRL_CROSS) && 
-                        ctx.current_selection == UISelection::INPUT_PILL && !ctx.user_question.empty()) {
-                        save_sessions(ctx.sessions);
-                    }
+                    // The reply streams in through process_net_events while the frame loop keeps running
+                    send_chat_request(ctx, submitted_question, photo_to_send);
 
                 } else if (state == KEYBOARD_STATE_NONE) {
                     ctx.keyboard_active = false;
                 }
             } else {
-                // Handle regular chat input when keyboard is not active
+                // Circle cancels a reply that is still streaming in
+                if (ctx.reply_request_id >= 0 && !ctx.camera_mode_active && !ctx.model_selection_open &&
+                    (pad.buttons & SCE_CTRL_CIRCLE) && !(old_pad.buttons & SCE_CTRL_CIRCLE)) {
+                    net_worker_cancel(ctx.reply_request_id);
+                }
+
+                // Handle regular chat input when keyboard is not active. The layout is
+                // the one of the last frame drawn, which is what's on screen.
                 handle_chat_input(
                     pad, old_pad, ctx.current_selection, ctx.hovered_message_index,
                     ctx.keyboard_active, ctx.camera_mode_active, ctx.photo_taken,
                     ctx.model_selection_open, ctx.hovered_model_index, ctx.selected_model_index,
-                    ctx.scroll_offset, ctx.total_history_height, ctx.staged_photo, ctx.photo_to_free,
+                    ctx.scroll_offset, ctx.chat_layout, ctx.staged_photo, ctx.photo_to_free,
                     ctx.sessions[ctx.current_session_index], ctx.available_models, ctx.camera_initialized,
-                    ctx.app_state
+                    ctx.reply_request_id >= 0, ctx.app_state
                 );
             }
         } else if (ctx.app_state == AppState::SETTINGS) {
@@ -476,13 +589,16 @@ void run_app(AppContext& ctx) {
                         // Connection state tracking
                         bool is_connecting = true;  // Initially just connecting
                         bool is_fetching = false;   // Not fetching models yet
+                        bool fetch_requested = false;
                         ctx.connection_failed = false; // Track if connection failed
-                        ctx.fetch_scheduled = false;
+                        SceCtrlData popup_old_pad = pad;
                         
                         // Draw the connecting popup for at least a few frames
                         int min_popup_frames = 30; // Show popup for at least this many frames
                         
                         for (int i = 0; i < min_popup_frames || is_connecting || is_fetching; i++) {
+                            process_net_events(ctx);
+
                             // After a few frames, test the connection
                             if (i >= 5 && is_connecting && !is_fetching && !ctx.connection_failed) {
                                 // If endpoint is empty, mark as failed
@@ -495,34 +611,27 @@ void run_app(AppContext& ctx) {
                                 }
                             }
                             
-                            // Then handle the actual fetch
-                            if (is_fetching && i >= 10 && !ctx.fetch_scheduled) {
-                                ctx.fetch_scheduled = true;
-                                ctx.available_models = fetch_models(ctx.settings.endpoint, ctx.settings.apiKey);
-                                
-                                // Check if models were fetched successfully
-                                if (ctx.available_models.empty()) {
-                                    ctx.connection_failed = true;
-                                    ctx.selected_model_index = -1;
-                                } else {
-                                    // Check if there's a default model for the new endpoint
-                                    if (ctx.settings.default_models.count(ctx.settings.endpoint) > 0) {
-                                        const std::string& default_model = ctx.settings.default_models.at(ctx.settings.endpoint);
-                                        auto it = std::find(ctx.available_models.begin(), ctx.available_models.end(), default_model);
-                                        if (it != ctx.available_models.end()) {
-                                            ctx.selected_model_index = std::distance(ctx.available_models.begin(), it);
-                                        } else {
-                                            ctx.selected_model_index = 0; // Fallback
-                                        }
-                                    } else {
-                                        ctx.selected_model_index = 0; // Fallback
-                                    }
+                            // Then hand the fetch to the network worker and wait for its result
+                            if (is_fetching && i >= 10 && !fetch_requested) {
+                                request_models(ctx);
+                                fetch_requested = true;
+                            } else if (is_fetching && fetch_requested && ctx.models_request_id < 0) {
+                                // apply_fetched_models already flagged an empty list as a failed connection
+                                is_fetching = false;
+                                is_connecting = false;
+                            }
+
+                            // Circle gives up on a slow endpoint
+                            if (is_fetching && (pad.buttons & SCE_CTRL_CIRCLE) && !(popup_old_pad.buttons & SCE_CTRL_CIRCLE)) {
+                                if (ctx.models_request_id >= 0) {
+                                    net_worker_cancel(ctx.models_request_id);
+                                    ctx.models_request_id = -1;
                                 }
-                                
-                                ctx.hovered_model_index = ctx.selected_model_index;
+                                ctx.is_fetching_models = false;
+                                ctx.fetch_scheduled = false;
+                                ctx.connection_failed = true;
                                 is_fetching = false;
                                 is_connecting = false;
-                                ctx.models_loaded = true;
                             }
                             
                             // Determine the popup state for drawing
@@ -538,6 +647,7 @@ void run_app(AppContext& ctx) {
                             vita2d_swap_buffers();
                             
                             // Check for START button to exit
+                            popup_old_pad = pad;
                             sceCtrlPeekBufferPositive(0, &pad, 1);
                         }
                     }
@@ -549,43 +659,83 @@ void run_app(AppContext& ctx) {
                                      ctx.settings_model_selection_open,
                                      ctx.settings_model_selection_index);
             }
+        } else if (ctx.app_state == AppState::IMAGE_VIEWER) {
+            handle_image_viewer_input(pad, old_pad, ctx.app_state);
         } else if (ctx.app_state == AppState::SESSIONS) {
+            bool confirming_delete = ctx.show_delete_confirmation && ctx.delete_confirmation_selection &&
+                                     (pad.buttons & SCE_CTRL_CROSS) && !(old_pad.buttons & SCE_CTRL_CROSS);
+            int deleted_index = ctx.session_selection_index;
+
             // Handle sessions input
             handle_sessions_input(
                 pad, old_pad, ctx.sessions, ctx.session_selection_index, ctx.current_session_index,
                 ctx.session_scroll_offset, ctx.show_delete_confirmation, ctx.delete_confirmation_selection,
                 ctx.app_state, ctx.scroll_offset
             );
+
+            if (ctx.app_state == AppState::CHAT) {
+                // Only now is the session's history read from disk
+                open_session(ctx, ctx.sessions[ctx.current_session_index]);
+
+                TextureCacheStats stats = texture_cache_stats();
+                sceClibPrintf("texture cache: %u entries %u KB of %u KB, hits=%u misses=%u evictions=%u\n",
+                              (unsigned int)stats.entries, (unsigned int)(stats.bytes / 1024), (unsigned int)(stats.budget / 1024),
+                              stats.hits, stats.misses, stats.evictions);
+            }
+
+            // Keep an in-flight reply pointed at its session when sessions are deleted
+            if (confirming_delete && ctx.reply_request_id >= 0) {
+                if (deleted_index == ctx.reply_session_index) {
+                    net_worker_cancel(ctx.reply_request_id);
+                    ctx.reply_request_id = -1;
+                } else if (deleted_index < ctx.reply_session_index) {
+                    ctx.reply_session_index--;
+                }
+            }
         }
 
+        // Nothing changed, so the last frame stays on screen. After a second
+        // of that the loop only wakes at settings.idle_fps to poll input.
+        if (!ctx.frame_dirty && !animating) {
+            s_pacing.skipped++;
+            s_pacing.skipped_us += sceKernelGetProcessTimeWide() - iteration_start;
+            sceDisplayWaitVblankStartMulti(idle_pacing_wait(ctx.idle, ctx.settings.idle_fps));
+            old_pad = pad;
+            continue;
+        }
+        ctx.frame_dirty = false;
+        idle_pacing_reset(ctx.idle);
+
         // --- Drawing ---
         if (ctx.app_state == AppState::CHAT) {
-            // Get camera texture if camera is active
-            vita2d_texture* camera_tex = NULL;
-            if (ctx.camera_mode_active && camera_is_active() && !ctx.photo_taken) {
-                camera_tex = camera_get_frame_texture();
-            }
-            
-            draw_ui(ctx.pgf, ctx.sessions[ctx.current_session_index], ctx.user_question, 
-                   ctx.scroll_offset, ctx.total_history_height, ctx.current_selection, 
-                   ctx.available_models, ctx.model_selection_open ? ctx.hovered_model_index : ctx.selected_model_index, 
-                   ctx.model_selection_open, ctx.is_fetching_models, !ctx.available_models.empty(), 
-                   ctx.ui_alpha, ctx.model_pill_alpha, ctx.camera_mode_active, 
-                   ctx.photo_taken ? ctx.staged_photo : camera_tex, ctx.photo_taken, 
-                   ctx.staged_photo, ctx.camera_fade_alpha, ctx.model_dropup_h, ctx.hovered_message_index,
-                   ctx.start_button_hold_duration);
+            draw_chat_frame(ctx);
         } else if (ctx.app_state == AppState::SETTINGS) {
             draw_settings_ui(ctx.pgf, ctx.settings, ctx.settings_selection, ctx.ui_alpha, 
                            ctx.model_pill_alpha, ctx.available_models, ctx.settings_model_selection_index, 
                            ctx.is_fetching_models, ctx.is_fetching_models, ctx.connection_failed, ctx.settings_model_selection_open);
+        } else if (ctx.app_state == AppState::IMAGE_VIEWER) {
+            const ChatSession& session = ctx.sessions[ctx.current_session_index];
+            if (ctx.hovered_message_index >= 0 && ctx.hovered_message_index < (int)session.messages.size()) {
+                draw_image_viewer(ctx.pgf, session.messages[ctx.hovered_message_index]);
+            } else {
+                ctx.app_state = AppState::CHAT;
+            }
         } else if (ctx.app_state == AppState::SESSIONS) {
             draw_sessions_ui(ctx.pgf, ctx.sessions, ctx.session_scroll_offset, ctx.session_selection_index, 
                            ctx.show_delete_confirmation, ctx.delete_confirmation_selection);
         }
         
+        s_pacing.drawn++;
+        s_pacing.drawn_us += sceKernelGetProcessTimeWide() - iteration_start;
         vita2d_common_dialog_update();
         vita2d_swap_buffers();
 
+        // Images evicted this frame may still be in use by the GPU until rendering finishes
+        if (texture_cache_pending_frees() > 0) {
+            vita2d_wait_rendering_done();
+        }
+        texture_cache_collect();
+
         old_pad = pad;
     }
 
@@ -595,15 +745,35 @@ void run_app(AppContext& ctx) {
 
 // unload everything
 void cleanup_app(AppContext& ctx) {
+    // Let queued photos finish writing before anything is torn down
+    image_saver_stop();
+
+    // Keep the glyph advances measured this run for the next one
+    if (text_metrics_changed()) {
+        std::string advance_table = text_metrics_export();
+        persist_writer_submit("text_metrics", [advance_table]() {
+            return persist_write_file(TEXT_METRICS_PATH, advance_table);
+        });
+    }
+
+    // Flush the sessions and settings saved on the way out
+    persist_writer_stop();
+    PersistWriterStats persist_stats = persist_writer_stats();
+    sceClibPrintf("persistence: %u saves, %u coalesced, %u writes (%u failed), last %llu us, max %llu us, total %llu us\n",
+                  persist_stats.submitted, persist_stats.coalesced, persist_stats.writes, persist_stats.failures,
+                  persist_stats.last_write_us, persist_stats.max_write_us, persist_stats.total_write_us);
+
     // Clean up textures in chat history
     for (auto& session : ctx.sessions) {
-        for (auto& msg : session) {
+        for (auto& msg : session.messages) {
             if (msg.image) {
                 vita2d_free_texture(msg.image);
             }
         }
     }
 
+    texture_cache_shutdown();
+
     // Clean up camera resources
     if (ctx.camera_initialized) {
         if (ctx.camera_mode_active) {
@@ -619,12 +789,34 @@ void cleanup_app(AppContext& ctx) {
     // Clean up UI textures
     cleanup_ui_textures();
 
+    TextRunCacheStats run_stats = text_run_cache_stats();
+    sceClibPrintf("text runs: hits=%u misses=%u renders=%u evictions=%u uncached=%u\n",
+                  run_stats.hits, run_stats.misses, run_stats.renders, run_stats.evictions, run_stats.uncached);
+    text_run_cache_shutdown();
+
+    sceClibPrintf("frame pacing: %u drawn (%llu us each), %u skipped (%llu us each)\n",
+                  s_pacing.drawn, s_pacing.drawn ? s_pacing.drawn_us / s_pacing.drawn : 0,
+                  s_pacing.skipped, s_pacing.skipped ? s_pacing.skipped_us / s_pacing.skipped : 0);
+
+    DrawListStats draw_stats = draw_list_stats();
+    sceClibPrintf("draw list: %u frames, %u commands, %u submitted, %u culled\n",
+                  draw_stats.frames, draw_stats.commands, draw_stats.submitted, draw_stats.culled);
+    draw_list_shutdown();
+
     // Clean up other resources
     keyboard_terminate();
     vita2d_fini();
+    text_metrics_shutdown();
     vita2d_free_pgf(ctx.pgf);
     
     // Clean up network resources
+    net_worker_stop();
+    HttpPoolStats pool_stats = http_pool_stats();
+    sceClibPrintf("http pool: hits=%u misses=%u stale_retries=%u handshakes=%u (%llu ms send each), reused sends %llu ms each\n",
+                  pool_stats.hits, pool_stats.misses, pool_stats.stale_retries, pool_stats.handshakes,
+                  pool_stats.handshakes ? pool_stats.handshake_send_us / pool_stats.handshakes / 1000 : 0,
+                  pool_stats.hits ? pool_stats.reused_send_us / pool_stats.hits / 1000 : 0);
+    http_pool_clear();
     sceSslTerm();
     sceHttpTerm();
     sceNetCtlTerm();
@@ -6,6 +6,8 @@
 #include <string>
 #include "types.h"
 #include "settings.h"
+#include "chat_layout.h"
+#include "frame_pacing.h"
 
 struct AppContext {
     vita2d_pgf* pgf;
@@ -22,7 +24,7 @@ struct AppContext {
     std::string user_question;
     bool keyboard_active;
     int scroll_offset;
-    int total_history_height;
+    ChatLayout chat_layout;
     
     std::vector<ChatSession> sessions;
     int current_session_index;
@@ -40,6 +42,14 @@ struct AppContext {
     bool models_loaded;
     bool fetch_scheduled;
     bool connection_failed;
+    int models_request_id;
+    
+    // reply currently streaming in from the network worker (-1 when idle)
+    int reply_request_id;
+    int reply_session_index;
+    int reply_message_index;
+    std::string reply_content;
+    std::string reply_reasoning;
     
     bool camera_initialized;
     bool camera_mode_active;
@@ -52,6 +62,10 @@ struct AppContext {
     unsigned int ui_alpha;
     unsigned int model_pill_alpha;
     float start_button_hold_duration; 
+
+    // The loop only draws when something on screen may have changed
+    bool frame_dirty;
+    IdlePacing idle;
     
     AppState app_state;
 };
@@ -0,0 +1,131 @@
+#include "base64.h"
+#include <cassert>
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define BASE64_NEON 1
+#endif
+
+static const char BASE64_CHARS[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+    "abcdefghijklmnopqrstuvwxyz"
+    "0123456789+/";
+
+size_t base64_encoded_size(size_t len) {
+    return (len + 2) / 3 * 4;
+}
+
+#ifdef BASE64_NEON
+// Maps 6-bit indexes to their characters without a table lookup: start from
+// 'A' and shift the offset at each range boundary (a-z, 0-9, '+', '/')
+static inline uint8x16_t neon_index_to_ascii(uint8x16_t index) {
+    uint8x16_t offset = vdupq_n_u8('A');
+    offset = vaddq_u8(offset, vandq_u8(vcgeq_u8(index, vdupq_n_u8(26)), vdupq_n_u8('a' - 26 - 'A')));
+    offset = vsubq_u8(offset, vandq_u8(vcgeq_u8(index, vdupq_n_u8(52)), vdupq_n_u8(('a' - 26) - ('0' - 52))));
+    offset = vsubq_u8(offset, vandq_u8(vceqq_u8(index, vdupq_n_u8(62)), vdupq_n_u8(('0' - 52) - ('+' - 62))));
+    offset = vsubq_u8(offset, vandq_u8(vceqq_u8(index, vdupq_n_u8(63)), vdupq_n_u8(('0' - 52) - ('/' - 63))));
+    return vaddq_u8(index, offset);
+}
+
+// Encodes 48 input bytes into 64 characters per iteration. Returns the number of bytes consumed.
+static size_t encode_blocks_neon(const unsigned char* in, size_t len, char* out) {
+    const uint8x16_t mask6 = vdupq_n_u8(0x3F);
+    size_t done = 0;
+    for (; done + 48 <= len; done += 48) {
+        // De-interleave so each register holds byte 0, 1 or 2 of sixteen groups
+        uint8x16x3_t src = vld3q_u8(in + done);
+
+        uint8x16x4_t dst;
+        dst.val[0] = vshrq_n_u8(src.val[0], 2);
+        dst.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(src.val[0], 4), vshrq_n_u8(src.val[1], 4)), mask6);
+        dst.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(src.val[1], 2), vshrq_n_u8(src.val[2], 6)), mask6);
+        dst.val[3] = vandq_u8(src.val[2], mask6);
+
+        dst.val[0] = neon_index_to_ascii(dst.val[0]);
+        dst.val[1] = neon_index_to_ascii(dst.val[1]);
+        dst.val[2] = neon_index_to_ascii(dst.val[2]);
+        dst.val[3] = neon_index_to_ascii(dst.val[3]);
+
+        vst4q_u8(reinterpret_cast<uint8_t*>(out + done / 3 * 4), dst);
+    }
+    return done;
+}
+#endif
+
+// Encodes in[i..len) into cursor with the scalar loop. Returns the end of the output.
+static char* encode_scalar(const unsigned char* in, size_t i, size_t len, char* cursor) {
+    // Whole 3-byte groups
+    for (; i + 3 <= len; i += 3) {
+        unsigned int triple = (in[i] << 16) | (in[i + 1] << 8) | in[i + 2];
+        cursor[0] = BASE64_CHARS[(triple >> 18) & 0x3F];
+        cursor[1] = BASE64_CHARS[(triple >> 12) & 0x3F];
+        cursor[2] = BASE64_CHARS[(triple >> 6) & 0x3F];
+        cursor[3] = BASE64_CHARS[triple & 0x3F];
+        cursor += 4;
+    }
+
+    // One or two bytes left over
+    if (i < len) {
+        unsigned int triple = in[i] << 16;
+        if (i + 1 < len) {
+            triple |= in[i + 1] << 8;
+        }
+        cursor[0] = BASE64_CHARS[(triple >> 18) & 0x3F];
+        cursor[1] = BASE64_CHARS[(triple >> 12) & 0x3F];
+        cursor[2] = (i + 1 < len) ? BASE64_CHARS[(triple >> 6) & 0x3F] : '=';
+        cursor[3] = '=';
+        cursor += 4;
+    }
+    return cursor;
+}
+
+size_t base64_encode_to(const unsigned char* in, size_t len, char* out) {
+    size_t i = 0;
+#ifdef BASE64_NEON
+    i = encode_blocks_neon(in, len, out);
+#endif
+    return encode_scalar(in, i, len, out + i / 3 * 4) - out;
+}
+
+size_t base64_encode_scalar_to(const unsigned char* in, size_t len, char* out) {
+    return encode_scalar(in, 0, len, out) - out;
+}
+
+void base64_append(std::string& out, const unsigned char* in, size_t len) {
+    size_t start = out.size();
+    out.resize(start + base64_encoded_size(len));
+    base64_encode_to(in, len, &out[start]);
+}
+
+void base64_stream_write(Base64Stream& stream, const unsigned char* in, size_t len) {
+    // Complete a group with the carried bytes first
+    if (stream.carry_len > 0) {
+        if (stream.carry_len + len < 3) {
+            // Still short of a group: carry_len is 1 and len at most 1
+            assert(stream.carry_len + len <= sizeof(stream.carry));
+            memcpy(stream.carry + stream.carry_len, in, len);
+            stream.carry_len += len;
+            return;
+        }
+        unsigned char group[3];
+        int take = 3 - stream.carry_len;
+        for (int i = 0; i < stream.carry_len; i++) group[i] = stream.carry[i];
+        for (int i = 0; i < take; i++) group[stream.carry_len + i] = in[i];
+        base64_append(*stream.out, group, 3);
+        in += take;
+        len -= take;
+        stream.carry_len = 0;
+    }
+
+    size_t whole = len / 3 * 3;
+    base64_append(*stream.out, in, whole);
+    // The carry is empty here and the remainder at most 2 bytes
+    memcpy(stream.carry, in + whole, len - whole);
+    stream.carry_len = len - whole;
+}
+
+void base64_stream_finish(Base64Stream& stream) {
+    base64_append(*stream.out, stream.carry, stream.carry_len);
+    stream.carry_len = 0;
+}
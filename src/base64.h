@@ -0,0 +1,34 @@
+#ifndef BASE64_H
+#define BASE64_H
+
+#include <string>
+#include <cstddef>
+
+// Number of characters base64 produces for len input bytes, padding included
+size_t base64_encoded_size(size_t len);
+
+// Encodes len bytes into out, which must have room for base64_encoded_size(len)
+// characters. No terminator is written. Returns the number of characters written.
+size_t base64_encode_to(const unsigned char* in, size_t len, char* out);
+
+// base64_encode_to without the NEON block path, to check that path against
+size_t base64_encode_scalar_to(const unsigned char* in, size_t len, char* out);
+
+// Appends the encoding of in to out, growing it once up front
+void base64_append(std::string& out, const unsigned char* in, size_t len);
+
+// Incremental encoder for data that arrives in pieces (e.g. from an image
+// writer callback). Up to two bytes are carried between writes so every
+// write but the last emits whole groups straight into *out.
+struct Base64Stream {
+    std::string* out = nullptr;
+    unsigned char carry[2];
+    int carry_len = 0;
+};
+
+void base64_stream_write(Base64Stream& stream, const unsigned char* in, size_t len);
+
+// Encodes the carried bytes with padding
+void base64_stream_finish(Base64Stream& stream);
+
+#endif
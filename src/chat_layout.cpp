@@ -0,0 +1,140 @@
+#include "chat_layout.h"
+#include "ui.h"
+#include <algorithm>
+
+static float max_width(const std::vector<float>& widths) {
+    float max_width = 0.0f;
+    for (float width : widths) {
+        if (width > max_width) max_width = width;
+    }
+    return max_width;
+}
+
+void wrap_message(vita2d_pgf* pgf, ChatMessage& msg, int content_width) {
+    MessageLayout& layout = msg.layout;
+    msg.wrapped_text = wrap_text(pgf, msg.text, content_width, &layout.line_widths);
+    if (!msg.reasoning.empty()) {
+        msg.wrapped_reasoning = wrap_text(pgf, msg.reasoning, content_width - 10, &layout.reasoning_line_widths);
+    } else {
+        msg.wrapped_reasoning.clear();
+        layout.reasoning_line_widths.clear();
+    }
+
+    layout.content_width = content_width;
+    layout.max_line_width = max_width(layout.line_widths);
+    layout.max_reasoning_width = max_width(layout.reasoning_line_widths);
+    layout_message(msg);
+}
+
+void layout_message(ChatMessage& msg) {
+    MessageLayout& layout = msg.layout;
+    bool has_image = msg.has_image();
+    bool reasoning_shown = msg.sender == ChatMessage::LLM && msg.show_reasoning && !msg.wrapped_reasoning.empty();
+
+    layout.valid = true;
+    layout.show_reasoning = msg.show_reasoning;
+    layout.image_width = msg.image_width;
+    layout.image_height = msg.image_height;
+
+    float image_w = has_image ? ((float)MESSAGE_IMAGE_HEIGHT * msg.image_width / msg.image_height) : 0.0f;
+    float text_h = msg.wrapped_text.size() * MESSAGE_LINE_HEIGHT;
+    float reasoning_h = reasoning_shown ? msg.wrapped_reasoning.size() * MESSAGE_LINE_HEIGHT : 0.0f;
+
+    layout.image = LayoutRect();
+    layout.reasoning = LayoutRect();
+    int y = 25; // first baseline, or the top of the image
+
+    if (msg.sender == ChatMessage::USER) {
+        float content_width = std::max(image_w, layout.max_line_width);
+        float bubble_width = std::min(content_width + 30, (float)BUBBLE_MAX_WIDTH);
+        float bubble_x = SCREEN_WIDTH - bubble_width - 20;
+
+        if (has_image) {
+            layout.image = { bubble_x + 15, (float)y, image_w, (float)MESSAGE_IMAGE_HEIGHT };
+            y += MESSAGE_IMAGE_HEIGHT + 20;
+        }
+        layout.text = { bubble_x + 15, (float)(y - MESSAGE_LINE_HEIGHT), layout.max_line_width, text_h };
+        layout.height = text_h + 20 + (has_image ? MESSAGE_IMAGE_HEIGHT + 20 : 0);
+        layout.bubble = { bubble_x, 0.0f, bubble_width, (float)layout.height };
+    } else {
+        float content_width = std::max(image_w, layout.max_line_width);
+        if (reasoning_shown) {
+            content_width = std::max(content_width, layout.max_reasoning_width + 10); // Extra indent for reasoning
+        }
+        float bubble_width = content_width + 50; // Add padding (15px left + 35px right)
+        if (bubble_width > BUBBLE_MAX_WIDTH) bubble_width = BUBBLE_MAX_WIDTH;
+        if (bubble_width < 100.0f) bubble_width = 100.0f;
+
+        if (has_image) {
+            layout.image = { 30.0f, (float)y, image_w, (float)MESSAGE_IMAGE_HEIGHT };
+            y += MESSAGE_IMAGE_HEIGHT + 10;
+        }
+        if (reasoning_shown) {
+            layout.reasoning = { 45.0f, (float)(y - MESSAGE_LINE_HEIGHT), layout.max_reasoning_width, reasoning_h };
+            y += reasoning_h + 10;
+        }
+        layout.text = { 35.0f, (float)(y - MESSAGE_LINE_HEIGHT), layout.max_line_width, text_h };
+        layout.height = text_h + 20 + (has_image ? MESSAGE_IMAGE_HEIGHT + 10 : 0) + (reasoning_shown ? reasoning_h + 30 : 0);
+        layout.bubble = { 20.0f, 0.0f, bubble_width, (float)layout.height };
+    }
+}
+
+static bool layout_current(const ChatMessage& msg) {
+    const MessageLayout& layout = msg.layout;
+    return layout.valid && layout.show_reasoning == msg.show_reasoning &&
+           layout.image_width == msg.image_width && layout.image_height == msg.image_height;
+}
+
+void chat_layout_invalidate(ChatSession& session, size_t index) {
+    session.layout_dirty_from = std::min(session.layout_dirty_from, index);
+}
+
+void chat_layout_update(ChatLayout& layout, ChatSession& session) {
+    if (layout.session_id != session.id) {
+        layout.session_id = session.id;
+        layout.tops.clear();
+        layout.bottoms.clear();
+        layout.total_height = 0;
+    }
+
+    std::vector<ChatMessage>& messages = session.messages;
+    size_t first_changed = std::min(std::min(session.layout_dirty_from, layout.tops.size()), messages.size());
+    if (first_changed == messages.size() && layout.tops.size() == messages.size()) {
+        return;
+    }
+    layout.tops.resize(messages.size());
+    layout.bottoms.resize(messages.size());
+    session.layout_dirty_from = messages.size();
+
+    for (size_t i = first_changed; i < messages.size(); i++) {
+        if (!layout_current(messages[i])) {
+            layout_message(messages[i]);
+        }
+    }
+
+    // Everything from the first changed message down moves
+    int top = first_changed > 0 ? layout.bottoms[first_changed - 1] + MESSAGE_MARGIN : 0;
+    for (size_t i = first_changed; i < messages.size(); i++) {
+        layout.tops[i] = top;
+        layout.bottoms[i] = top + messages[i].layout.height;
+        top = layout.bottoms[i] + MESSAGE_MARGIN;
+    }
+
+    layout.total_height = messages.empty() ? 0 : layout.bottoms.back();
+}
+
+size_t chat_layout_find(const ChatLayout& layout, int y) {
+    return std::lower_bound(layout.bottoms.begin(), layout.bottoms.end(), y) - layout.bottoms.begin();
+}
+
+void visible_line_range(float y, size_t count, float top, float bottom, size_t& first, size_t& last) {
+    first = 0;
+    last = count;
+    if (y < top) {
+        first = std::min(count, (size_t)((top - y) / MESSAGE_LINE_HEIGHT));
+    }
+    if (y + count * MESSAGE_LINE_HEIGHT > bottom) {
+        last = y > bottom ? 0 : std::min(count, (size_t)((bottom - y) / MESSAGE_LINE_HEIGHT) + 1);
+    }
+    if (last < first) last = first;
+}
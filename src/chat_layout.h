@@ -0,0 +1,56 @@
+#ifndef CHAT_LAYOUT_H
+#define CHAT_LAYOUT_H
+
+#include <vector>
+#include <cstddef>
+#include <vita2d.h>
+#include "types.h"
+
+// Layout of the chat view. Lines are measured once, when a message is
+// wrapped, and each message keeps its rects in ChatMessage::layout; they
+// are recomputed from the stored widths only when reasoning is shown or
+// hidden or the image changes. ChatLayout keeps a prefix sum of message
+// tops so the messages on screen are found by binary search from the
+// scroll offset instead of walking the whole session.
+//
+// Whoever changes a message marks it with chat_layout_invalidate, so a
+// frame where nothing changed doesn't look at any message, and streaming
+// into the last one only lays out that one.
+
+#define BUBBLE_CONTENT_WIDTH (400 - 30) // 400 bubble width, 15px padding each side
+#define BUBBLE_MAX_WIDTH 480
+#define MESSAGE_LINE_HEIGHT 20
+#define MESSAGE_MARGIN 10
+#define MESSAGE_IMAGE_HEIGHT 150
+
+struct ChatLayout {
+    int session_id = -1;
+    std::vector<int> tops;     // relative to the first message
+    std::vector<int> bottoms;
+    int total_height = 0;      // messages plus the margins between them
+};
+
+// Wraps text and reasoning to content_width, measuring each line, and lays the message out
+void wrap_message(vita2d_pgf* pgf, ChatMessage& msg, int content_width);
+
+// Recomputes the message's rects from the line widths measured by wrap_message
+void layout_message(ChatMessage& msg);
+
+// Marks a message whose text, reasoning visibility or image size changed.
+// Appended messages are picked up without this.
+void chat_layout_invalidate(ChatSession& session, size_t index);
+
+// Lays out the messages marked since the last call, and any appended, and
+// refreshes the tops from the first of them down. Layout is thrown away
+// when a different session is passed in.
+void chat_layout_update(ChatLayout& layout, ChatSession& session);
+
+// Index of the first message whose bottom is at or below y (layout space),
+// or the message count if there is none
+size_t chat_layout_find(const ChatLayout& layout, int y);
+
+// Range [first, last) of count lines starting at baseline y that land
+// between top and bottom on screen
+void visible_line_range(float y, size_t count, float top, float bottom, size_t& first, size_t& last);
+
+#endif
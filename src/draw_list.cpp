@@ -0,0 +1,156 @@
+#include "draw_list.h"
+#include "types.h"
+#include <sstream>
+
+// Generous bounds of a line of PGF text around its baseline
+#define DRAW_TEXT_ASCENT 32
+#define DRAW_TEXT_DESCENT 16
+
+static DrawBackend s_backend;
+static DrawListStats s_stats;
+static std::vector<DrawCommand> s_commands;
+
+DrawBackend recording_draw_backend(std::vector<DrawCommand>* commands) {
+    DrawBackend backend;
+    backend.draw = [commands](const DrawCommand& command) {
+        commands->push_back(command);
+    };
+    return backend;
+}
+
+void draw_list_init(const DrawBackend& backend) {
+    s_backend = backend;
+    s_stats = DrawListStats();
+    s_commands.clear();
+}
+
+void draw_list_shutdown() {
+    s_backend = DrawBackend();
+    s_commands.clear();
+}
+
+static DrawCommand& add(DrawCommandType type, unsigned int color) {
+    s_commands.push_back(DrawCommand());
+    DrawCommand& command = s_commands.back();
+    command.type = type;
+    command.color = color;
+    return command;
+}
+
+void draw_list_rect(float x, float y, float w, float h, unsigned int color) {
+    DrawCommand& command = add(DRAW_RECT, color);
+    command.x = x;
+    command.y = y;
+    command.w = w;
+    command.h = h;
+}
+
+void draw_list_rounded_rect(float x, float y, float w, float h, float radius, unsigned int color) {
+    DrawCommand& command = add(DRAW_ROUNDED_RECT, color);
+    command.x = x;
+    command.y = y;
+    command.w = w;
+    command.h = h;
+    command.radius = radius;
+}
+
+void draw_list_texture(vita2d_texture* texture, float x, float y, float x_scale, float y_scale, unsigned int color) {
+    if (texture == NULL) {
+        return;
+    }
+    draw_list_texture_part(texture, x, y, 0, 0, vita2d_texture_get_width(texture), vita2d_texture_get_height(texture),
+                           x_scale, y_scale, color);
+}
+
+void draw_list_texture_part(vita2d_texture* texture, float x, float y, float tex_x, float tex_y, float tex_w, float tex_h,
+                            float x_scale, float y_scale, unsigned int color) {
+    if (texture == NULL) {
+        return;
+    }
+    DrawCommand& command = add(DRAW_TEXTURE, color);
+    command.texture = texture;
+    command.x = x;
+    command.y = y;
+    command.w = tex_w * x_scale;
+    command.h = tex_h * y_scale;
+    command.tex_x = tex_x;
+    command.tex_y = tex_y;
+    command.tex_w = tex_w;
+    command.tex_h = tex_h;
+}
+
+void draw_list_text(int x, int y, unsigned int color, float scale, const std::string& text) {
+    if (text.empty()) {
+        return;
+    }
+    DrawCommand& command = add(DRAW_TEXT, color);
+    command.x = x;
+    command.y = y;
+    command.scale = scale;
+    command.text = text;
+}
+
+static bool visible(const DrawCommand& command) {
+    if ((command.color >> 24) == 0) {
+        return false;
+    }
+    if (command.type == DRAW_TEXT) {
+        if (command.x >= SCREEN_WIDTH || command.y - DRAW_TEXT_ASCENT * command.scale >= SCREEN_HEIGHT) {
+            return false;
+        }
+        // Further lines of multi-line text run down from the first
+        bool single_line = command.text.find('\n') == std::string::npos;
+        return !single_line || command.y + DRAW_TEXT_DESCENT * command.scale > 0;
+    }
+    return command.w > 0 && command.h > 0 &&
+           command.x < SCREEN_WIDTH && command.y < SCREEN_HEIGHT &&
+           command.x + command.w > 0 && command.y + command.h > 0;
+}
+
+void draw_list_submit() {
+    unsigned int submitted = 0;
+    for (const auto& command : s_commands) {
+        if (!visible(command)) {
+            s_stats.culled++;
+            continue;
+        }
+        if (s_backend.draw) {
+            s_backend.draw(command);
+        }
+        submitted++;
+    }
+
+    s_stats.frames++;
+    s_stats.commands += s_commands.size();
+    s_stats.submitted += submitted;
+    s_stats.last_submitted = submitted;
+    s_commands.clear();
+}
+
+std::string draw_list_dump(const std::vector<DrawCommand>& commands) {
+    std::ostringstream out;
+    for (const auto& command : commands) {
+        switch (command.type) {
+        case DRAW_RECT:
+            out << "rect " << command.x << ' ' << command.y << ' ' << command.w << ' ' << command.h;
+            break;
+        case DRAW_ROUNDED_RECT:
+            out << "rounded_rect " << command.x << ' ' << command.y << ' ' << command.w << ' ' << command.h
+                << " r=" << command.radius;
+            break;
+        case DRAW_TEXTURE:
+            out << "texture " << command.x << ' ' << command.y << ' ' << command.w << ' ' << command.h
+                << " part=" << command.tex_x << ',' << command.tex_y << ',' << command.tex_w << ',' << command.tex_h;
+            break;
+        case DRAW_TEXT:
+            out << "text " << command.x << ' ' << command.y << " scale=" << command.scale << " \"" << command.text << '"';
+            break;
+        }
+        out << " color=" << std::hex << command.color << std::dec << '\n';
+    }
+    return out.str();
+}
+
+DrawListStats draw_list_stats() {
+    return s_stats;
+}
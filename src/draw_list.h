@@ -0,0 +1,75 @@
+#ifndef DRAW_LIST_H
+#define DRAW_LIST_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <vita2d.h>
+
+// The UI records what it draws into a per-frame command list instead of
+// calling vita2d directly. draw_list_submit runs just before the scene ends:
+// commands that can't show up (fully transparent or entirely off screen)
+// are dropped and the rest go to the DrawBackend in the order they were
+// recorded, since later commands paint over earlier ones.
+//
+// Colors are recorded with their final alpha. The native backend draws with
+// vita2d; recording_draw_backend collects the commands instead, so a host
+// build can count draw calls and compare frames without a Vita.
+
+enum DrawCommandType {
+    DRAW_RECT,
+    DRAW_ROUNDED_RECT,  // circles are rounded rects with a radius of half the side
+    DRAW_TEXTURE,
+    DRAW_TEXT
+};
+
+struct DrawCommand {
+    DrawCommandType type = DRAW_RECT;
+    float x = 0, y = 0;     // top left; the start of the baseline for text
+    float w = 0, h = 0;     // size on screen, unused for text
+    unsigned int color = 0; // fill, text color or texture tint
+    float radius = 0;       // DRAW_ROUNDED_RECT
+    vita2d_texture* texture = NULL;
+    float tex_x = 0, tex_y = 0, tex_w = 0, tex_h = 0; // part of the texture drawn
+    float scale = 1.0f;     // DRAW_TEXT
+    std::string text;
+};
+
+struct DrawBackend {
+    std::function<void(const DrawCommand& command)> draw;
+};
+
+struct DrawListStats {
+    unsigned int frames = 0;
+    unsigned int commands = 0;   // recorded
+    unsigned int submitted = 0;  // passed to the backend
+    unsigned int culled = 0;     // transparent or off screen
+    unsigned int last_submitted = 0;
+};
+
+// Appends every submitted command to commands
+DrawBackend recording_draw_backend(std::vector<DrawCommand>* commands);
+
+void draw_list_init(const DrawBackend& backend);
+void draw_list_shutdown();
+
+void draw_list_rect(float x, float y, float w, float h, unsigned int color);
+void draw_list_rounded_rect(float x, float y, float w, float h, float radius, unsigned int color);
+// The whole texture, scaled
+void draw_list_texture(vita2d_texture* texture, float x, float y, float x_scale = 1.0f, float y_scale = 1.0f,
+                       unsigned int color = RGBA8(255, 255, 255, 255));
+// Part of a texture, scaled
+void draw_list_texture_part(vita2d_texture* texture, float x, float y, float tex_x, float tex_y, float tex_w, float tex_h,
+                            float x_scale, float y_scale, unsigned int color);
+// Text with its baseline at y. Positions are whole pixels, as with vita2d_pgf_draw_text.
+void draw_list_text(int x, int y, unsigned int color, float scale, const std::string& text);
+
+// Sends the commands recorded since the last submit to the backend
+void draw_list_submit();
+
+// One line per command, for comparing recorded frames
+std::string draw_list_dump(const std::vector<DrawCommand>& commands);
+
+DrawListStats draw_list_stats();
+
+#endif
@@ -0,0 +1,21 @@
+#include "frame_pacing.h"
+
+int idle_pacing_wait(IdlePacing& pacing, int idle_fps) {
+    pacing.frames++;
+    if (pacing.frames <= IDLE_CAP_AFTER_FRAMES || idle_fps <= 0) {
+        return 1;
+    }
+
+    int vblanks = 0;
+    do {
+        vblanks++;
+        pacing.phase += idle_fps;
+    } while (pacing.phase < 60);
+    pacing.phase -= 60;
+    return vblanks;
+}
+
+void idle_pacing_reset(IdlePacing& pacing) {
+    pacing.frames = 0;
+    pacing.phase = 0;
+}
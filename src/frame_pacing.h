@@ -0,0 +1,24 @@
+#ifndef FRAME_PACING_H
+#define FRAME_PACING_H
+
+// How long the loop waits when nothing on screen changed. For the first
+// IDLE_CAP_AFTER_FRAMES still frames it waits one vblank; after that it only
+// wakes at idle_fps. The phase carries the remainder over, so a rate that
+// doesn't divide 60 alternates between waits (2 and 3 vblanks for 25) and
+// averages out to exactly idle_fps.
+
+// Still frames before the loop drops to idle_fps
+#define IDLE_CAP_AFTER_FRAMES 60
+
+struct IdlePacing {
+    int frames = 0; // loop iterations since the last drawn frame
+    int phase = 0;  // idle_fps accumulated per vblank waited, modulo 60
+};
+
+// Vblanks to wait before the next still iteration, for idle_fps in 1-60
+int idle_pacing_wait(IdlePacing& pacing, int idle_fps);
+
+// Called whenever a frame is drawn
+void idle_pacing_reset(IdlePacing& pacing);
+
+#endif
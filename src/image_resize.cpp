@@ -0,0 +1,155 @@
+#include "image_resize.h"
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define IMAGE_RESIZE_NEON 1
+#endif
+
+void image_fit_size(int width, int height, int max_edge, int& out_width, int& out_height) {
+    out_width = width;
+    out_height = height;
+    if (max_edge <= 0 || (width <= max_edge && height <= max_edge)) {
+        return;
+    }
+
+    if (width >= height) {
+        out_width = max_edge;
+        out_height = (height * max_edge + width / 2) / width;
+    } else {
+        out_height = max_edge;
+        out_width = (width * max_edge + height / 2) / height;
+    }
+    if (out_width < 1) out_width = 1;
+    if (out_height < 1) out_height = 1;
+}
+
+// Averages each 2x2 block of src into one dst pixel. Odd trailing rows/columns are dropped.
+static void halve_rgba(const unsigned char* src, int src_width, int src_height, int src_stride, unsigned char* dst) {
+    int dst_width = src_width / 2;
+    int dst_height = src_height / 2;
+
+    for (int y = 0; y < dst_height; y++) {
+        const unsigned char* row0 = src + (2 * y) * src_stride;
+        const unsigned char* row1 = row0 + src_stride;
+        unsigned char* out = dst + y * dst_width * 4;
+        int x = 0;
+
+#ifdef IMAGE_RESIZE_NEON
+        // 8 source pixels per row -> 4 output pixels
+        for (; x + 4 <= dst_width; x += 4) {
+            // Split even and odd pixels so each lane pairs with its horizontal neighbour
+            uint32x4x2_t top = vld2q_u32(reinterpret_cast<const uint32_t*>(row0 + x * 8));
+            uint32x4x2_t bottom = vld2q_u32(reinterpret_cast<const uint32_t*>(row1 + x * 8));
+            uint8x16_t top_even = vreinterpretq_u8_u32(top.val[0]);
+            uint8x16_t top_odd = vreinterpretq_u8_u32(top.val[1]);
+            uint8x16_t bottom_even = vreinterpretq_u8_u32(bottom.val[0]);
+            uint8x16_t bottom_odd = vreinterpretq_u8_u32(bottom.val[1]);
+
+            uint16x8_t sum_low = vaddq_u16(vaddl_u8(vget_low_u8(top_even), vget_low_u8(top_odd)),
+                                           vaddl_u8(vget_low_u8(bottom_even), vget_low_u8(bottom_odd)));
+            uint16x8_t sum_high = vaddq_u16(vaddl_u8(vget_high_u8(top_even), vget_high_u8(top_odd)),
+                                            vaddl_u8(vget_high_u8(bottom_even), vget_high_u8(bottom_odd)));
+
+            vst1q_u8(out + x * 4, vcombine_u8(vrshrn_n_u16(sum_low, 2), vrshrn_n_u16(sum_high, 2)));
+        }
+#endif
+
+        for (; x < dst_width; x++) {
+            const unsigned char* a = row0 + x * 8;
+            const unsigned char* b = row1 + x * 8;
+            for (int c = 0; c < 4; c++) {
+                out[x * 4 + c] = (unsigned char)((a[c] + a[c + 4] + b[c] + b[c + 4] + 2) >> 2);
+            }
+        }
+    }
+}
+
+// Bilinear resample with 16.16 fixed-point source coordinates (pixel centers aligned)
+static void bilinear_rgba(const unsigned char* src, int src_width, int src_height, int src_stride,
+                          unsigned char* dst, int dst_width, int dst_height) {
+    std::vector<int> x0(dst_width);
+    std::vector<int> x_frac(dst_width);
+    for (int x = 0; x < dst_width; x++) {
+        int sx = (int)(((long long)(2 * x + 1) * src_width << 15) / dst_width) - 32768;
+        if (sx < 0) sx = 0;
+        x0[x] = sx >> 16;
+        x_frac[x] = (sx >> 8) & 0xFF;
+        if (x0[x] >= src_width - 1) {
+            x0[x] = src_width - 1;
+            x_frac[x] = 0;
+        }
+    }
+
+    for (int y = 0; y < dst_height; y++) {
+        int sy = (int)(((long long)(2 * y + 1) * src_height << 15) / dst_height) - 32768;
+        if (sy < 0) sy = 0;
+        int y0 = sy >> 16;
+        int fy = (sy >> 8) & 0xFF;
+        if (y0 >= src_height - 1) {
+            y0 = src_height - 1;
+            fy = 0;
+        }
+        const unsigned char* row0 = src + y0 * src_stride;
+        const unsigned char* row1 = (fy > 0) ? row0 + src_stride : row0;
+        unsigned char* out = dst + y * dst_width * 4;
+
+        for (int x = 0; x < dst_width; x++) {
+            const unsigned char* p0 = row0 + x0[x] * 4;
+            const unsigned char* p1 = row1 + x0[x] * 4;
+            int fx = x_frac[x];
+            int step = (fx > 0) ? 4 : 0;
+            for (int c = 0; c < 4; c++) {
+                int top = p0[c] * (256 - fx) + p0[c + step] * fx;
+                int bottom = p1[c] * (256 - fx) + p1[c + step] * fx;
+                out[x * 4 + c] = (unsigned char)((top * (256 - fy) + bottom * fy + 32768) >> 16);
+            }
+        }
+    }
+}
+
+void image_downscale_rgba(const unsigned char* src, int src_width, int src_height, int src_stride,
+                          std::vector<unsigned char>& dst, int dst_width, int dst_height) {
+    dst.resize((size_t)dst_width * dst_height * 4);
+
+    if (dst_width == src_width && dst_height == src_height) {
+        for (int y = 0; y < src_height; y++) {
+            memcpy(&dst[(size_t)y * dst_width * 4], src + y * src_stride, dst_width * 4);
+        }
+        return;
+    }
+
+    // Box-halve while that doesn't overshoot; bilinear alone aliases past 2x
+    std::vector<unsigned char> halved;
+    std::vector<unsigned char> scratch;
+    while (src_width >= dst_width * 2 && src_height >= dst_height * 2) {
+        int half_width = src_width / 2;
+        int half_height = src_height / 2;
+        scratch.resize((size_t)half_width * half_height * 4);
+        halve_rgba(src, src_width, src_height, src_stride, scratch.data());
+        halved.swap(scratch);
+
+        src = halved.data();
+        src_width = half_width;
+        src_height = half_height;
+        src_stride = half_width * 4;
+    }
+
+    if (src_width == dst_width && src_height == dst_height) {
+        memcpy(dst.data(), src, dst.size());
+        return;
+    }
+    bilinear_rgba(src, src_width, src_height, src_stride, dst.data(), dst_width, dst_height);
+}
+
+void image_thumbnail_rgba(const unsigned char* src, int width, int height, int stride, int max_height,
+                          std::vector<unsigned char>& dst, int& dst_width, int& dst_height) {
+    dst_width = width;
+    dst_height = height;
+    if (height > max_height) {
+        dst_height = max_height;
+        dst_width = (width * max_height + height / 2) / height;
+        if (dst_width < 1) dst_width = 1;
+    }
+    image_downscale_rgba(src, width, height, stride, dst, dst_width, dst_height);
+}
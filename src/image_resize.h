@@ -0,0 +1,21 @@
+#ifndef IMAGE_RESIZE_H
+#define IMAGE_RESIZE_H
+
+#include <vector>
+
+// Fits width x height inside max_edge, keeping the aspect ratio. A max_edge
+// of 0 (or one the image already fits) leaves the size unchanged.
+void image_fit_size(int width, int height, int max_edge, int& out_width, int& out_height);
+
+// Downscales an RGBA image into dst (resized to dst_width * dst_height * 4).
+// Halves with a 2x2 box filter while the source is at least twice the target,
+// then finishes with a bilinear pass. src_stride is in bytes.
+void image_downscale_rgba(const unsigned char* src, int src_width, int src_height, int src_stride,
+                          std::vector<unsigned char>& dst, int dst_width, int dst_height);
+
+// Shrinks an image taller than max_height to that height, keeping the aspect
+// ratio. Smaller images are copied as they are.
+void image_thumbnail_rgba(const unsigned char* src, int width, int height, int stride, int max_height,
+                          std::vector<unsigned char>& dst, int& dst_width, int& dst_height);
+
+#endif
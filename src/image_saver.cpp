@@ -0,0 +1,179 @@
+#include "image_saver.h"
+#include "image_resize.h"
+#include <pthread.h>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <algorithm>
+
+#include "../libs/stb_image_write.h"
+
+#define IMAGE_SAVER_STACK_SIZE (128 * 1024)
+
+static const std::string TMP_SUFFIX = ".tmp";
+
+struct ImageSaveJob {
+    int id;
+    std::string path;
+    std::string thumbnail_path;
+    int thumbnail_height;
+    std::vector<unsigned char> rgba;
+    int width;
+    int height;
+};
+
+static ImageFileSystem s_fs;
+static pthread_t s_thread;
+static bool s_running = false;
+
+static std::mutex s_job_mutex;
+static std::condition_variable s_job_cv;
+static std::deque<ImageSaveJob> s_jobs;
+static bool s_stop = false;
+static int s_next_id = 1;
+
+static std::mutex s_result_mutex;
+static std::vector<ImageSaveResult> s_results;
+
+static void png_append_callback(void* context, void* data, int size) {
+    std::vector<unsigned char>* buffer = static_cast<std::vector<unsigned char>*>(context);
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    buffer->insert(buffer->end(), bytes, bytes + size);
+}
+
+// Writes next to the destination first so readers only ever see complete files
+static bool write_atomically(const std::string& path, const std::vector<unsigned char>& data) {
+    std::string tmp_path = path + TMP_SUFFIX;
+    if (!s_fs.write_file(tmp_path, data.data(), data.size())) {
+        s_fs.remove(tmp_path);
+        return false;
+    }
+    if (!s_fs.rename(tmp_path, path)) {
+        s_fs.remove(tmp_path);
+        return false;
+    }
+    return true;
+}
+
+static bool write_png(const std::string& path, const unsigned char* rgba, int width, int height, std::vector<unsigned char>& buffer) {
+    buffer.clear();
+    if (!stbi_write_png_to_func(png_append_callback, &buffer, width, height, 4, rgba, width * 4)) {
+        return false;
+    }
+    return write_atomically(path, buffer);
+}
+
+static bool run_job(const ImageSaveJob& job) {
+    if (job.width <= 0 || job.height <= 0 || job.rgba.size() != (size_t)job.width * job.height * 4) {
+        return false;
+    }
+
+    std::vector<unsigned char> png;
+    if (!write_png(job.path, job.rgba.data(), job.width, job.height, png)) {
+        return false;
+    }
+
+    // A missing thumbnail is regenerated on first draw, so its failure isn't fatal
+    if (!job.thumbnail_path.empty()) {
+        std::vector<unsigned char> thumbnail;
+        int thumb_width, thumb_height;
+        image_thumbnail_rgba(job.rgba.data(), job.width, job.height, job.width * 4, job.thumbnail_height,
+                             thumbnail, thumb_width, thumb_height);
+        write_png(job.thumbnail_path, thumbnail.data(), thumb_width, thumb_height, png);
+    }
+    return true;
+}
+
+static void* saver_main(void*) {
+    while (true) {
+        ImageSaveJob job;
+        {
+            std::unique_lock<std::mutex> lock(s_job_mutex);
+            s_job_cv.wait(lock, [] { return s_stop || !s_jobs.empty(); });
+            if (s_jobs.empty()) {
+                break; // stopping and drained
+            }
+            job = std::move(s_jobs.front());
+            s_jobs.pop_front();
+        }
+
+        ImageSaveResult result;
+        result.id = job.id;
+        result.path = job.path;
+        result.ok = run_job(job);
+
+        std::lock_guard<std::mutex> lock(s_result_mutex);
+        s_results.push_back(result);
+    }
+    return NULL;
+}
+
+bool image_saver_start(const ImageFileSystem& fs) {
+    if (s_running) {
+        return true;
+    }
+
+    s_fs = fs;
+    s_stop = false;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, IMAGE_SAVER_STACK_SIZE);
+    s_running = (pthread_create(&s_thread, &attr, saver_main, NULL) == 0);
+    pthread_attr_destroy(&attr);
+    return s_running;
+}
+
+void image_saver_stop() {
+    if (!s_running) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(s_job_mutex);
+        s_stop = true;
+    }
+    s_job_cv.notify_all();
+
+    pthread_join(s_thread, NULL);
+    s_running = false;
+}
+
+int image_saver_submit(const std::string& path, const std::string& thumbnail_path, int thumbnail_height,
+                       std::vector<unsigned char> rgba, int width, int height) {
+    ImageSaveJob job;
+    job.path = path;
+    job.thumbnail_path = thumbnail_path;
+    job.thumbnail_height = thumbnail_height;
+    job.rgba = std::move(rgba);
+    job.width = width;
+    job.height = height;
+
+    int id;
+    {
+        std::lock_guard<std::mutex> lock(s_job_mutex);
+        id = s_next_id++;
+        job.id = id;
+        s_jobs.push_back(std::move(job));
+    }
+    s_job_cv.notify_one();
+    return id;
+}
+
+void image_saver_poll(std::vector<ImageSaveResult>& results) {
+    results.clear();
+    std::lock_guard<std::mutex> lock(s_result_mutex);
+    results.swap(s_results);
+}
+
+void image_saver_remove_partials(const std::string& dir) {
+    if (!s_fs.list_dir) {
+        return;
+    }
+    for (const auto& name : s_fs.list_dir(dir)) {
+        if (name.size() > TMP_SUFFIX.size() &&
+            name.compare(name.size() - TMP_SUFFIX.size(), TMP_SUFFIX.size(), TMP_SUFFIX) == 0) {
+            s_fs.remove(dir + "/" + name);
+        }
+    }
+}
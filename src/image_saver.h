@@ -0,0 +1,46 @@
+#ifndef IMAGE_SAVER_H
+#define IMAGE_SAVER_H
+
+#include <string>
+#include <vector>
+#include <functional>
+
+// Background thread that PNG-encodes photos and writes them (plus their
+// thumbnails) without stalling the render thread. Each file is written to
+// "<path>.tmp" and renamed into place, so a crash mid-write leaves at most a
+// stray .tmp file that image_saver_remove_partials() cleans up on the next
+// start, never a truncated image under its real name.
+//
+// File access goes through an ImageFileSystem so the saver can run on a
+// host build against a fake or POSIX file system.
+
+struct ImageFileSystem {
+    std::function<bool(const std::string& path, const void* data, size_t len)> write_file;
+    std::function<bool(const std::string& from, const std::string& to)> rename;
+    std::function<void(const std::string& path)> remove;
+    std::function<std::vector<std::string>(const std::string& dir)> list_dir; // file names, not paths
+};
+
+struct ImageSaveResult {
+    int id = 0;
+    std::string path;
+    bool ok = false;
+};
+
+bool image_saver_start(const ImageFileSystem& fs);
+
+// Finishes every queued save, then stops the thread
+void image_saver_stop();
+
+// Queues a save and returns its id. The saver owns the pixels (tightly
+// packed RGBA). thumbnail_path may be empty to skip the thumbnail.
+int image_saver_submit(const std::string& path, const std::string& thumbnail_path, int thumbnail_height,
+                       std::vector<unsigned char> rgba, int width, int height);
+
+// Moves all results completed since the last call into results
+void image_saver_poll(std::vector<ImageSaveResult>& results);
+
+// Deletes .tmp files left in dir by an interrupted save
+void image_saver_remove_partials(const std::string& dir);
+
+#endif
@@ -5,6 +5,9 @@
 #include <sstream>
 #include <vector>
 #include <cstring>
+#include "base64.h"
+#include "image_resize.h"
+#include <algorithm>
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "../libs/stb_image_write.h"
@@ -12,108 +15,127 @@
 #include "../libs/stb_image.h"
 
 
-static const std::string base64_chars =
-             "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-             "abcdefghijklmnopqrstuvwxyz"
-             "0123456789+/";
-
-static inline std::string base64_encode(unsigned char const* bytes_to_encode, unsigned int in_len) {
-    std::string ret;
-    int i = 0;
-    int j = 0;
-    unsigned char char_array_3[3];
-    unsigned char char_array_4[4];
-
-    while (in_len--) {
-        char_array_3[i++] = *(bytes_to_encode++);
-        if (i == 3) {
-            char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-            char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-            char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-            char_array_4[3] = char_array_3[2] & 0x3f;
-
-            for(i = 0; (i <4) ; i++)
-                ret += base64_chars[char_array_4[i]];
-            i = 0;
-        }
-    }
+// Callback for stbi_write_jpg_to_func that base64-encodes as it goes
+static void base64_write_callback(void* context, void* data, int size) {
+    base64_stream_write(*static_cast<Base64Stream*>(context), static_cast<const unsigned char*>(data), size);
+}
 
-    if (i) {
-        for(j = i; j < 3; j++)
-            char_array_3[j] = '\0';
+bool append_rgba_as_base64_jpeg(std::string& out, const void* rgba, int width, int height, int quality) {
+    if (!rgba || width <= 0 || height <= 0) {
+        return false;
+    }
 
-        char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-        char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-        char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
+    // Camera frames rarely compress to more than ~3/8 byte per pixel, i.e. half a base64 char
+    out.reserve(out.size() + width * height / 2);
 
-        for (j = 0; (j < i + 1); j++)
-            ret += base64_chars[char_array_4[j]];
+    // The JPEG writer reads RGB from each 4-byte pixel and skips alpha, so the
+    // buffer doesn't need repacking first
+    Base64Stream stream;
+    stream.out = &out;
+    if (!stbi_write_jpg_to_func(base64_write_callback, &stream, width, height, 4, rgba, quality)) {
+        return false;
+    }
+    base64_stream_finish(stream);
+    return true;
+}
 
-        while((i++ < 3))
-            ret += '=';
+std::vector<unsigned char> copy_texture_pixels(vita2d_texture* texture) {
+    std::vector<unsigned char> pixels;
+    const unsigned char* data = static_cast<const unsigned char*>(vita2d_texture_get_datap(texture));
+    if (!data) {
+        return pixels;
     }
 
-    return ret;
+    int width = vita2d_texture_get_width(texture);
+    int height = vita2d_texture_get_height(texture);
+    int stride = vita2d_texture_get_stride(texture);
+    pixels.resize((size_t)width * height * 4);
+    for (int y = 0; y < height; y++) {
+        memcpy(&pixels[(size_t)y * width * 4], data + y * stride, width * 4);
+    }
+    return pixels;
 }
 
+static const std::string THUMBNAIL_SUFFIX = ".thumb.png";
+
+std::string thumbnail_path_for(const std::string& image_path) {
+    size_t dot = image_path.rfind('.');
+    size_t slash = image_path.find_last_of("/:");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        dot = image_path.size();
+    }
+    return image_path.substr(0, dot) + THUMBNAIL_SUFFIX;
+}
 
-// Callback for stbi_write_png_to_func
-static void png_write_callback(void* context, void* data, int size) {
-    std::vector<unsigned char>* buffer = static_cast<std::vector<unsigned char>*>(context);
-    const unsigned char* bytes = static_cast<const unsigned char*>(data);
-    buffer->insert(buffer->end(), bytes, bytes + size);
+static bool is_thumbnail_path(const std::string& path) {
+    return path.size() > THUMBNAIL_SUFFIX.size() &&
+           path.compare(path.size() - THUMBNAIL_SUFFIX.size(), THUMBNAIL_SUFFIX.size(), THUMBNAIL_SUFFIX) == 0;
 }
 
-std::string encode_texture_to_base64_png(vita2d_texture* texture) {
+// Creates a texture holding a copy of tightly packed RGBA pixels
+static vita2d_texture* create_texture_from_rgba(const unsigned char* rgba, int width, int height) {
+    vita2d_texture* texture = vita2d_create_empty_texture(width, height);
     if (!texture) {
-        return "";
+        return nullptr;
     }
 
-    int width = vita2d_texture_get_width(texture);
-    int height = vita2d_texture_get_height(texture);
-    const void* texture_data = vita2d_texture_get_datap(texture);
-
+    unsigned char* texture_data = static_cast<unsigned char*>(vita2d_texture_get_datap(texture));
     if (!texture_data) {
-        return "";
+        vita2d_free_texture(texture);
+        return nullptr;
     }
-
-    std::vector<unsigned char> png_buffer;
-    int result = stbi_write_png_to_func(
-        png_write_callback,
-        &png_buffer,
-        width,
-        height,
-        4, // 4 components: RGBA
-        texture_data,
-        width * 4 // Stride in bytes
-    );
-
-    if (result == 0) {
-        // Failed to write PNG
-        return "";
+    int stride = vita2d_texture_get_stride(texture);
+    for (int y = 0; y < height; y++) {
+        memcpy(texture_data + y * stride, rgba + y * width * 4, width * 4);
     }
-
-    return base64_encode(png_buffer.data(), png_buffer.size());
+    return texture;
 }
 
+vita2d_texture* load_thumbnail_texture(const std::string& image_path) {
+    std::string thumb_path = thumbnail_path_for(image_path);
+    vita2d_texture* texture = load_texture_from_file(thumb_path);
+    if (texture) {
+        return texture;
+    }
 
-bool save_texture_to_file(vita2d_texture* texture, const std::string& path) {
-    if (!texture) return false;
-    
-    // Get texture dimensions and data
-    int width = vita2d_texture_get_width(texture);
-    int height = vita2d_texture_get_height(texture);
-    void* texture_data = vita2d_texture_get_datap(texture);
-    
-    if (!texture_data) return false;
+    // No thumbnail yet: decode the full image once and have the image saver write one
+    int width, height, channels;
+    unsigned char* image_data = stbi_load(image_path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if (!image_data) {
+        return nullptr;
+    }
 
-    // The stride is the number of bytes from one row of pixels to the next.
-    int stride_in_bytes = width * 4;
-    int result = stbi_write_png(path.c_str(), width, height, 4, texture_data, stride_in_bytes);
+    std::vector<unsigned char> thumbnail;
+    int thumb_width, thumb_height;
+    image_thumbnail_rgba(image_data, width, height, width * 4, THUMBNAIL_HEIGHT, thumbnail, thumb_width, thumb_height);
+    stbi_image_free(image_data);
 
-    return result != 0;
+    texture = create_texture_from_rgba(thumbnail.data(), thumb_width, thumb_height);
+    image_saver_submit(thumb_path, "", 0, std::move(thumbnail), thumb_width, thumb_height);
+    return texture;
 }
 
+bool apply_image_save_result(std::vector<ChatSession>& sessions, const ImageSaveResult& result) {
+    bool changed = false;
+    for (auto& session : sessions) {
+        for (auto& msg : session.messages) {
+            if (!msg.image || msg.image_path != result.path) {
+                continue;
+            }
+            if (result.ok) {
+                // The last frame may still be drawing it
+                texture_cache_release(msg.image);
+                msg.image = NULL;
+            } else {
+                msg.image_path.clear();
+                msg.dirty = true;
+                session.dirty = true;
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
 
 vita2d_texture* load_texture_from_file(const std::string& path) {
     int width, height, channels;
@@ -125,23 +147,8 @@ vita2d_texture* load_texture_from_file(const std::string& path) {
         return nullptr; // Failed to load image
     }
 
-    // Create an empty vita2d texture
-    vita2d_texture* texture = vita2d_create_empty_texture(width, height);
-    if (!texture) {
-        stbi_image_free(image_data);
-        return nullptr;
-    }
-
-    // Get a pointer to the texture's data buffer
-    void* texture_data = vita2d_texture_get_datap(texture);
-    if (!texture_data) {
-        vita2d_free_texture(texture);
-        stbi_image_free(image_data);
-        return nullptr;
-    }
-
-    // Copy the loaded image data into the texture's buffer
-    memcpy(texture_data, image_data, width * height * 4); // 4 for RGBA
+    // Rows are copied one by one since the texture stride may be padded
+    vita2d_texture* texture = create_texture_from_rgba(image_data, width, height);
 
     // Free the memory allocated by stbi_load
     stbi_image_free(image_data);
@@ -149,9 +156,84 @@ vita2d_texture* load_texture_from_file(const std::string& path) {
     return texture;
 }
 
+bool read_image_size(const std::string& path, int& width, int& height) {
+    int channels;
+    return stbi_info(path.c_str(), &width, &height, &channels) != 0;
+}
+
+size_t texture_size_bytes(vita2d_texture* texture) {
+    return (size_t)vita2d_texture_get_stride(texture) * vita2d_texture_get_height(texture);
+}
+
+TextureAllocator native_texture_allocator() {
+    TextureAllocator allocator;
+    allocator.load = [](const std::string& path, size_t& bytes) {
+        vita2d_texture* texture;
+        if (is_thumbnail_path(path)) {
+            texture = load_thumbnail_texture(path.substr(0, path.size() - THUMBNAIL_SUFFIX.size()) + ".png");
+        } else {
+            texture = load_texture_from_file(path);
+        }
+        bytes = texture ? texture_size_bytes(texture) : 0;
+        return texture;
+    };
+    allocator.free = [](vita2d_texture* texture) {
+        vita2d_free_texture(texture);
+    };
+    return allocator;
+}
+
+ImageFileSystem native_image_file_system() {
+    ImageFileSystem fs;
+    fs.write_file = [](const std::string& path, const void* data, size_t len) {
+        SceUID fd = sceIoOpen(path.c_str(), SCE_O_WRONLY | SCE_O_CREAT | SCE_O_TRUNC, 0777);
+        if (fd < 0) {
+            return false;
+        }
+        const char* cursor = static_cast<const char*>(data);
+        size_t remaining = len;
+        while (remaining > 0) {
+            int written = sceIoWrite(fd, cursor, remaining);
+            if (written <= 0) {
+                break;
+            }
+            cursor += written;
+            remaining -= written;
+        }
+        // Make sure the data is on the card before the rename publishes it
+        bool ok = (remaining == 0) && sceIoSyncByFd(fd, 0) >= 0;
+        sceIoClose(fd);
+        return ok;
+    };
+    fs.rename = [](const std::string& from, const std::string& to) {
+        // sceIoRename won't replace an existing file
+        sceIoRemove(to.c_str());
+        return sceIoRename(from.c_str(), to.c_str()) >= 0;
+    };
+    fs.remove = [](const std::string& path) {
+        sceIoRemove(path.c_str());
+    };
+    fs.list_dir = [](const std::string& dir) {
+        std::vector<std::string> names;
+        SceUID dfd = sceIoDopen(dir.c_str());
+        if (dfd < 0) {
+            return names;
+        }
+        SceIoDirent entry;
+        memset(&entry, 0, sizeof(entry));
+        while (sceIoDread(dfd, &entry) > 0) {
+            names.push_back(entry.d_name);
+            memset(&entry, 0, sizeof(entry));
+        }
+        sceIoDclose(dfd);
+        return names;
+    };
+    return fs;
+}
+
 // Generate a unique filename for an image in a session
 std::string generate_image_filename(int session_id, int message_id) {
     std::stringstream ss;
-    ss << "ux0:data/vela/images/session_" << session_id << "_msg_" << message_id << ".png";
+    ss << "ux0:data/vela/images/chat_" << session_id << "_msg_" << message_id << ".png";
     return ss.str();
 } 
\ No newline at end of file
@@ -2,12 +2,51 @@
 
 #include <vita2d.h>
 #include <string>
+#include <vector>
+#include "texture_cache.h"
+#include "image_saver.h"
+#include "types.h"
 
+// Chat bubbles show images at this height, so thumbnails are stored at it
+#define THUMBNAIL_HEIGHT 150
 
-std::string encode_texture_to_base64_png(vita2d_texture* texture);
 
-bool save_texture_to_file(vita2d_texture* texture, const std::string& path);
+// JPEG-encodes a tightly packed RGBA buffer for upload and appends it to out
+// as base64. The encoder output goes straight through base64 into out, so no
+// intermediate JPEG or base64 copy is made. Alpha is dropped.
+bool append_rgba_as_base64_jpeg(std::string& out, const void* rgba, int width, int height, int quality);
+
+// Tightly packed copy of a texture's RGBA pixels
+std::vector<unsigned char> copy_texture_pixels(vita2d_texture* texture);
+
+// "…/session_1_msg_2.png" -> "…/session_1_msg_2.thumb.png"
+std::string thumbnail_path_for(const std::string& image_path);
+
+// Loads an image's thumbnail. If the file doesn't exist yet (e.g. for images
+// saved by older versions) it is made from the full image and queued on the
+// image saver.
+vita2d_texture* load_thumbnail_texture(const std::string& image_path);
+
+// Applies a finished photo save to the messages showing it. Once saved the
+// thumbnail is drawn like any other, so the full-size texture is released to
+// the texture cache; a failed save keeps the in-memory photo but stops
+// pointing the history at the missing file. Returns true if a session
+// changed and needs saving.
+bool apply_image_save_result(std::vector<ChatSession>& sessions, const ImageSaveResult& result);
 
 vita2d_texture* load_texture_from_file(const std::string& path);
 
+// Reads an image's dimensions from its header without decoding it
+bool read_image_size(const std::string& path, int& width, int& height);
+
+// Memory a texture occupies, for the texture cache budget
+size_t texture_size_bytes(vita2d_texture* texture);
+
+// Allocator for the texture cache backed by the functions above. Thumbnail
+// paths are loaded with load_thumbnail_texture, anything else at full size.
+TextureAllocator native_texture_allocator();
+
+// File system for the image saver backed by sceIo
+ImageFileSystem native_image_file_system();
+
 std::string generate_image_filename(int session_id, int message_id); 
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "settings.h"
 #include "persistence.h"
 #include "camera.h"
+#include "texture_cache.h"
 #include <psp2/ctrl.h>
 
 // a lot of potential to reuse code here but it works for now
@@ -238,6 +239,8 @@ void handle_sessions_input(
     AppState& app_state,
     int& scroll_offset
 ) {
+    int previous_session_index = current_session_index;
+
     if (!show_delete_confirmation) {
         // Normal session list navigation
         // Add analog stick support - similar to D-pad
@@ -273,7 +276,7 @@ void handle_sessions_input(
         if ((pad.buttons & SCE_CTRL_CROSS) && !(old_pad.buttons & SCE_CTRL_CROSS)) {
             if (session_selection_index == -1) {
                 // Create a new session
-                sessions.push_back(ChatSession());
+                sessions.push_back(new_chat_session());
                 current_session_index = sessions.size() - 1;
                 app_state = AppState::CHAT;
                 scroll_offset = 0; // Reset scroll when switching session
@@ -330,13 +333,16 @@ void handle_sessions_input(
             if (delete_confirmation_selection) {
                 // "Yes" was selected - delete the session
                 // Clean up any textures in the session's messages
-                for (auto& msg : sessions[session_selection_index]) {
+                for (auto& msg : sessions[session_selection_index].messages) {
                     if (msg.image) {
                         vita2d_free_texture(msg.image);
                         msg.image = NULL;
                     }
                 }
                 
+                // Its cached images won't be drawn again
+                texture_cache_clear();
+
                 // Remove the session
                 sessions.erase(sessions.begin() + session_selection_index);
                 
@@ -345,7 +351,7 @@ void handle_sessions_input(
 
                 // If all sessions were deleted, create a new empty one
                 if (sessions.empty()) {
-                    sessions.push_back(ChatSession());
+                    sessions.push_back(new_chat_session());
                     current_session_index = 0;
                     session_selection_index = 0;
                 } else {
@@ -381,6 +387,11 @@ void handle_sessions_input(
             save_sessions(sessions);
         }
     }
+
+    // Images of the session we left are evicted; the new one loads its own as they scroll into view
+    if (current_session_index != previous_session_index) {
+        texture_cache_clear();
+    }
 }
 
 // Handle input for the chat screen
@@ -396,14 +407,17 @@ void handle_chat_input(
     int& hovered_model_index,
     int& selected_model_index,
     int& scroll_offset,
-    int total_history_height,
+    const ChatLayout& layout,
     vita2d_texture*& staged_photo,
     vita2d_texture*& photo_to_free,
-    std::vector<ChatMessage>& chat_history,
+    ChatSession& session,
     const std::vector<std::string>& available_models,
     bool camera_initialized,
+    bool reply_in_flight,
     AppState& app_state
 ) {
+    std::vector<ChatMessage>& chat_history = session.messages;
+
     // First, try to handle camera input if camera is active
     if (camera_mode_active) {
         if (handle_camera_input(pad, old_pad, camera_mode_active, photo_taken, staged_photo, photo_to_free)) {
@@ -465,7 +479,8 @@ void handle_chat_input(
                 bool models_are_available = !available_models.empty();
 
                 if (current_selection == UISelection::INPUT_PILL) {
-                    if (models_are_available && keyboard_start("", "Enter your question")) {
+                    // One question at a time; the next one waits for the reply to finish
+                    if (models_are_available && !reply_in_flight && keyboard_start("", "Enter your question")) {
                         keyboard_active = true;
                     }
                 } else if (current_selection == UISelection::ACTION_BUTTON_1) {
@@ -565,7 +580,7 @@ void handle_chat_input(
                     scroll_offset += scroll_speed;
                     
                     // Bounds checking for scroll_offset
-                    int max_scroll = total_history_height - (SCREEN_HEIGHT - 150);
+                    int max_scroll = layout.total_height - (SCREEN_HEIGHT - 150);
                     if (max_scroll < 0) max_scroll = 0;
                     scroll_offset = std::max(0, std::min(scroll_offset, max_scroll));
 
@@ -576,29 +591,12 @@ void handle_chat_input(
                         hovered_message_index = chat_history.size() - 1;
                     } else {
                         int y_cursor = scroll_offset + (SCREEN_HEIGHT - 150) / 2;
-                        int current_y = 0;
                         int new_hovered_index = -1;
 
-                        for (int i = 0; i < chat_history.size(); i++) {
-                            const auto& msg = chat_history[i];
-                            bool has_image = (msg.image != NULL);
-                            
-                            // Calculate message height
-                            int message_height = 0;
-                            if (msg.sender == ChatMessage::USER) {
-                                message_height = msg.wrapped_text.size() * 20 + 20 + (has_image ? 150.0f + 20 : 0);
-                            } else {
-                                message_height = msg.wrapped_text.size() * 20 + 20 + (has_image ? 150.0f + 10 : 0);
-                                if (msg.show_reasoning && !msg.wrapped_reasoning.empty()) {
-                                    message_height += msg.wrapped_reasoning.size() * 20 + 30;
-                                }
-                            }
-
-                            if (y_cursor >= current_y && y_cursor < current_y + message_height) {
-                                new_hovered_index = i;
-                                break;
-                            }
-                            current_y += message_height + 10;
+                        // Nothing is hovered while the cursor is in the margin between messages
+                        size_t i = chat_layout_find(layout, y_cursor + 1);
+                        if (i < layout.tops.size() && y_cursor >= layout.tops[i]) {
+                            new_hovered_index = i;
                         }
                         hovered_message_index = new_hovered_index;
                     }
@@ -607,30 +605,12 @@ void handle_chat_input(
             
             // If message selection changed, adjust scroll to make the selected message visible
             if (message_selection_changed && !is_hard_scrolling && hovered_message_index >= 0 && hovered_message_index < chat_history.size()) {
-                // Calculate position of the selected message
+                // Position of the selected message
                 int message_position = 0;
                 int message_height = 0;
-                
-                for (int i = 0; i < chat_history.size(); i++) {
-                    const auto& msg = chat_history[i];
-                    bool has_image = (msg.image != NULL);
-                    
-                    // Calculate message height (similar to the calculation in draw_ui)
-                    if (msg.sender == ChatMessage::USER) {
-                        message_height = msg.wrapped_text.size() * 20 + 20 + (has_image ? 150.0f + 20 : 0);
-                    } else {
-                        message_height = msg.wrapped_text.size() * 20 + 20 + (has_image ? 150.0f + 10 : 0);
-                        if (msg.show_reasoning && !msg.wrapped_reasoning.empty()) {
-                            message_height += msg.wrapped_reasoning.size() * 20 + 30;
-                        }
-                    }
-                    
-                    if (i < hovered_message_index) {
-                        message_position += message_height + 10; // Add message height + margin
-                    } else if (i == hovered_message_index) {
-                        // We found our message, store its height for centering
-                        break;
-                    }
+                if (hovered_message_index < layout.tops.size()) {
+                    message_position = layout.tops[hovered_message_index];
+                    message_height = layout.bottoms[hovered_message_index] - message_position;
                 }
                 
                 // Adjust scroll to center the selected message in the visible area
@@ -642,7 +622,7 @@ void handle_chat_input(
                 scroll_offset += scroll_diff / 3; // Move 1/3 of the way to target for smoother scrolling
                 
                 // Ensure scroll is within bounds
-                int max_scroll = total_history_height - (SCREEN_HEIGHT - 150);
+                int max_scroll = layout.total_height - (SCREEN_HEIGHT - 150);
                 if (max_scroll < 0) max_scroll = 0;
                 scroll_offset = std::max(0, std::min(scroll_offset, max_scroll));
             }
@@ -653,6 +633,11 @@ void handle_chat_input(
                     ChatMessage& msg = chat_history[hovered_message_index];
                     if (msg.sender == ChatMessage::LLM && !msg.reasoning.empty()) {
                         msg.show_reasoning = !msg.show_reasoning;
+                        chat_layout_invalidate(session, hovered_message_index);
+                        msg.dirty = true;
+                        session.dirty = true;
+                    } else if (msg.sender == ChatMessage::USER && msg.has_image()) {
+                        app_state = AppState::IMAGE_VIEWER;
                     }
                 } else {
                     // If no message is hovered, fall back to the previous behavior
@@ -660,6 +645,9 @@ void handle_chat_input(
                     for (auto it = chat_history.rbegin(); it != chat_history.rend(); ++it) {
                         if (it->sender == ChatMessage::LLM && !it->reasoning.empty()) {
                             it->show_reasoning = !it->show_reasoning;
+                            chat_layout_invalidate(session, chat_history.rend() - it - 1);
+                            it->dirty = true;
+                            session.dirty = true;
                             break; // Only toggle the most recent LLM message
                         }
                     }
@@ -672,4 +660,11 @@ void handle_chat_input(
             }
         }
     }
-} 
\ No newline at end of file
+} 
+
+void handle_image_viewer_input(SceCtrlData& pad, SceCtrlData& old_pad, AppState& app_state) {
+    if (((pad.buttons & SCE_CTRL_CIRCLE) && !(old_pad.buttons & SCE_CTRL_CIRCLE)) ||
+        ((pad.buttons & SCE_CTRL_TRIANGLE) && !(old_pad.buttons & SCE_CTRL_TRIANGLE))) {
+        app_state = AppState::CHAT;
+    }
+}
@@ -6,6 +6,7 @@
 #include "types.h"
 #include "keyboard.h"
 #include "settings.h"
+#include "chat_layout.h"
 
 void handle_keyboard_input(std::string& input_text, bool& keyboard_active, KeyboardState& state);
 void handle_settings_keyboard(Settings& settings, SettingsSelection selection, bool& keyboard_active, KeyboardState& state);
@@ -22,12 +23,13 @@ void handle_chat_input(
     int& hovered_model_index,
     int& selected_model_index,
     int& scroll_offset,
-    int total_history_height,
+    const ChatLayout& layout,
     vita2d_texture*& staged_photo,
     vita2d_texture*& photo_to_free,
-    std::vector<ChatMessage>& chat_history,
+    ChatSession& session,
     const std::vector<std::string>& available_models,
     bool camera_initialized,
+    bool reply_in_flight,
     AppState& app_state
 );
 
@@ -66,4 +68,7 @@ bool is_right_stick_down(const SceCtrlData& pad, int deadzone = 50);
 bool is_right_stick_left(const SceCtrlData& pad, int deadzone = 50);
 bool is_right_stick_right(const SceCtrlData& pad, int deadzone = 50);
 
+// Closes the image viewer with Circle or Triangle
+void handle_image_viewer_input(SceCtrlData& pad, SceCtrlData& old_pad, AppState& app_state);
+
 #endif 
\ No newline at end of file
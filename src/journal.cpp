@@ -0,0 +1,48 @@
+#include "journal.h"
+#include <zlib.h>
+
+#define JOURNAL_HEADER_SIZE 8
+// Anything claiming to be bigger than this is garbage, not a message
+#define JOURNAL_MAX_RECORD (16 * 1024 * 1024)
+
+static void put_u32(std::string& out, unsigned int value) {
+    out += (char)(value & 0xFF);
+    out += (char)((value >> 8) & 0xFF);
+    out += (char)((value >> 16) & 0xFF);
+    out += (char)((value >> 24) & 0xFF);
+}
+
+static unsigned int get_u32(const unsigned char* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static unsigned int payload_crc(const char* data, size_t len) {
+    return (unsigned int)crc32(crc32(0L, Z_NULL, 0), (const Bytef*)data, (uInt)len);
+}
+
+void journal_append_record(std::string& out, const std::string& payload) {
+    out.reserve(out.size() + JOURNAL_HEADER_SIZE + payload.size());
+    put_u32(out, (unsigned int)payload.size());
+    put_u32(out, payload_crc(payload.data(), payload.size()));
+    out += payload;
+}
+
+size_t journal_read_records(const char* data, size_t len, std::vector<std::string>& records) {
+    size_t pos = 0;
+    while (len - pos >= JOURNAL_HEADER_SIZE) {
+        const unsigned char* header = (const unsigned char*)data + pos;
+        size_t size = get_u32(header);
+        unsigned int crc = get_u32(header + 4);
+        if (size > JOURNAL_MAX_RECORD || size > len - pos - JOURNAL_HEADER_SIZE) {
+            break;
+        }
+
+        const char* payload = data + pos + JOURNAL_HEADER_SIZE;
+        if (payload_crc(payload, size) != crc) {
+            break;
+        }
+        records.push_back(std::string(payload, size));
+        pos += JOURNAL_HEADER_SIZE + size;
+    }
+    return pos;
+}
@@ -0,0 +1,20 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// Framing for append-only journals. Each record is a 4-byte little-endian
+// payload length, the CRC-32 of the payload, then the payload itself, so a
+// record cut short by a power loss is detected when the file is read back.
+
+// Appends one framed record to out
+void journal_append_record(std::string& out, const std::string& payload);
+
+// Splits data into record payloads, stopping at the first record that is cut
+// short or fails its checksum. Returns the number of leading bytes that held
+// whole records; anything past that is a torn tail.
+size_t journal_read_records(const char* data, size_t len, std::vector<std::string>& records);
+
+#endif
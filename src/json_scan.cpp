@@ -0,0 +1,345 @@
+#include "json_scan.h"
+#include <cstring>
+
+#define JSON_SCAN_MAX_DEPTH 64
+#define JSON_SCAN_MAX_KEY 64
+#define JSON_SCAN_MAX_LITERAL 64
+
+void json_scan_reset(JsonScanner& scanner) {
+    scanner.frames.clear();
+    scanner.state = JsonScanState::VALUE;
+    scanner.value.clear();
+    scanner.in_key = false;
+    scanner.capturing = false;
+    scanner.escape = 0;
+    scanner.code_point = 0;
+    scanner.high_surrogate = 0;
+}
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool is_literal_char(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '-' || c == '+' || c == '.';
+}
+
+// Adds decoded string bytes to the key or captured value. Over-long keys are
+// blanked so they can't accidentally match a pattern.
+static void append_string_bytes(JsonScanner& scanner, const char* data, size_t len) {
+    if (scanner.in_key) {
+        std::string& key = scanner.frames.back().key;
+        if (key.size() + len <= JSON_SCAN_MAX_KEY) {
+            key.append(data, len);
+        } else {
+            key = "\x01";
+        }
+    } else if (scanner.capturing) {
+        scanner.value.append(data, len);
+    }
+}
+
+static void append_code_point(JsonScanner& scanner, unsigned int cp) {
+    char utf8[4];
+    size_t len;
+    if (cp < 0x80) {
+        utf8[0] = (char)cp;
+        len = 1;
+    } else if (cp < 0x800) {
+        utf8[0] = (char)(0xC0 | (cp >> 6));
+        utf8[1] = (char)(0x80 | (cp & 0x3F));
+        len = 2;
+    } else if (cp < 0x10000) {
+        utf8[0] = (char)(0xE0 | (cp >> 12));
+        utf8[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        utf8[2] = (char)(0x80 | (cp & 0x3F));
+        len = 3;
+    } else {
+        utf8[0] = (char)(0xF0 | (cp >> 18));
+        utf8[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        utf8[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        utf8[3] = (char)(0x80 | (cp & 0x3F));
+        len = 4;
+    }
+    append_string_bytes(scanner, utf8, len);
+}
+
+// Handles the \uXXXX once all four digits are in, pairing up surrogates
+static void finish_unicode_escape(JsonScanner& scanner) {
+    unsigned int cp = scanner.code_point;
+    if (cp >= 0xD800 && cp <= 0xDBFF) {
+        scanner.high_surrogate = cp;
+        return;
+    }
+    if (cp >= 0xDC00 && cp <= 0xDFFF) {
+        cp = scanner.high_surrogate ? 0x10000 + ((scanner.high_surrogate - 0xD800) << 10) + (cp - 0xDC00) : 0xFFFD;
+    }
+    scanner.high_surrogate = 0;
+    append_code_point(scanner, cp);
+}
+
+static bool read_escape(JsonScanner& scanner, char c) {
+    if (scanner.escape >= 2) {
+        unsigned int digit;
+        if (c >= '0' && c <= '9') digit = c - '0';
+        else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+        else return false;
+
+        scanner.code_point = (scanner.code_point << 4) | digit;
+        if (++scanner.escape == 6) {
+            scanner.escape = 0;
+            finish_unicode_escape(scanner);
+        }
+        return true;
+    }
+
+    char decoded;
+    switch (c) {
+        case '"':  decoded = '"'; break;
+        case '\\': decoded = '\\'; break;
+        case '/':  decoded = '/'; break;
+        case 'b':  decoded = '\b'; break;
+        case 'f':  decoded = '\f'; break;
+        case 'n':  decoded = '\n'; break;
+        case 'r':  decoded = '\r'; break;
+        case 't':  decoded = '\t'; break;
+        case 'u':
+            scanner.escape = 2;
+            scanner.code_point = 0;
+            return true;
+        default:
+            return false;
+    }
+    scanner.escape = 0;
+    scanner.high_surrogate = 0;
+    append_string_bytes(scanner, &decoded, 1);
+    return true;
+}
+
+static void finish_value(JsonScanner& scanner) {
+    scanner.state = scanner.frames.empty() ? JsonScanState::DONE : JsonScanState::AFTER_VALUE;
+}
+
+static void begin_scalar(JsonScanner& scanner, const JsonScanHandler& handler) {
+    scanner.capturing = handler.want && handler.want(scanner);
+    scanner.value.clear();
+}
+
+static bool finish_literal(JsonScanner& scanner, const JsonScanHandler& handler) {
+    const std::string& text = scanner.value;
+    JsonScanKind kind;
+    if (text == "true" || text == "false") {
+        kind = JsonScanKind::BOOL;
+    } else if (text == "null") {
+        kind = JsonScanKind::NUL;
+    } else if (text[0] == '-' || (text[0] >= '0' && text[0] <= '9')) {
+        kind = JsonScanKind::NUMBER;
+    } else {
+        return false;
+    }
+
+    if (scanner.capturing && handler.on_value) {
+        handler.on_value(scanner, kind, text);
+    }
+    finish_value(scanner);
+    return true;
+}
+
+static bool push_frame(JsonScanner& scanner, bool is_array) {
+    if (scanner.frames.size() >= JSON_SCAN_MAX_DEPTH) {
+        return false;
+    }
+    scanner.frames.push_back(JsonScanFrame());
+    scanner.frames.back().is_array = is_array;
+    scanner.state = is_array ? JsonScanState::FIRST_VALUE_OR_END : JsonScanState::FIRST_KEY_OR_END;
+    return true;
+}
+
+static void pop_frame(JsonScanner& scanner) {
+    scanner.frames.pop_back();
+    finish_value(scanner);
+}
+
+static void begin_key(JsonScanner& scanner) {
+    scanner.frames.back().key.clear();
+    scanner.in_key = true;
+    scanner.capturing = false;
+    scanner.state = JsonScanState::STRING;
+}
+
+static bool begin_value(JsonScanner& scanner, char c, const JsonScanHandler& handler) {
+    if (c == '{') {
+        return push_frame(scanner, false);
+    }
+    if (c == '[') {
+        return push_frame(scanner, true);
+    }
+    if (c == '"') {
+        begin_scalar(scanner, handler);
+        scanner.in_key = false;
+        scanner.state = JsonScanState::STRING;
+        return true;
+    }
+    if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+        begin_scalar(scanner, handler);
+        // Literals are tiny, so they're always buffered to validate them
+        scanner.value += c;
+        scanner.state = JsonScanState::LITERAL;
+        return true;
+    }
+    return false;
+}
+
+static bool fail(JsonScanner& scanner) {
+    scanner.state = JsonScanState::FAILED;
+    return false;
+}
+
+bool json_scan_feed(JsonScanner& scanner, const char* data, size_t len, const JsonScanHandler& handler) {
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+
+        switch (scanner.state) {
+            case JsonScanState::STRING: {
+                if (scanner.escape) {
+                    if (!read_escape(scanner, c)) return fail(scanner);
+                    break;
+                }
+
+                // Copy the run up to the next quote or escape in one go
+                size_t run_end = i;
+                while (run_end < len && data[run_end] != '"' && data[run_end] != '\\') {
+                    run_end++;
+                }
+                if (run_end > i) {
+                    scanner.high_surrogate = 0;
+                    append_string_bytes(scanner, data + i, run_end - i);
+                }
+                i = run_end;
+                if (i == len) {
+                    return true;
+                }
+
+                if (data[i] == '\\') {
+                    scanner.escape = 1;
+                } else if (scanner.in_key) {
+                    scanner.in_key = false;
+                    scanner.state = JsonScanState::COLON;
+                } else {
+                    if (scanner.capturing && handler.on_value) {
+                        handler.on_value(scanner, JsonScanKind::STRING, scanner.value);
+                    }
+                    finish_value(scanner);
+                }
+                break;
+            }
+
+            case JsonScanState::LITERAL:
+                if (is_literal_char(c)) {
+                    if (scanner.value.size() >= JSON_SCAN_MAX_LITERAL) return fail(scanner);
+                    scanner.value += c;
+                    break;
+                }
+                if (!finish_literal(scanner, handler)) return fail(scanner);
+                i--; // the delimiter belongs to the enclosing state
+                break;
+
+            case JsonScanState::FAILED:
+                return false;
+
+            default:
+                if (is_space(c)) {
+                    break;
+                }
+
+                switch (scanner.state) {
+                    case JsonScanState::FIRST_VALUE_OR_END:
+                        if (c == ']') {
+                            pop_frame(scanner);
+                            break;
+                        }
+                        // fall through
+                    case JsonScanState::VALUE:
+                        if (!begin_value(scanner, c, handler)) return fail(scanner);
+                        break;
+
+                    case JsonScanState::FIRST_KEY_OR_END:
+                        if (c == '}') {
+                            pop_frame(scanner);
+                            break;
+                        }
+                        // fall through
+                    case JsonScanState::KEY:
+                        if (c != '"') return fail(scanner);
+                        begin_key(scanner);
+                        break;
+
+                    case JsonScanState::COLON:
+                        if (c != ':') return fail(scanner);
+                        scanner.state = JsonScanState::VALUE;
+                        break;
+
+                    case JsonScanState::AFTER_VALUE: {
+                        JsonScanFrame& top = scanner.frames.back();
+                        if (c == ',') {
+                            if (top.is_array) {
+                                top.index++;
+                                scanner.state = JsonScanState::VALUE;
+                            } else {
+                                scanner.state = JsonScanState::KEY;
+                            }
+                        } else if ((c == ']' && top.is_array) || (c == '}' && !top.is_array)) {
+                            pop_frame(scanner);
+                        } else {
+                            return fail(scanner);
+                        }
+                        break;
+                    }
+
+                    default:
+                        // Anything but whitespace after the document ends
+                        return fail(scanner);
+                }
+                break;
+        }
+    }
+    return true;
+}
+
+bool json_scan_finish(JsonScanner& scanner, const JsonScanHandler& handler) {
+    if (scanner.state == JsonScanState::LITERAL && scanner.frames.empty()) {
+        if (!finish_literal(scanner, handler)) return fail(scanner);
+    }
+    return scanner.state == JsonScanState::DONE;
+}
+
+bool json_scan_at(const JsonScanner& scanner, const char* path) {
+    const char* segment = path;
+    for (const auto& frame : scanner.frames) {
+        if (*segment == '\0') {
+            return false;
+        }
+        const char* end = strchr(segment, '.');
+        if (!end) {
+            end = segment + strlen(segment);
+        }
+        size_t segment_len = end - segment;
+
+        if (!(segment_len == 1 && *segment == '*')) {
+            if (frame.is_array) {
+                int index = 0;
+                for (const char* p = segment; p < end; p++) {
+                    if (*p < '0' || *p > '9') return false;
+                    index = index * 10 + (*p - '0');
+                }
+                if (segment_len == 0 || index != frame.index) return false;
+            } else if (frame.key.size() != segment_len || frame.key.compare(0, segment_len, segment, segment_len) != 0) {
+                return false;
+            }
+        }
+
+        segment = (*end == '.') ? end + 1 : end;
+    }
+    return *segment == '\0';
+}
@@ -0,0 +1,71 @@
+#ifndef JSON_SCAN_H
+#define JSON_SCAN_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <functional>
+
+// Push-style JSON scanner that never builds a document. Bytes are fed in as
+// they arrive; the scanner keeps only the current path (one frame per open
+// object/array) and hands scalar values to a handler. Strings the handler
+// doesn't ask for are skipped without being buffered, so memory stays bounded
+// by nesting depth plus whatever fields the caller actually keeps.
+
+enum class JsonScanKind {
+    STRING,
+    NUMBER,
+    BOOL,
+    NUL
+};
+
+enum class JsonScanState {
+    VALUE,
+    FIRST_VALUE_OR_END,
+    FIRST_KEY_OR_END,
+    KEY,
+    COLON,
+    AFTER_VALUE,
+    STRING,
+    LITERAL,
+    DONE,
+    FAILED
+};
+
+struct JsonScanFrame {
+    bool is_array = false;
+    int index = 0;       // arrays: index of the current element
+    std::string key;     // objects: key of the current member
+};
+
+struct JsonScanner {
+    std::vector<JsonScanFrame> frames;
+    JsonScanState state = JsonScanState::VALUE;
+    std::string value;           // captured string/literal being read
+    bool in_key = false;
+    bool capturing = false;
+    int escape = 0;              // 0 = none, 1 = after '\', 2..5 = reading \uXXXX digits
+    unsigned int code_point = 0;
+    unsigned int high_surrogate = 0;
+};
+
+struct JsonScanHandler {
+    // Called when a scalar value starts. Return true to have it passed to on_value.
+    std::function<bool(const JsonScanner& scanner)> want;
+    std::function<void(const JsonScanner& scanner, JsonScanKind kind, const std::string& value)> on_value;
+};
+
+// Clears the scanner for a new document, keeping its buffers
+void json_scan_reset(JsonScanner& scanner);
+
+// Feeds the next bytes of the document. Returns false once the input is malformed.
+bool json_scan_feed(JsonScanner& scanner, const char* data, size_t len, const JsonScanHandler& handler);
+
+// Ends the input. Returns true if exactly one complete value was read.
+bool json_scan_finish(JsonScanner& scanner, const JsonScanHandler& handler);
+
+// Checks the current path against a dotted pattern like "choices.0.delta.content".
+// Numeric segments match array indexes and "*" matches any key or index.
+bool json_scan_at(const JsonScanner& scanner, const char* path);
+
+#endif
@@ -1,174 +1,368 @@
 #include "net.h"
 #include <psp2/net/http.h>
 #include <psp2/libssl.h>
+#include <psp2/kernel/processmgr.h>
+#include <psp2/kernel/clib.h>
 #include <string>
 #include <vector>
 #include <cstring>
-#include <jsoncpp/json/json.h>
+#include <cctype>
+#include <mutex>
 
 #include "config.h"
-#include "settings.h"
+#include "image_utils.h"
+
+// --- Connection pool ---
+// Templates and keep-alive connections are kept around between requests so
+// follow-up turns skip the TCP and TLS handshakes. All requests run on the
+// network worker thread, so the pool needs no locking.
+
+#define HTTP_POOL_MAX_CONNECTIONS 4
+#define HTTP_POOL_IDLE_TIMEOUT_US (30 * 1000 * 1000)  // most servers drop idle keep-alives well before this
+
+struct PooledConnection {
+    std::string key;        // scheme://host:port
+    int conn;
+    SceUInt64 last_used;
+    bool in_use;
+};
+
+static int s_http_template = -1;
+static std::vector<PooledConnection> s_http_pool;
+static HttpPoolStats s_http_pool_stats;
+
+// Reduces a URL to the scheme://host:port it connects to
+static std::string connection_key(const std::string& url) {
+    size_t scheme_end = url.find("://");
+    std::string scheme = (scheme_end == std::string::npos) ? "http" : url.substr(0, scheme_end);
+    size_t host_start = (scheme_end == std::string::npos) ? 0 : scheme_end + 3;
+    size_t host_end = url.find_first_of("/?#", host_start);
+    std::string host = url.substr(host_start, host_end == std::string::npos ? std::string::npos : host_end - host_start);
+
+    size_t at = host.rfind('@');
+    if (at != std::string::npos) {
+        host = host.substr(at + 1);
+    }
+
+    std::string key = scheme + "://" + host;
+    for (auto& c : key) {
+        c = tolower(c);
+    }
+    if (host.find(':') == std::string::npos || (host[0] == '[' && host.find("]:") == std::string::npos)) {
+        key += (scheme == "https") ? ":443" : ":80";
+    }
+    return key;
+}
 
-std::string nativePostRequest(const std::string& url, const std::string& postdata, const std::string& apiKey) {
-    int tpl = -1, conn = -1, req = -1;
-    std::string response_string;
+static void pool_close(PooledConnection& pooled) {
+    sceHttpDeleteConnection(pooled.conn);
+    s_http_pool_stats.evictions++;
+}
+
+// Drops connections that sat idle long enough for the server to have closed them
+static void pool_evict_idle(SceUInt64 now) {
+    for (auto it = s_http_pool.begin(); it != s_http_pool.end();) {
+        if (!it->in_use && now - it->last_used > HTTP_POOL_IDLE_TIMEOUT_US) {
+            pool_close(*it);
+            it = s_http_pool.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
 
-    tpl = sceHttpCreateTemplate("vela_http_template", 2, 1);
-    if (tpl < 0) {
-        return "Error: sceHttpCreateTemplate failed";
+// Returns a connection for url, reusing an idle keep-alive one when possible
+static int pool_acquire(const std::string& url, bool& reused) {
+    SceUInt64 now = sceKernelGetProcessTimeWide();
+    pool_evict_idle(now);
+
+    std::string key = connection_key(url);
+    for (auto& pooled : s_http_pool) {
+        if (!pooled.in_use && pooled.key == key) {
+            pooled.in_use = true;
+            s_http_pool_stats.hits++;
+            reused = true;
+            return pooled.conn;
+        }
     }
 
-    sceHttpAddRequestHeader(tpl, "Content-Type", "application/json", SCE_HTTP_HEADER_ADD);
-    if (!apiKey.empty()) {
-        std::string bearer_token = "Bearer " + apiKey;
-        sceHttpAddRequestHeader(tpl, "Authorization", bearer_token.c_str(), SCE_HTTP_HEADER_ADD);
+    reused = false;
+    s_http_pool_stats.misses++;
+
+    if (s_http_template < 0) {
+        s_http_template = sceHttpCreateTemplate("vela_http_template", 2, 1);
+        if (s_http_template < 0) {
+            return s_http_template;
+        }
     }
 
-    conn = sceHttpCreateConnectionWithURL(tpl, url.c_str(), 1);
-    if (conn < 0) {
-        sceHttpDeleteTemplate(tpl);
-        return "Error: sceHttpCreateConnectionWithURL failed";
+    // Make room by dropping the least recently used idle connection
+    if (s_http_pool.size() >= HTTP_POOL_MAX_CONNECTIONS) {
+        auto oldest = s_http_pool.end();
+        for (auto it = s_http_pool.begin(); it != s_http_pool.end(); ++it) {
+            if (!it->in_use && (oldest == s_http_pool.end() || it->last_used < oldest->last_used)) {
+                oldest = it;
+            }
+        }
+        if (oldest != s_http_pool.end()) {
+            pool_close(*oldest);
+            s_http_pool.erase(oldest);
+        }
     }
 
-    req = sceHttpCreateRequestWithURL(conn, SCE_HTTP_METHOD_POST, url.c_str(), postdata.length());
-    if (req < 0) {
-        sceHttpDeleteConnection(conn);
-        sceHttpDeleteTemplate(tpl);
-        return "Error: sceHttpCreateRequestWithURL failed";
+    int conn = sceHttpCreateConnectionWithURL(s_http_template, url.c_str(), 1);
+    if (conn < 0) {
+        return conn;
     }
 
-    if (sceHttpSendRequest(req, postdata.c_str(), postdata.length()) < 0) {
-        sceHttpDeleteRequest(req);
-        sceHttpDeleteConnection(conn);
-        sceHttpDeleteTemplate(tpl);
-        return "Error: sceHttpSendRequest failed";
+    PooledConnection pooled;
+    pooled.key = key;
+    pooled.conn = conn;
+    pooled.last_used = now;
+    pooled.in_use = true;
+    s_http_pool.push_back(pooled);
+    return conn;
+}
+
+// Hands a connection back. Unhealthy ones are closed instead of kept.
+static void pool_release(int conn, bool healthy) {
+    for (auto it = s_http_pool.begin(); it != s_http_pool.end(); ++it) {
+        if (it->conn == conn) {
+            if (healthy) {
+                it->in_use = false;
+                it->last_used = sceKernelGetProcessTimeWide();
+            } else {
+                pool_close(*it);
+                s_http_pool.erase(it);
+            }
+            return;
+        }
     }
+}
 
-    char buffer[4096];
-    int n, offset = 0;
-    std::vector<char> response_data;
+HttpPoolStats http_pool_stats() {
+    return s_http_pool_stats;
+}
 
-    while ((n = sceHttpReadData(req, buffer, sizeof(buffer))) > 0) {
-        response_data.insert(response_data.end(), buffer, buffer + n);
+void http_pool_clear() {
+    for (auto& pooled : s_http_pool) {
+        sceHttpDeleteConnection(pooled.conn);
     }
+    s_http_pool.clear();
 
-    if (!response_data.empty()) {
-        response_string = std::string(response_data.begin(), response_data.end());
-    } else {
-        response_string = "Error: No data received";
+    if (s_http_template >= 0) {
+        sceHttpDeleteTemplate(s_http_template);
+        s_http_template = -1;
     }
+}
 
-    sceHttpDeleteRequest(req);
-    sceHttpDeleteConnection(conn);
-    sceHttpDeleteTemplate(tpl);
+// --- Aborting ---
+// Cancels come from the render thread, and net_worker_stop at exit, while
+// the worker may be blocked in a send or read. The sceHttp request serving
+// the worker's current NetRequest is registered here so http_abort can
+// interrupt it instead of waiting for the server to reply or time out.
 
-    return response_string;
+static std::mutex s_abort_mutex;
+static int s_serving_id = 0;    // NetRequest the worker is running, 0 outside the transport
+static int s_aborted_id = 0;    // NetRequest ids only grow, so this never needs clearing
+static int s_current_req = -1;
+
+static void http_serve(int request_id) {
+    std::lock_guard<std::mutex> lock(s_abort_mutex);
+    s_serving_id = request_id;
 }
 
-std::string nativeGetRequest(const std::string& url, const std::string& apiKey) {
-    int tpl = -1, conn = -1, req = -1;
-    std::string response_string;
+static bool http_aborted() {
+    std::lock_guard<std::mutex> lock(s_abort_mutex);
+    return s_serving_id != 0 && s_aborted_id == s_serving_id;
+}
 
-    tpl = sceHttpCreateTemplate("vela_http_template_get", 2, 1);
-    if (tpl < 0) {
-        return "Error: sceHttpCreateTemplate failed";
+// Makes req the one http_abort interrupts. Fails if the request was already aborted.
+static bool http_register(int req) {
+    std::lock_guard<std::mutex> lock(s_abort_mutex);
+    if (s_serving_id != 0 && s_aborted_id == s_serving_id) {
+        return false;
     }
+    s_current_req = req;
+    return true;
+}
 
-    if (!apiKey.empty()) {
-        std::string bearer_token = "Bearer " + apiKey;
-        sceHttpAddRequestHeader(tpl, "Authorization", bearer_token.c_str(), SCE_HTTP_HEADER_ADD);
-    }
+static void http_unregister() {
+    std::lock_guard<std::mutex> lock(s_abort_mutex);
+    s_current_req = -1;
+}
 
-    conn = sceHttpCreateConnectionWithURL(tpl, url.c_str(), 1);
-    if (conn < 0) {
-        sceHttpDeleteTemplate(tpl);
-        return "Error: sceHttpCreateConnectionWithURL failed";
+static void http_abort(int request_id) {
+    std::lock_guard<std::mutex> lock(s_abort_mutex);
+    s_aborted_id = request_id;
+    if (s_serving_id == request_id && s_current_req >= 0) {
+        sceHttpAbortRequest(s_current_req);
     }
+}
 
-    req = sceHttpCreateRequestWithURL(conn, SCE_HTTP_METHOD_GET, url.c_str(), 0);
-    if (req < 0) {
-        sceHttpDeleteConnection(conn);
-        sceHttpDeleteTemplate(tpl);
-        return "Error: sceHttpCreateRequestWithURL failed";
-    }
+// Runs one request over a pooled connection. A reused connection the server
+// has already closed fails on create/send or on the first read; in that case
+// the connection is dropped and the request retried once on a fresh one.
+static std::string http_request(int method, const std::string& url, const char* body, unsigned int body_len,
+                                const std::string& apiKey, const HttpChunkCallback& on_chunk) {
+    for (int attempt = 0; attempt < 2; attempt++) {
+        bool reused = false;
+        int conn = pool_acquire(url, reused);
+        if (conn < 0) {
+            return s_http_template < 0 ? "Error: sceHttpCreateTemplate failed" : "Error: sceHttpCreateConnectionWithURL failed";
+        }
 
-    if (sceHttpSendRequest(req, NULL, 0) < 0) {
-        sceHttpDeleteRequest(req);
-        sceHttpDeleteConnection(conn);
-        sceHttpDeleteTemplate(tpl);
-        return "Error: sceHttpSendRequest failed";
-    }
+        int req = sceHttpCreateRequestWithURL(conn, method, url.c_str(), body_len);
+        if (req < 0) {
+            pool_release(conn, false);
+            if (reused) {
+                s_http_pool_stats.stale_retries++;
+                continue;
+            }
+            return "Error: sceHttpCreateRequestWithURL failed";
+        }
+        if (!http_register(req)) {
+            sceHttpDeleteRequest(req);
+            pool_release(conn, true);
+            return "Error: cancelled";
+        }
 
-    char buffer[4096];
-    std::vector<char> response_data;
+        if (method == SCE_HTTP_METHOD_POST) {
+            sceHttpAddRequestHeader(req, "Content-Type", "application/json", SCE_HTTP_HEADER_ADD);
+        }
+        if (!apiKey.empty()) {
+            std::string bearer_token = "Bearer " + apiKey;
+            sceHttpAddRequestHeader(req, "Authorization", bearer_token.c_str(), SCE_HTTP_HEADER_ADD);
+        }
 
-    while (true) {
-        int n = sceHttpReadData(req, buffer, sizeof(buffer));
-        if (n < 0) {
-            response_string = "Error: sceHttpReadData failed";
-            break;
+        // On a fresh connection the send includes the TCP + TLS handshake
+        SceUInt64 send_start = sceKernelGetProcessTimeWide();
+        if (sceHttpSendRequest(req, body, body_len) < 0) {
+            http_unregister();
+            sceHttpDeleteRequest(req);
+            pool_release(conn, false);
+            if (http_aborted()) {
+                return "Error: cancelled";
+            }
+            if (reused) {
+                s_http_pool_stats.stale_retries++;
+                continue;
+            }
+            return "Error: sceHttpSendRequest failed";
         }
-        if (n == 0) {
-            break; // End of response
+        SceUInt64 send_time = sceKernelGetProcessTimeWide() - send_start;
+        if (reused) {
+            s_http_pool_stats.reused_send_us += send_time;
+        } else {
+            s_http_pool_stats.handshakes++;
+            s_http_pool_stats.handshake_send_us += send_time;
         }
-        response_data.insert(response_data.end(), buffer, buffer + n);
-    }
 
-    if (response_string.empty() && !response_data.empty()) {
-        response_string = std::string(response_data.begin(), response_data.end());
-    } else if (response_data.empty()) {
-        response_string = "Error: No data received";
-    }
+        char buffer[4096];
+        int n;
+        size_t received = 0;
+        std::vector<char> response_data;
+
+        while ((n = sceHttpReadData(req, buffer, sizeof(buffer))) > 0) {
+            received += n;
+            if (on_chunk) {
+                // Streaming: hand each chunk over as soon as it arrives
+                if (!on_chunk(buffer, n)) {
+                    break;
+                }
+            } else {
+                response_data.insert(response_data.end(), buffer, buffer + n);
+            }
+        }
 
-    sceHttpDeleteRequest(req);
-    sceHttpDeleteConnection(conn);
-    sceHttpDeleteTemplate(tpl);
+        // A read error or an abandoned stream leaves the connection in an unknown state
+        bool healthy = (n == 0);
+        http_unregister();
+        sceHttpDeleteRequest(req);
+        pool_release(conn, healthy);
 
-    return response_string;
-}
+        if (n < 0 && http_aborted()) {
+            return "Error: cancelled";
+        }
 
-std::string nativePostRequestWithImage(const std::string& url, const std::string& text_prompt, const std::string& base64_image, const std::string& model, const std::string& apiKey) {
-    Json::Value root;
-    Json::Value messages(Json::arrayValue);
-    Json::Value user_message;
-    Json::Value content(Json::arrayValue);
+        if (n < 0 && received == 0 && reused) {
+            s_http_pool_stats.stale_retries++;
+            continue;
+        }
 
-    // Text part
-    Json::Value text_part;
-    text_part["type"] = "text";
-    text_part["text"] = text_prompt;
-    content.append(text_part);
+        if (n < 0 && received == 0) {
+            return "Error: sceHttpReadData failed";
+        }
+        if (received == 0) {
+            return "Error: No data received";
+        }
+        if (on_chunk) {
+            return "";
+        }
+        return std::string(response_data.begin(), response_data.end());
+    }
 
-    // Image part
-    Json::Value image_part;
-    image_part["type"] = "image_url";
-    Json::Value image_url;
-    image_url["url"] = "data:image/png;base64," + base64_image;
-    image_part["image_url"] = image_url;
-    content.append(image_part);
-    
-    user_message["role"] = "user";
-    user_message["content"] = content;
-    messages.append(user_message);
+    return "Error: connection closed by server";
+}
+
+std::string nativePostRequest(const std::string& url, const std::string& postdata, const std::string& apiKey, const HttpChunkCallback& on_chunk) {
+    return http_request(SCE_HTTP_METHOD_POST, url, postdata.c_str(), postdata.length(), apiKey, on_chunk);
+}
 
-    root["model"] = model;
-    root["messages"] = messages;
+// Outgoing bodies are built here so large image uploads reuse one allocation.
+// Only the network worker sends requests, so no locking is needed.
+static std::string s_send_buffer;
+
+std::string nativePostRequest(const std::string& url, const RequestBody& body, const std::string& apiKey, const HttpChunkCallback& on_chunk) {
+    // sceHttpSendRequest takes the body in one call, so gather the fragments
+    body.gather(s_send_buffer);
+    return http_request(SCE_HTTP_METHOD_POST, url, s_send_buffer.c_str(), s_send_buffer.length(), apiKey, on_chunk);
+}
 
-    Json::StreamWriterBuilder writer;
-    std::string json_payload = Json::writeString(writer, root);
+std::string nativeGetRequest(const std::string& url, const std::string& apiKey, const HttpChunkCallback& on_chunk) {
+    return http_request(SCE_HTTP_METHOD_GET, url, NULL, 0, apiKey, on_chunk);
+}
 
-    return nativePostRequest(url, json_payload, apiKey);
+std::string nativePostRequestWithImage(const std::string& url, const std::string& text_prompt, const void* rgba, int width, int height, int quality,
+                                       const std::string& model, const std::string& apiKey, const HttpChunkCallback& on_chunk) {
+    // The JSON is written around the image by hand so the encoder can append
+    // its base64 output straight into the body
+    std::string& body = s_send_buffer;
+    body = "{\"model\":";
+    json_append_string(body, model);
+    if (on_chunk) {
+        body += ",\"stream\":true";
+    }
+    body += ",\"messages\":[{\"role\":\"user\",\"content\":[{\"type\":\"text\",\"text\":";
+    json_append_string(body, text_prompt);
+    body += "},{\"type\":\"image_url\",\"image_url\":{\"url\":\"data:image/jpeg;base64,";
+
+    SceUInt64 encode_start = sceKernelGetProcessTimeWide();
+    size_t image_start = body.size();
+    if (!append_rgba_as_base64_jpeg(body, rgba, width, height, quality)) {
+        return "Error: Could not encode image.";
+    }
+    size_t image_len = body.size() - image_start;
+    body += "\"}}]}]}";
+    SceUInt64 encode_time = sceKernelGetProcessTimeWide() - encode_start;
+
+    SceUInt64 send_start = sceKernelGetProcessTimeWide();
+    std::string result = http_request(SCE_HTTP_METHOD_POST, url, body.c_str(), body.length(), apiKey, on_chunk);
+
+    // Body capacity is the peak buffer for the upload; send time runs until the reply finishes streaming
+    sceClibPrintf("image upload: %dx%d q=%d base64=%u body=%u capacity=%u encode=%llums send+reply=%llums\n",
+                  width, height, quality, (unsigned int)image_len, (unsigned int)body.size(), (unsigned int)body.capacity(),
+                  encode_time / 1000, (sceKernelGetProcessTimeWide() - send_start) / 1000);
+    return result;
 }
 
-std::vector<std::string> fetch_models(const std::string& endpoint, const std::string& apiKey) {
+std::vector<std::string> fetch_models(const std::string& endpoint, const std::string& models_url_override, const std::string& apiKey) {
     std::vector<std::string> models;
     std::string models_url;
 
-
-    Settings settings = load_settings();
-    if (settings.models_endpoint_overrides.count(endpoint) > 0) {
+    if (!models_url_override.empty()) {
         // Use the override URL directly
-        models_url = settings.models_endpoint_overrides[endpoint];
+        models_url = models_url_override;
     } else {
         // No override, use the default logic (pulls models from openai and webui style endpoints)
         
@@ -186,21 +380,44 @@ std::vector<std::string> fetch_models(const std::string& endpoint, const std::st
         }
     }
 
-    std::string response_text = nativeGetRequest(models_url, apiKey);
-
-    Json::Value root;
-    Json::CharReaderBuilder reader_builder;
-    std::unique_ptr<Json::CharReader> const reader(reader_builder.newCharReader());
-    JSONCPP_STRING errs;
-
-    if (reader->parse(response_text.c_str(), response_text.c_str() + response_text.length(), &root, &errs)) {
-        if (root.isObject() && root.isMember("data") && root["data"].isArray()) {
-            for (const auto& model_obj : root["data"]) {
-                if (model_obj.isObject() && model_obj.isMember("id")) {
-                    models.push_back(model_obj["id"].asString());
-                }
-            }
+    // Model lists can be large (OpenRouter sends descriptions and pricing for
+    // hundreds of models), so only the ids are picked out as the body streams in
+    JsonScanner scanner;
+    JsonScanHandler handler;
+    handler.want = [](const JsonScanner& s) {
+        return json_scan_at(s, "data.*.id");
+    };
+    handler.on_value = [&models](const JsonScanner&, JsonScanKind kind, const std::string& value) {
+        if (kind == JsonScanKind::STRING) {
+            models.push_back(value);
         }
+    };
+
+    std::string result = nativeGetRequest(models_url, apiKey, [&](const char* data, int len) {
+        return json_scan_feed(scanner, data, len, handler);
+    });
+    if (!result.empty() || !json_scan_finish(scanner, handler)) {
+        models.clear();
     }
     return models;
-} 
\ No newline at end of file
+}
+
+NetTransport native_transport() {
+    NetTransport transport;
+    transport.post_chat = [](const NetRequest& request, const HttpChunkCallback& on_chunk) -> std::string {
+        http_serve(request.id);
+        if (request.image_rgba.empty()) {
+            return nativePostRequest(request.endpoint, request.body, request.api_key, on_chunk);
+        }
+
+        // JPEG is several times smaller than PNG for camera frames, which matters on Vita Wi-Fi
+        return nativePostRequestWithImage(request.endpoint, request.prompt, request.image_rgba.data(), request.image_width, request.image_height,
+                                          request.image_quality, request.model, request.api_key, on_chunk);
+    };
+    transport.fetch_models = [](const NetRequest& request) {
+        http_serve(request.id);
+        return fetch_models(request.endpoint, request.models_url, request.api_key);
+    };
+    transport.abort = http_abort;
+    return transport;
+}
@@ -4,15 +4,48 @@
 #include <string>
 #include <vector>
 #include "types.h"
+#include "stream.h"
+#include "net_worker.h"
 
 bool initialize_network(const std::string& endpoint);
 
-std::string nativePostRequest(const std::string& endpoint, const std::string& jsonPayload, const std::string& apiKey);
+// Counters for the keep-alive connection pool. Send times on fresh
+// connections include the TCP + TLS handshake, so comparing the two
+// averages shows what reuse saves.
+struct HttpPoolStats {
+    unsigned int hits = 0;
+    unsigned int misses = 0;
+    unsigned int evictions = 0;
+    unsigned int stale_retries = 0;
+    unsigned int handshakes = 0;
+    unsigned long long handshake_send_us = 0;
+    unsigned long long reused_send_us = 0;
+};
 
-std::string nativeGetRequest(const std::string& url, const std::string& apiKey);
+HttpPoolStats http_pool_stats();
 
-std::string nativePostRequestWithImage(const std::string& endpoint, const std::string& prompt, const std::string& base64Image, const std::string& model, const std::string& apiKey);
+// Closes all pooled connections; call before sceHttpTerm
+void http_pool_clear();
 
-std::vector<std::string> fetch_models(const std::string& endpoint, const std::string& apiKey);
+// With on_chunk set the body is handed to the callback as it arrives and the
+// returned string is empty on success (or an "Error: ..." message).
+std::string nativePostRequest(const std::string& endpoint, const std::string& jsonPayload, const std::string& apiKey, const HttpChunkCallback& on_chunk = HttpChunkCallback());
+
+// Sends a body assembled from fragments (see payload.h)
+std::string nativePostRequest(const std::string& endpoint, const RequestBody& body, const std::string& apiKey, const HttpChunkCallback& on_chunk = HttpChunkCallback());
+
+std::string nativeGetRequest(const std::string& url, const std::string& apiKey, const HttpChunkCallback& on_chunk = HttpChunkCallback());
+
+// Sends a single-turn chat with a photo. The RGBA pixels are JPEG-encoded at
+// the given quality and base64'd directly into the request body.
+std::string nativePostRequestWithImage(const std::string& endpoint, const std::string& prompt, const void* rgba, int width, int height, int quality,
+                                       const std::string& model, const std::string& apiKey, const HttpChunkCallback& on_chunk = HttpChunkCallback());
+
+// Lists the models served next to a chat completions endpoint. A non-empty
+// models_url_override is used as is instead of deriving the URL.
+std::vector<std::string> fetch_models(const std::string& endpoint, const std::string& models_url_override, const std::string& apiKey);
+
+// Transport for the network worker backed by the functions above
+NetTransport native_transport();
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,222 @@
+#include "net_worker.h"
+#include <pthread.h>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+
+// SSL handshakes need more stack than the pthread default on the Vita
+#define NET_WORKER_STACK_SIZE (256 * 1024)
+
+static NetTransport s_transport;
+static pthread_t s_thread;
+static bool s_running = false;
+
+static std::mutex s_request_mutex;
+static std::condition_variable s_request_cv;
+static std::deque<NetRequest> s_requests;
+static bool s_stop = false;
+static int s_next_id = 1;
+
+static std::atomic<int> s_active_id(0);
+static std::atomic<int> s_cancel_id(0);
+
+// Completion queue. The render thread only holds the lock long enough to swap it out.
+static std::mutex s_event_mutex;
+static std::vector<NetEvent> s_events;
+
+static void push_event(NetEvent event) {
+    std::lock_guard<std::mutex> lock(s_event_mutex);
+
+    // Merge consecutive deltas so a slow frame picks them up in one go
+    if (event.type == NetEventType::CHAT_DELTA && !s_events.empty()) {
+        NetEvent& last = s_events.back();
+        if (last.type == NetEventType::CHAT_DELTA && last.request_id == event.request_id) {
+            last.content += event.content;
+            last.reasoning += event.reasoning;
+            return;
+        }
+    }
+    s_events.push_back(std::move(event));
+}
+
+static void push_cancelled(const NetRequest& request) {
+    if (request.kind != NetRequestKind::CHAT) {
+        return;
+    }
+    NetEvent done;
+    done.request_id = request.id;
+    done.type = NetEventType::CHAT_DONE;
+    done.cancelled = true;
+    push_event(std::move(done));
+}
+
+// Stops the running request: a stream bails out at its next chunk, and the
+// transport abort covers a request still waiting on the server
+static void cancel_active(int request_id) {
+    s_cancel_id = request_id;
+    if (s_transport.abort) {
+        s_transport.abort(request_id);
+    }
+}
+
+static void run_chat(const NetRequest& request) {
+    StreamState stream;
+    size_t sent_content = 0;
+    size_t sent_reasoning = 0;
+
+    auto flush_delta = [&]() {
+        if (stream.content.size() == sent_content && stream.reasoning.size() == sent_reasoning) {
+            return;
+        }
+        NetEvent delta;
+        delta.request_id = request.id;
+        delta.type = NetEventType::CHAT_DELTA;
+        delta.content = stream.content.substr(sent_content);
+        delta.reasoning = stream.reasoning.substr(sent_reasoning);
+        sent_content = stream.content.size();
+        sent_reasoning = stream.reasoning.size();
+        push_event(std::move(delta));
+    };
+
+    HttpChunkCallback on_chunk = [&](const char* data, int len) -> bool {
+        if (s_cancel_id.load() == request.id) {
+            return false;
+        }
+        if (stream_feed(stream, data, len)) {
+            flush_delta();
+        }
+        return true;
+    };
+
+    std::string result = s_transport.post_chat(request, on_chunk);
+
+    NetEvent done;
+    done.request_id = request.id;
+    done.type = NetEventType::CHAT_DONE;
+    if (s_cancel_id.load() == request.id) {
+        done.cancelled = true;
+    } else {
+        stream_finish(stream);
+        flush_delta();
+        done.error = result;
+        done.finish_reason = stream.finish_reason;
+        done.prompt_tokens = stream.prompt_tokens;
+        done.completion_tokens = stream.completion_tokens;
+    }
+    push_event(std::move(done));
+}
+
+static void run_fetch_models(const NetRequest& request) {
+    std::vector<std::string> models = s_transport.fetch_models(request);
+    if (s_cancel_id.load() == request.id) {
+        return;
+    }
+
+    NetEvent event;
+    event.request_id = request.id;
+    event.type = NetEventType::MODELS;
+    event.models = std::move(models);
+    push_event(std::move(event));
+}
+
+static void* worker_main(void*) {
+    while (true) {
+        NetRequest request;
+        {
+            std::unique_lock<std::mutex> lock(s_request_mutex);
+            s_request_cv.wait(lock, [] { return s_stop || !s_requests.empty(); });
+            if (s_stop) {
+                break;
+            }
+            request = std::move(s_requests.front());
+            s_requests.pop_front();
+            s_active_id = request.id;
+        }
+
+        if (request.kind == NetRequestKind::CHAT) {
+            run_chat(request);
+        } else {
+            run_fetch_models(request);
+        }
+
+        s_active_id = 0;
+    }
+    return NULL;
+}
+
+bool net_worker_start(const NetTransport& transport) {
+    if (s_running) {
+        return true;
+    }
+
+    s_transport = transport;
+    s_stop = false;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, NET_WORKER_STACK_SIZE);
+    s_running = (pthread_create(&s_thread, &attr, worker_main, NULL) == 0);
+    pthread_attr_destroy(&attr);
+    return s_running;
+}
+
+void net_worker_stop() {
+    if (!s_running) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(s_request_mutex);
+        s_stop = true;
+        s_requests.clear();
+    }
+    // Interrupt an in-flight request so the join doesn't wait on the server
+    int active_id = s_active_id.load();
+    if (active_id != 0) {
+        cancel_active(active_id);
+    }
+    s_request_cv.notify_all();
+
+    pthread_join(s_thread, NULL);
+    s_running = false;
+
+    std::lock_guard<std::mutex> lock(s_event_mutex);
+    s_events.clear();
+}
+
+int net_worker_submit(NetRequest request) {
+    int id;
+    {
+        std::lock_guard<std::mutex> lock(s_request_mutex);
+        id = s_next_id++;
+        request.id = id;
+        s_requests.push_back(std::move(request));
+    }
+    s_request_cv.notify_one();
+    return id;
+}
+
+void net_worker_cancel(int request_id) {
+    {
+        std::lock_guard<std::mutex> lock(s_request_mutex);
+        for (auto it = s_requests.begin(); it != s_requests.end(); ++it) {
+            if (it->id == request_id) {
+                NetRequest request = std::move(*it);
+                s_requests.erase(it);
+                push_cancelled(request);
+                return;
+            }
+        }
+    }
+
+    if (s_active_id.load() == request_id) {
+        cancel_active(request_id);
+    }
+}
+
+void net_worker_poll(std::vector<NetEvent>& events) {
+    events.clear();
+    std::lock_guard<std::mutex> lock(s_event_mutex);
+    events.swap(s_events);
+}
@@ -0,0 +1,78 @@
+#ifndef NET_WORKER_H
+#define NET_WORKER_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include "stream.h"
+#include "payload.h"
+
+// Background thread that runs HTTP requests off the render thread. Requests
+// are queued with net_worker_submit and their results are collected once per
+// frame with net_worker_poll. Nothing in here touches vita2d or the Vita HTTP
+// library directly; the actual I/O goes through a NetTransport so the worker
+// can be driven on a host build with a stubbed transport.
+
+enum class NetRequestKind {
+    CHAT,
+    FETCH_MODELS
+};
+
+struct NetRequest {
+    int id = 0;
+    NetRequestKind kind = NetRequestKind::CHAT;
+    std::string endpoint;
+    std::string api_key;
+    std::string model;
+    RequestBody body;                      // prebuilt JSON body for text-only chats
+    std::string prompt;                    // image chats
+    std::vector<unsigned char> image_rgba; // image chats, owned copy of the pixels
+    int image_width = 0;
+    int image_height = 0;
+    int image_quality = 80;                // image chats, JPEG quality
+    std::string models_url;                // model lists, an override from the settings or empty to derive it from endpoint
+};
+
+enum class NetEventType {
+    CHAT_DELTA,  // more reply text arrived
+    CHAT_DONE,   // reply finished, failed or was cancelled
+    MODELS       // model list fetched
+};
+
+struct NetEvent {
+    int request_id = 0;
+    NetEventType type = NetEventType::CHAT_DELTA;
+    std::string content;    // CHAT_DELTA: text appended since the previous delta
+    std::string reasoning;  // CHAT_DELTA: reasoning appended since the previous delta
+    std::string error;      // CHAT_DONE: "Error: ..." if the request failed
+    std::string finish_reason; // CHAT_DONE: "stop", "length", ... if the server sent one
+    int prompt_tokens = -1;     // CHAT_DONE: usage, if the server reported it
+    int completion_tokens = -1;
+    bool cancelled = false;
+    std::vector<std::string> models;
+};
+
+struct NetTransport {
+    // Sends a chat request and streams the body through on_chunk.
+    // Returns an empty string on success or an "Error: ..." message.
+    std::function<std::string(const NetRequest& request, const HttpChunkCallback& on_chunk)> post_chat;
+    std::function<std::vector<std::string>(const NetRequest& request)> fetch_models;
+    // Called from another thread to make the call running request_id return
+    // early, even before any data arrived. Optional.
+    std::function<void(int request_id)> abort;
+};
+
+bool net_worker_start(const NetTransport& transport);
+void net_worker_stop();
+
+// Queues a request and returns its id
+int net_worker_submit(NetRequest request);
+
+// Cancels a queued or running request. A CHAT_DONE event with cancelled set
+// is still delivered for chat requests.
+void net_worker_cancel(int request_id);
+
+// Moves all events completed since the last call into events
+void net_worker_poll(std::vector<NetEvent>& events);
+
+#endif
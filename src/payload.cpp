@@ -0,0 +1,91 @@
+#include "payload.h"
+#include <cstdio>
+
+static const PayloadFragment COMMA = std::make_shared<const std::string>(",");
+
+void RequestBody::append(const PayloadFragment& piece) {
+    pieces.push_back(piece);
+    size += piece->size();
+}
+
+void RequestBody::append(const std::string& text) {
+    append(std::make_shared<const std::string>(text));
+}
+
+void RequestBody::gather(std::string& out) const {
+    out.clear();
+    out.reserve(size);
+    for (const auto& piece : pieces) {
+        out.append(*piece);
+    }
+}
+
+void json_append_string(std::string& out, const std::string& s) {
+    out.reserve(out.size() + s.size() + 2);
+    out += '"';
+
+    // Copy runs of characters that need no escaping in one go
+    size_t run_start = 0;
+    for (size_t i = 0; i < s.size(); i++) {
+        unsigned char c = s[i];
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        out.append(s, run_start, i - run_start);
+        run_start = i + 1;
+
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default: {
+                char escaped[7];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out += escaped;
+                break;
+            }
+        }
+    }
+    out.append(s, run_start, std::string::npos);
+
+    out += '"';
+}
+
+// Serialized form of a message, built the first time it is sent
+static const PayloadFragment& message_fragment(ChatMessage& msg) {
+    if (!msg.payload_json) {
+        std::string json = (msg.sender == ChatMessage::USER) ? "{\"role\":\"user\",\"content\":" : "{\"role\":\"assistant\",\"content\":";
+        json_append_string(json, msg.text);
+        json += '}';
+        msg.payload_json = std::make_shared<const std::string>(std::move(json));
+    }
+    return msg.payload_json;
+}
+
+RequestBody build_chat_payload(const std::string& model, std::vector<ChatMessage>& session, bool stream) {
+    RequestBody body;
+    body.pieces.reserve(session.size() * 2 + 2);
+
+    std::string head = "{\"model\":";
+    json_append_string(head, model);
+    if (stream) {
+        head += ",\"stream\":true";
+    }
+    head += ",\"messages\":[";
+    body.append(head);
+
+    for (size_t i = 0; i < session.size(); i++) {
+        if (i > 0) {
+            body.append(COMMA);
+        }
+        body.append(message_fragment(session[i]));
+    }
+
+    body.append("]}");
+    return body;
+}
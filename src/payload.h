@@ -0,0 +1,32 @@
+#ifndef PAYLOAD_H
+#define PAYLOAD_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include "types.h"
+
+// Request bodies are assembled from immutable, shared fragments instead of
+// one big string. Each message caches its own serialized form, so a new turn
+// only escapes the messages added since the last one, and the network worker
+// can hold on to the pieces after the UI has moved on.
+typedef std::shared_ptr<const std::string> PayloadFragment;
+
+struct RequestBody {
+    std::vector<PayloadFragment> pieces;
+    size_t size = 0;
+
+    void append(const PayloadFragment& piece);
+    void append(const std::string& text);
+
+    // Copies the pieces into one contiguous buffer, reusing its capacity
+    void gather(std::string& out) const;
+};
+
+// Appends s to out as a quoted, escaped JSON string
+void json_append_string(std::string& out, const std::string& s);
+
+// Builds a chat completion body for the whole session
+RequestBody build_chat_payload(const std::string& model, std::vector<ChatMessage>& session, bool stream);
+
+#endif
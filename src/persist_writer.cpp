@@ -0,0 +1,214 @@
+#include "persist_writer.h"
+#include <psp2/io/fcntl.h>
+#include <psp2/io/stat.h>
+#include <pthread.h>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <vector>
+#include <utility>
+
+// jsoncpp serializing a long session recurses a little, give it some room
+#define PERSIST_WRITER_STACK_SIZE (128 * 1024)
+
+typedef std::chrono::steady_clock Clock;
+
+static const std::string TMP_SUFFIX = ".tmp";
+
+static pthread_t s_thread;
+static bool s_running = false;
+
+static std::mutex s_mutex;
+static std::condition_variable s_work_cv;
+static std::condition_variable s_idle_cv;
+static std::vector<std::pair<std::string, std::function<bool()>>> s_pending;
+static Clock::time_point s_oldest_pending;
+static bool s_busy = false;
+static bool s_flush = false;
+static bool s_stop = false;
+
+static PersistWriterStats s_stats;
+
+static void run_write(const std::function<bool()>& write) {
+    Clock::time_point start = Clock::now();
+    bool ok = write();
+    unsigned long long us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_stats.writes++;
+    if (!ok) s_stats.failures++;
+    s_stats.last_write_us = us;
+    s_stats.total_write_us += us;
+    if (us > s_stats.max_write_us) s_stats.max_write_us = us;
+}
+
+static void* writer_main(void*) {
+    std::unique_lock<std::mutex> lock(s_mutex);
+    while (true) {
+        s_work_cv.wait(lock, [] { return s_stop || s_flush || !s_pending.empty(); });
+        if (s_pending.empty()) {
+            if (s_stop) {
+                break;
+            }
+            s_flush = false;
+            s_idle_cv.notify_all();
+            continue;
+        }
+
+        // Give more saves a chance to land on top of the ones already queued
+        Clock::time_point due = s_oldest_pending + std::chrono::milliseconds(PERSIST_DEBOUNCE_MS);
+        s_work_cv.wait_until(lock, due, [] { return s_stop || s_flush; });
+
+        std::vector<std::pair<std::string, std::function<bool()>>> batch;
+        batch.swap(s_pending);
+        s_busy = true;
+        lock.unlock();
+
+        for (const auto& job : batch) {
+            run_write(job.second);
+        }
+
+        lock.lock();
+        s_busy = false;
+        if (s_pending.empty()) {
+            s_flush = false;
+            s_idle_cv.notify_all();
+        }
+    }
+    return NULL;
+}
+
+bool persist_writer_start() {
+    if (s_running) {
+        return true;
+    }
+
+    s_stop = false;
+    s_flush = false;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, PERSIST_WRITER_STACK_SIZE);
+    s_running = (pthread_create(&s_thread, &attr, writer_main, NULL) == 0);
+    pthread_attr_destroy(&attr);
+    return s_running;
+}
+
+void persist_writer_stop() {
+    if (!s_running) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_stop = true;
+    }
+    s_work_cv.notify_all();
+
+    pthread_join(s_thread, NULL);
+    s_running = false;
+}
+
+void persist_writer_submit(const std::string& key, std::function<bool()> write) {
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_stats.submitted++;
+        if (s_running) {
+            for (auto& job : s_pending) {
+                if (job.first == key) {
+                    job.second = std::move(write);
+                    s_stats.coalesced++;
+                    return;
+                }
+            }
+            if (s_pending.empty()) {
+                s_oldest_pending = Clock::now();
+            }
+            s_pending.push_back(std::make_pair(key, std::move(write)));
+        }
+    }
+
+    if (s_running) {
+        s_work_cv.notify_one();
+    } else {
+        run_write(write);
+    }
+}
+
+void persist_writer_flush() {
+    if (!s_running) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(s_mutex);
+    s_flush = true;
+    s_work_cv.notify_one();
+    s_idle_cv.wait(lock, [] { return s_pending.empty() && !s_busy; });
+}
+
+PersistWriterStats persist_writer_stats() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_stats;
+}
+
+bool persist_write_file(const std::string& path, const std::string& content) {
+    std::string tmp_path = path + TMP_SUFFIX;
+    SceUID fd = sceIoOpen(tmp_path.c_str(), SCE_O_WRONLY | SCE_O_CREAT | SCE_O_TRUNC, 0777);
+    if (fd < 0) {
+        return false;
+    }
+
+    const char* cursor = content.data();
+    size_t remaining = content.size();
+    while (remaining > 0) {
+        int written = sceIoWrite(fd, cursor, remaining);
+        if (written <= 0) {
+            break;
+        }
+        cursor += written;
+        remaining -= written;
+    }
+    bool ok = (remaining == 0) && sceIoSyncByFd(fd, 0) >= 0;
+    sceIoClose(fd);
+
+    if (ok) {
+        sceIoRemove(path.c_str());
+        ok = sceIoRename(tmp_path.c_str(), path.c_str()) >= 0;
+    }
+    if (!ok) {
+        sceIoRemove(tmp_path.c_str());
+    }
+    return ok;
+}
+
+static bool read_whole_file(const std::string& path, std::string& content) {
+    SceUID fd = sceIoOpen(path.c_str(), SCE_O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+
+    content.clear();
+    SceOff size = sceIoLseek(fd, 0, SCE_SEEK_END);
+    sceIoLseek(fd, 0, SCE_SEEK_SET);
+    if (size > 0) {
+        content.resize((size_t)size);
+        size_t done = 0;
+        while (done < content.size()) {
+            int got = sceIoRead(fd, &content[done], content.size() - done);
+            if (got <= 0) {
+                break;
+            }
+            done += got;
+        }
+        content.resize(done);
+    }
+    sceIoClose(fd);
+    return true;
+}
+
+bool persist_read_file(const std::string& path, std::string& content) {
+    if (read_whole_file(path, content)) {
+        return true;
+    }
+    return read_whole_file(path + TMP_SUFFIX, content);
+}
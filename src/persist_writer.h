@@ -0,0 +1,47 @@
+#ifndef PERSIST_WRITER_H
+#define PERSIST_WRITER_H
+
+#include <string>
+#include <functional>
+
+// Background thread for settings and session writes. Saves are queued under
+// a key; a save still waiting under the same key is replaced rather than
+// written twice, and the queue is only drained once the oldest save has
+// waited PERSIST_DEBOUNCE_MS, so a burst of saves costs one write. The write
+// callbacks run on the writer thread and should do their own serializing
+// from a snapshot they captured.
+
+#define PERSIST_DEBOUNCE_MS 300
+
+struct PersistWriterStats {
+    unsigned int submitted = 0;
+    unsigned int coalesced = 0;   // saves that replaced one still waiting under the same key
+    unsigned int writes = 0;
+    unsigned int failures = 0;
+    unsigned long long last_write_us = 0;
+    unsigned long long max_write_us = 0;
+    unsigned long long total_write_us = 0;
+};
+
+bool persist_writer_start();
+
+// Writes everything still queued, then stops the thread
+void persist_writer_stop();
+
+// Queues write under key. If the writer isn't running it is called right away.
+void persist_writer_submit(const std::string& key, std::function<bool()> write);
+
+// Blocks until everything queued so far has been written
+void persist_writer_flush();
+
+PersistWriterStats persist_writer_stats();
+
+// Replaces path by writing "<path>.tmp", syncing it and renaming it over the
+// old file, so readers see either the old or the new contents in full
+bool persist_write_file(const std::string& path, const std::string& content);
+
+// Reads path. sceIoRename won't overwrite, so the old file is removed just
+// before the rename; if a crash lands in between, the complete .tmp is read.
+bool persist_read_file(const std::string& path, std::string& content);
+
+#endif
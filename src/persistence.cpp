@@ -3,129 +3,622 @@
 #include <psp2/io/fcntl.h>
 #include <psp2/io/dirent.h>
 #include <psp2/io/stat.h>
+#include <psp2/kernel/processmgr.h>
+#include <psp2/kernel/clib.h>
 #include <fstream>
 #include <streambuf>
 #include <iostream>
 #include <sys/stat.h>
 #include <sstream>
-#include "ui.h" 
-#include "image_utils.h" 
+#include <algorithm>
+#include <map>
+#include <set>
+#include <mutex>
+#include <ctime>
+#include "ui.h"
+#include "image_utils.h"
+#include "journal.h"
+#include "persist_writer.h"
+#include "session_file.h"
+
+#define DATA_DIR "ux0:data/vela"
+#define SESSIONS_DIR DATA_DIR "/sessions"
+#define SESSION_INDEX_PATH SESSIONS_DIR "/index.json"
+#define LEGACY_SESSIONS_PATH DATA_DIR "/sessions.json"
+#define JOURNAL_PATH SESSIONS_DIR "/journal.bin"
+#define SESSION_INDEX_VERSION 2
+
+// Once the journal grows past this, it is folded back into the session files
+#define JOURNAL_COMPACT_BYTES (256 * 1024)
+
+// Ids listed in the index as last written or loaded, so it is only rewritten when they change
+static std::vector<int> s_indexed_ids;
+static int s_next_session_id = 1;
+
+// Sessions that have records in the journal, and so need a fresh snapshot when it is compacted
+static std::set<int> s_journaled_ids;
+// Rough size of the journal, from the size of the messages sent to it
+static size_t s_journal_bytes = 0;
+// Set when the index on disk is missing summaries and should be rewritten
+static bool s_index_stale = false;
 
 static void ensure_directory_exists(const char* path) {
     sceIoMkdir(path, 0755);
 }
 
-bool save_sessions(const std::vector<ChatSession>& sessions) {
-    std::string dir_path = "ux0:data/vela";
-    ensure_directory_exists(dir_path.c_str());
-    
-    std::string images_dir = dir_path + "/images";
-    ensure_directory_exists(images_dir.c_str());
-    
-    Json::Value root(Json::arrayValue);
-    
-    for (size_t session_idx = 0; session_idx < sessions.size(); session_idx++) {
-        const auto& session = sessions[session_idx];
-        Json::Value sessionJson(Json::arrayValue);
-        
-        for (size_t msg_idx = 0; msg_idx < session.size(); msg_idx++) {
-            const auto& message = session[msg_idx];
-            Json::Value messageJson;
-            messageJson["sender"] = message.sender == ChatMessage::USER ? "user" : "llm";
-            messageJson["text"] = message.text;
-            
-            if (message.sender == ChatMessage::LLM) {
-                messageJson["reasoning"] = message.reasoning;
-                messageJson["show_reasoning"] = message.show_reasoning;
+static std::string session_path(int id) {
+    std::stringstream ss;
+    ss << SESSIONS_DIR "/" << id << ".bin";
+    return ss.str();
+}
+
+// Where the previous build kept the snapshot, converted on first load
+static std::string json_session_path(int id) {
+    std::stringstream ss;
+    ss << SESSIONS_DIR "/" << id << ".json";
+    return ss.str();
+}
+
+static bool parse_json(const std::string& content, Json::Value& root) {
+    Json::CharReaderBuilder reader_builder;
+    std::unique_ptr<Json::CharReader> const reader(reader_builder.newCharReader());
+    JSONCPP_STRING errs;
+    return reader->parse(content.c_str(), content.c_str() + content.length(), &root, &errs);
+}
+
+static Json::Value message_to_json(const ChatMessage& message) {
+    Json::Value messageJson;
+    messageJson["sender"] = message.sender == ChatMessage::USER ? "user" : "llm";
+    messageJson["text"] = message.text;
+
+    if (message.sender == ChatMessage::LLM) {
+        messageJson["reasoning"] = message.reasoning;
+        messageJson["show_reasoning"] = message.show_reasoning;
+    }
+
+    if (!message.image_path.empty()) {
+        messageJson["image_path"] = message.image_path;
+    }
+    return messageJson;
+}
+
+static ChatMessage message_from_json(const Json::Value& messageJson) {
+    ChatMessage message;
+    message.dirty = false;
+
+    if (messageJson.isMember("sender")) {
+        std::string sender = messageJson["sender"].asString();
+        message.sender = (sender == "user") ? ChatMessage::USER : ChatMessage::LLM;
+    }
+
+    if (messageJson.isMember("text")) {
+        message.text = messageJson["text"].asString();
+    }
+
+    if (message.sender == ChatMessage::LLM) {
+        if (messageJson.isMember("reasoning")) {
+            message.reasoning = messageJson["reasoning"].asString();
+        }
+
+        if (messageJson.isMember("show_reasoning")) {
+            message.show_reasoning = messageJson["show_reasoning"].asBool();
+        }
+    }
+
+    if (messageJson.isMember("image_path")) {
+        // Only the header is read here; pixels are decoded when the message is drawn
+        message.image_path = messageJson["image_path"].asString();
+        read_image_size(message.image_path, message.image_width, message.image_height);
+    }
+    return message;
+}
+
+static std::vector<ChatMessage> messages_from_json(const Json::Value& sessionJson) {
+    std::vector<ChatMessage> messages;
+    if (!sessionJson.isArray()) {
+        return messages;
+    }
+
+    for (const auto& messageJson : sessionJson) {
+        messages.push_back(message_from_json(messageJson));
+    }
+    return messages;
+}
+
+bool session_json_to_binary(const std::string& json, std::string& binary) {
+    Json::Value sessionJson;
+    if (!parse_json(json, sessionJson) || !sessionJson.isArray()) {
+        return false;
+    }
+    session_file_write(messages_from_json(sessionJson), binary);
+    return true;
+}
+
+bool session_binary_to_json(const std::string& binary, std::string& json) {
+    SessionFile file;
+    if (!session_file_open(binary, file)) {
+        return false;
+    }
+
+    Json::Value sessionJson(Json::arrayValue);
+    for (uint32_t i = 0; i < file.message_count; i++) {
+        ChatMessage message;
+        if (!session_file_read_message(file, i, message)) {
+            return false;
+        }
+        sessionJson.append(message_to_json(message));
+    }
+
+    Json::StreamWriterBuilder writer_builder;
+    json = Json::writeString(writer_builder, sessionJson);
+    return true;
+}
+
+// Writes the whole session as its snapshot file
+static bool write_session_file(const ChatSession& session) {
+    std::string content;
+    session_file_write(session.messages, content);
+    return persist_write_file(session_path(session.id), content);
+}
+
+// Decodes a snapshot with one bulk read. A JSON snapshot from the previous
+// build is converted in place.
+static void read_session_file(ChatSession& session) {
+    std::string content;
+    SessionFile file;
+    if (persist_read_file(session_path(session.id), content) && session_file_open(std::move(content), file)) {
+        session.messages.resize(file.message_count);
+        for (uint32_t i = 0; i < file.message_count; i++) {
+            ChatMessage& message = session.messages[i];
+            message.dirty = false;
+            if (!session_file_read_message(file, i, message)) {
+                session.messages.resize(i);
+                break;
             }
-            
             if (!message.image_path.empty()) {
-                messageJson["image_path"] = message.image_path;
+                // Only the header is read here; pixels are decoded when the message is drawn
+                read_image_size(message.image_path, message.image_width, message.image_height);
             }
-            
-            sessionJson.append(messageJson);
         }
-        
-        root.append(sessionJson);
+        return;
+    }
+
+    Json::Value sessionJson;
+    if (persist_read_file(json_session_path(session.id), content) && parse_json(content, sessionJson)) {
+        session.messages = messages_from_json(sessionJson);
+        if (write_session_file(session)) {
+            sceIoRemove(json_session_path(session.id).c_str());
+        }
+    }
+}
+
+// Keep this much of the first message for the session list, which cuts it at 60
+#define PREVIEW_LENGTH 64
+
+struct IndexEntry {
+    int id;
+    SessionSummary summary;
+};
+
+// Recomputes everything but the modified time from the messages
+static void refresh_summary(ChatSession& session) {
+    SessionSummary& summary = session.summary;
+    summary.preview = session.messages.empty() ? "" : session.messages[0].text.substr(0, PREVIEW_LENGTH);
+    summary.message_count = (int)session.messages.size();
+    summary.bytes = 0;
+    for (const auto& message : session.messages) {
+        summary.bytes += message.text.size() + message.reasoning.size();
+    }
+}
+
+static std::vector<IndexEntry> index_entries(const std::vector<ChatSession>& sessions) {
+    std::vector<IndexEntry> entries;
+    entries.reserve(sessions.size());
+    for (const auto& session : sessions) {
+        IndexEntry entry = { session.id, session.summary };
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+static bool write_index(const std::vector<IndexEntry>& entries, int next_id) {
+    Json::Value root;
+    root["version"] = SESSION_INDEX_VERSION;
+    root["next_id"] = next_id;
+    Json::Value list(Json::arrayValue);
+    for (const auto& entry : entries) {
+        Json::Value item;
+        item["id"] = entry.id;
+        item["preview"] = entry.summary.preview;
+        item["count"] = entry.summary.message_count;
+        item["modified"] = (Json::Int64)entry.summary.modified;
+        item["bytes"] = (Json::UInt64)entry.summary.bytes;
+        list.append(item);
+    }
+    root["sessions"] = list;
+
+    Json::StreamWriterBuilder writer_builder;
+    return persist_write_file(SESSION_INDEX_PATH, Json::writeString(writer_builder, root));
+}
+
+static bool append_journal(const std::string& records) {
+    SceUID fd = sceIoOpen(JOURNAL_PATH, SCE_O_WRONLY | SCE_O_CREAT | SCE_O_APPEND, 0777);
+    if (fd < 0) {
+        return false;
+    }
+    int written = sceIoWrite(fd, records.data(), records.size());
+    // The records have to reach the card before the save counts as done
+    bool ok = written == (int)records.size() && sceIoSyncByFd(fd, 0) >= 0;
+    sceIoClose(fd);
+    return ok;
+}
+
+// Just the fields that are written to disk, so snapshots don't drag wrapped lines or textures along
+static ChatMessage stored_copy(const ChatMessage& message) {
+    ChatMessage copy;
+    copy.sender = message.sender;
+    copy.text = message.text;
+    copy.reasoning = message.reasoning;
+    copy.show_reasoning = message.show_reasoning;
+    copy.image_path = message.image_path;
+    return copy;
+}
+
+static ChatSession stored_copy(const ChatSession& session) {
+    ChatSession copy;
+    copy.id = session.id;
+    copy.messages.reserve(session.messages.size());
+    for (const auto& message : session.messages) {
+        copy.messages.push_back(stored_copy(message));
     }
-    
+    return copy;
+}
+
+struct JournalEntry {
+    int session_id;
+    size_t index;
+    long long modified;
+    ChatMessage message;
+};
+
+// Everything save_sessions has handed over that the writer thread hasn't written yet
+struct PendingSessionWrites {
+    bool write_index = false;
+    std::vector<IndexEntry> index;
+    int next_id = 1;
+    std::vector<int> removed_ids;
+    std::vector<JournalEntry> entries;       // appended to the journal first
+    std::vector<ChatSession> snapshots;      // compaction: these cover every entry above
+    std::vector<JournalEntry> late_entries;  // queued after the snapshots were taken
+};
+
+static std::mutex s_pending_mutex;
+static PendingSessionWrites s_pending;
+static std::vector<int> s_failed_snapshot_ids;  // writer -> UI: still only in the journal
+
+static std::string journal_payload(const JournalEntry& entry) {
+    Json::Value record;
+    record["session"] = entry.session_id;
+    record["index"] = (Json::UInt)entry.index;
+    record["modified"] = (Json::Int64)entry.modified;
+    record["message"] = message_to_json(entry.message);
+
     Json::StreamWriterBuilder writer_builder;
-    std::string content = Json::writeString(writer_builder, root);
-    
-    std::string sessions_path = "ux0:data/vela/sessions.json";
-    std::ofstream file(sessions_path);
-    if (!file.is_open()) {
+    writer_builder["indentation"] = "";
+    return Json::writeString(writer_builder, record);
+}
+
+static bool append_entries(const std::vector<JournalEntry>& entries) {
+    if (entries.empty()) {
+        return true;
+    }
+    std::string records;
+    for (const auto& entry : entries) {
+        journal_append_record(records, journal_payload(entry));
+    }
+    return append_journal(records);
+}
+
+// Folds the journal into the given snapshots, then drops it. Returns the ids
+// whose snapshot couldn't be written, in which case the journal is kept.
+static std::vector<int> compact_journal(const std::vector<ChatSession>& snapshots) {
+    std::vector<int> failed;
+    for (const auto& session : snapshots) {
+        if (!write_session_file(session)) {
+            failed.push_back(session.id);
+        }
+    }
+    if (failed.empty()) {
+        sceIoRemove(JOURNAL_PATH);
+    }
+    return failed;
+}
+
+// Runs on the persistence writer thread
+static bool write_pending_sessions() {
+    PendingSessionWrites pending;
+    {
+        std::lock_guard<std::mutex> lock(s_pending_mutex);
+        std::swap(pending, s_pending);
+    }
+
+    ensure_directory_exists(DATA_DIR);
+    ensure_directory_exists(SESSIONS_DIR);
+
+    // The index goes first so records for a new session have somewhere to land
+    // on replay, and records for a deleted one are skipped
+    bool ok = true;
+    if (pending.write_index) {
+        if (write_index(pending.index, pending.next_id)) {
+            for (int id : pending.removed_ids) {
+                sceIoRemove(session_path(id).c_str());
+            }
+        } else {
+            // Retry with the next save unless a newer index is already waiting
+            std::lock_guard<std::mutex> lock(s_pending_mutex);
+            if (!s_pending.write_index) {
+                s_pending.write_index = true;
+                s_pending.index = pending.index;
+                s_pending.next_id = pending.next_id;
+            }
+            s_pending.removed_ids.insert(s_pending.removed_ids.end(), pending.removed_ids.begin(), pending.removed_ids.end());
+            ok = false;
+        }
+    }
+
+    ok = append_entries(pending.entries) && ok;
+    if (!pending.snapshots.empty()) {
+        std::vector<int> failed = compact_journal(pending.snapshots);
+        if (!failed.empty()) {
+            std::lock_guard<std::mutex> lock(s_pending_mutex);
+            s_failed_snapshot_ids.insert(s_failed_snapshot_ids.end(), failed.begin(), failed.end());
+            ok = false;
+        }
+    }
+    return append_entries(pending.late_entries) && ok;
+}
+
+ChatSession new_chat_session() {
+    ChatSession session;
+    session.id = s_next_session_id++;
+    return session;
+}
+
+// Hands the changes to the persistence writer; nothing is serialized or written here
+bool save_sessions(std::vector<ChatSession>& sessions) {
+    std::vector<int> ids;
+    ids.reserve(sessions.size());
+    for (auto& session : sessions) {
+        if (session.id <= 0) {
+            session.id = s_next_session_id++;
+        }
+        ids.push_back(session.id);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(s_pending_mutex);
+        PendingSessionWrites& pending = s_pending;
+
+        s_journaled_ids.insert(s_failed_snapshot_ids.begin(), s_failed_snapshot_ids.end());
+        s_failed_snapshot_ids.clear();
+
+        // New and changed messages go to the journal instead of rewriting their sessions
+        std::vector<JournalEntry>& entries = pending.snapshots.empty() ? pending.entries : pending.late_entries;
+        for (auto& session : sessions) {
+            if (!session.dirty || !session.loaded) {
+                continue;
+            }
+            session.summary.modified = (long long)time(NULL);
+            refresh_summary(session);
+            for (size_t i = 0; i < session.messages.size(); i++) {
+                ChatMessage& message = session.messages[i];
+                if (message.dirty) {
+                    JournalEntry entry = { session.id, i, session.summary.modified, stored_copy(message) };
+                    entries.push_back(entry);
+                    s_journal_bytes += message.text.size() + message.reasoning.size() + message.image_path.size() + 64;
+                    message.dirty = false;
+                }
+            }
+            session.dirty = false;
+            s_journaled_ids.insert(session.id);
+        }
+
+        bool compacting = s_journal_bytes > JOURNAL_COMPACT_BYTES;
+        if (compacting) {
+            // The new snapshots cover everything queued so far, including entries
+            // that arrived after an earlier compaction that hasn't run yet
+            pending.entries.insert(pending.entries.end(), pending.late_entries.begin(), pending.late_entries.end());
+            pending.late_entries.clear();
+            pending.snapshots.clear();
+            for (const auto& session : sessions) {
+                if (session.loaded && s_journaled_ids.count(session.id)) {
+                    pending.snapshots.push_back(stored_copy(session));
+                }
+            }
+            s_journaled_ids.clear();
+            s_journal_bytes = 0;
+        }
+
+        // Summaries in the index only need to be current for sessions that aren't
+        // in the journal, since those are loaded in full at startup anyway
+        if (ids != s_indexed_ids || compacting || s_index_stale) {
+            for (int old_id : s_indexed_ids) {
+                if (std::find(ids.begin(), ids.end(), old_id) == ids.end()) {
+                    pending.removed_ids.push_back(old_id);
+                }
+            }
+            pending.write_index = true;
+            pending.index = index_entries(sessions);
+            pending.next_id = s_next_session_id;
+            s_indexed_ids = ids;
+            s_index_stale = false;
+        }
+    }
+
+    persist_writer_submit("sessions", write_pending_sessions);
+    return true;
+}
+
+// Splits the single-file history of older builds into per-session files.
+// sessions.json is kept as sessions.json.bak rather than deleted.
+static void migrate_legacy_sessions(std::vector<ChatSession>& sessions) {
+    std::string content;
+    if (!persist_read_file(LEGACY_SESSIONS_PATH, content)) {
+        return;
+    }
+
+    Json::Value root;
+    if (parse_json(content, root) && root.isArray()) {
+        for (const auto& sessionJson : root) {
+            ChatSession session = new_chat_session();
+            session.messages = messages_from_json(sessionJson);
+            session.summary.modified = (long long)time(NULL);
+            refresh_summary(session);
+            session.dirty = false;
+            sessions.push_back(session);
+        }
+    }
+
+    bool ok = true;
+    std::vector<int> ids;
+    ensure_directory_exists(SESSIONS_DIR);
+    for (const auto& session : sessions) {
+        ok = write_session_file(session) && ok;
+        ids.push_back(session.id);
+    }
+
+    // If this fails the old file is still there and the migration runs again next launch
+    if (ok && write_index(index_entries(sessions), s_next_session_id)) {
+        s_indexed_ids = ids;
+        sceIoRemove(LEGACY_SESSIONS_PATH ".bak");
+        sceIoRename(LEGACY_SESSIONS_PATH, LEGACY_SESSIONS_PATH ".bak");
+    }
+}
+
+bool load_session_messages(ChatSession& session) {
+    if (session.loaded) {
         return false;
     }
-    
-    file << content;
-    file.close();
+    read_session_file(session);
+    session.loaded = true;
+    refresh_summary(session);
     return true;
 }
 
+// Applies journal records on top of the snapshots, loading each session the
+// journal touches. A torn record at the end (power lost mid-append) is
+// dropped by compacting straight away.
+static void replay_journal(std::vector<ChatSession>& sessions) {
+    std::string data;
+    if (!persist_read_file(JOURNAL_PATH, data)) {
+        return;
+    }
+
+    std::vector<std::string> records;
+    size_t valid = journal_read_records(data.data(), data.size(), records);
+    s_journal_bytes = valid;
+
+    std::map<int, size_t> positions;
+    for (size_t i = 0; i < sessions.size(); i++) {
+        positions[sessions[i].id] = i;
+    }
+
+    for (const auto& payload : records) {
+        Json::Value record;
+        if (!parse_json(payload, record) || !record.isObject()) {
+            continue;
+        }
+        auto it = positions.find(record["session"].asInt());
+        if (it == positions.end()) {
+            continue;  // session was deleted after this was written
+        }
+
+        // Records are whole messages keyed by position, so replaying one twice is harmless
+        ChatSession& session = sessions[it->second];
+        load_session_messages(session);
+        size_t index = record["index"].asUInt();
+        if (index < session.messages.size()) {
+            session.messages[index] = message_from_json(record["message"]);
+        } else if (index == session.messages.size()) {
+            session.messages.push_back(message_from_json(record["message"]));
+        } else {
+            continue;
+        }
+        session.summary.modified = std::max(session.summary.modified, (long long)record["modified"].asInt64());
+        s_journaled_ids.insert(session.id);
+    }
+
+    for (auto& session : sessions) {
+        if (s_journaled_ids.count(session.id)) {
+            refresh_summary(session);
+        }
+    }
+
+    if (valid < data.size()) {
+        sceClibPrintf("load_sessions: dropped %u torn bytes at the end of the journal\n", (unsigned int)(data.size() - valid));
+        std::vector<ChatSession> snapshots;
+        for (const auto& session : sessions) {
+            if (s_journaled_ids.count(session.id)) {
+                snapshots.push_back(session);
+            }
+        }
+        if (compact_journal(snapshots).empty() && write_index(index_entries(sessions), s_next_session_id)) {
+            s_journaled_ids.clear();
+            s_journal_bytes = 0;
+        }
+    }
+}
+
 std::vector<ChatSession> load_sessions() {
+    SceUInt64 start = sceKernelGetProcessTimeWide();
     std::vector<ChatSession> sessions;
-    std::string sessions_path = "ux0:data/vela/sessions.json";
-    
-    std::ifstream file(sessions_path);
-    if (!file.is_open()) {
-        sessions.push_back(ChatSession());
-        return sessions;
-    }
-    
-    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    file.close();
-    
-    Json::Value root;
-    Json::CharReaderBuilder reader_builder;
-    std::unique_ptr<Json::CharReader> const reader(reader_builder.newCharReader());
-    JSONCPP_STRING errs;
-    
-    if (reader->parse(content.c_str(), content.c_str() + content.length(), &root, &errs)) {
-        if (root.isArray()) {
-            for (const auto& sessionJson : root) {
-                ChatSession session;
-                
-                if (sessionJson.isArray()) {
-                    for (const auto& messageJson : sessionJson) {
-                        ChatMessage message;
-                        
-                        if (messageJson.isMember("sender")) {
-                            std::string sender = messageJson["sender"].asString();
-                            message.sender = (sender == "user") ? ChatMessage::USER : ChatMessage::LLM;
-                        }
-                        
-                        if (messageJson.isMember("text")) {
-                            message.text = messageJson["text"].asString();
-                        }
-                        
-                        if (message.sender == ChatMessage::LLM) {
-                            if (messageJson.isMember("reasoning")) {
-                                message.reasoning = messageJson["reasoning"].asString();
-                            }
-                            
-                            if (messageJson.isMember("show_reasoning")) {
-                                message.show_reasoning = messageJson["show_reasoning"].asBool();
-                            }
-                        }
-                        
-                        if (messageJson.isMember("image_path")) {
-                            message.image_path = messageJson["image_path"].asString();
-                            message.image = load_texture_from_file(message.image_path);
-                        }
-                        session.push_back(message);
-                    }
-                }
-                
-                sessions.push_back(session);
+    std::string content;
+    Json::Value index;
+
+    s_indexed_ids.clear();
+    s_journaled_ids.clear();
+    s_journal_bytes = 0;
+    s_index_stale = false;
+
+    if (persist_read_file(SESSION_INDEX_PATH, content) && parse_json(content, index) && index.isObject()) {
+        s_next_session_id = std::max(1, index["next_id"].asInt());
+
+        for (const auto& item : index["sessions"]) {
+            ChatSession session;
+            session.dirty = false;
+            if (item.isObject()) {
+                session.id = item["id"].asInt();
+                session.loaded = false;
+                session.summary.preview = item["preview"].asString();
+                session.summary.message_count = item["count"].asInt();
+                session.summary.modified = item["modified"].asInt64();
+                session.summary.bytes = (size_t)item["bytes"].asUInt64();
+            } else {
+                // Version 1 index: ids only, so there is nothing to show without loading
+                session.id = item.asInt();
+                session.loaded = false;
+                load_session_messages(session);
+                s_index_stale = true;
             }
+            s_next_session_id = std::max(s_next_session_id, session.id + 1);
+            s_indexed_ids.push_back(session.id);
+            sessions.push_back(session);
         }
+        replay_journal(sessions);
+    } else {
+        migrate_legacy_sessions(sessions);
     }
-    
+
     // If no sessions were loaded, add a default empty session
     if (sessions.empty()) {
-        sessions.push_back(ChatSession());
+        sessions.push_back(new_chat_session());
     }
-    
+
+    int loaded = 0;
+    for (const auto& session : sessions) {
+        if (session.loaded) loaded++;
+    }
+    sceClibPrintf("load_sessions: %d sessions indexed, %d loaded, in %llu us\n",
+                  (int)sessions.size(), loaded, sceKernelGetProcessTimeWide() - start);
     return sessions;
-} 
\ No newline at end of file
+}
@@ -3,8 +3,38 @@
 
 #include "types.h"
 #include <vector>
+#include <string>
 
-bool save_sessions(const std::vector<ChatSession>& sessions);
+// Each session has a binary snapshot file, ux0:data/vela/sessions/<id>.bin
+// (see session_file.h), and sessions/index.json lists the ids in display
+// order along with a summary of each (preview, message count, last
+// modified, size) so the list is available without loading any session.
+// save_sessions appends messages whose dirty flag is set to
+// sessions/journal.bin as checksummed records (see journal.h), and folds the
+// journal back into the snapshots once it grows past a threshold. The index
+// is only rewritten when sessions were added, removed or reordered, or when
+// the journal is compacted.
+
+// Returns an empty session with a fresh id
+ChatSession new_chat_session();
+
+// Copies what changed since the last call and queues it on the persistence
+// writer (persist_writer.h); the files are written in the background.
+bool save_sessions(std::vector<ChatSession>& sessions);
+
+// Loads the session index. Sessions come back with only their summary
+// unless the journal has records for them, which are loaded and replayed.
+// A sessions.json from older builds is split into per-session files the
+// first time this runs.
 std::vector<ChatSession> load_sessions();
 
-#endif  
\ No newline at end of file
+// Reads the messages of a session that was only indexed. Returns false if it
+// was already loaded.
+bool load_session_messages(ChatSession& session);
+
+// Converters between the JSON layout of a session (a message array, as in
+// sessions/<id>.json from earlier builds) and the binary snapshot format
+bool session_json_to_binary(const std::string& json, std::string& binary);
+bool session_binary_to_json(const std::string& binary, std::string& json);
+
+#endif
@@ -0,0 +1,163 @@
+#include "session_file.h"
+#include <zlib.h>
+#include <cstring>
+
+#define HEADER_SIZE 20
+// deflate can't do better than about 1032:1, so a compressed body that
+// claims more than this over its stored size has a damaged header
+#define MAX_INFLATE_RATIO 1032
+
+static void put_u16(std::string& out, uint16_t value) {
+    out += (char)(value & 0xFF);
+    out += (char)(value >> 8);
+}
+
+static void put_u32(std::string& out, uint32_t value) {
+    out += (char)(value & 0xFF);
+    out += (char)((value >> 8) & 0xFF);
+    out += (char)((value >> 16) & 0xFF);
+    out += (char)((value >> 24) & 0xFF);
+}
+
+static void set_u32(std::string& out, size_t pos, uint32_t value) {
+    out[pos] = (char)(value & 0xFF);
+    out[pos + 1] = (char)((value >> 8) & 0xFF);
+    out[pos + 2] = (char)((value >> 16) & 0xFF);
+    out[pos + 3] = (char)((value >> 24) & 0xFF);
+}
+
+static uint16_t get_u16(const char* p) {
+    const unsigned char* b = (const unsigned char*)p;
+    return b[0] | (b[1] << 8);
+}
+
+static uint32_t get_u32(const char* p) {
+    const unsigned char* b = (const unsigned char*)p;
+    return b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+static void put_string(std::string& out, const std::string& s) {
+    put_u32(out, (uint32_t)s.size());
+    out += s;
+}
+
+// Reads a length-prefixed string at *pos, staying inside [0, end)
+static bool get_string(const char* data, size_t end, size_t* pos, std::string& s) {
+    if (end - *pos < 4) {
+        return false;
+    }
+    uint32_t len = get_u32(data + *pos);
+    *pos += 4;
+    if (end - *pos < len) {
+        return false;
+    }
+    s.assign(data + *pos, len);
+    *pos += len;
+    return true;
+}
+
+bool session_file_open(std::string data, SessionFile& file) {
+    file = SessionFile();
+    if (data.size() < HEADER_SIZE || memcmp(data.data(), "VSES", 4) != 0) {
+        return false;
+    }
+
+    const char* header = data.data();
+    uint16_t version = get_u16(header + 4);
+    uint16_t flags = get_u16(header + 6);
+    uint32_t count = get_u32(header + 8);
+    uint32_t body_size = get_u32(header + 12);
+    uint32_t stored_size = get_u32(header + 16);
+    if (version > SESSION_FILE_VERSION || stored_size != data.size() - HEADER_SIZE ||
+        body_size > SESSION_FILE_MAX_BODY || count > body_size / 4) {
+        return false;
+    }
+
+    if (flags & SESSION_FILE_COMPRESSED) {
+        // Checked before the size from the header is allocated
+        if ((uint64_t)body_size > (uint64_t)stored_size * MAX_INFLATE_RATIO) {
+            return false;
+        }
+        std::string inflated(body_size, '\0');
+        uLongf inflated_size = body_size;
+        if (uncompress((Bytef*)&inflated[0], &inflated_size, (const Bytef*)header + HEADER_SIZE, stored_size) != Z_OK ||
+            inflated_size != body_size) {
+            return false;
+        }
+        file.storage.swap(inflated);
+        file.body = file.storage.data();
+    } else {
+        if (stored_size != body_size) {
+            return false;
+        }
+        file.storage.swap(data);
+        file.body = file.storage.data() + HEADER_SIZE;
+    }
+    file.body_size = body_size;
+    file.message_count = count;
+    return true;
+}
+
+bool session_file_read_message(const SessionFile& file, uint32_t index, ChatMessage& message) {
+    if (index >= file.message_count) {
+        return false;
+    }
+
+    size_t table_size = (size_t)file.message_count * 4;
+    size_t pos = table_size + get_u32(file.body + index * 4);
+    if (pos > file.body_size || file.body_size - pos < 2) {
+        return false;
+    }
+
+    message.sender = file.body[pos] ? ChatMessage::LLM : ChatMessage::USER;
+    message.show_reasoning = file.body[pos + 1] != 0;
+    pos += 2;
+    return get_string(file.body, file.body_size, &pos, message.text) &&
+           get_string(file.body, file.body_size, &pos, message.reasoning) &&
+           get_string(file.body, file.body_size, &pos, message.image_path);
+}
+
+void session_file_write(const std::vector<ChatMessage>& messages, std::string& out) {
+    size_t table_size = messages.size() * 4;
+    size_t body_size = table_size;
+    for (const auto& message : messages) {
+        body_size += 2 + 12 + message.text.size() + message.reasoning.size() + message.image_path.size();
+    }
+
+    std::string body;
+    body.reserve(body_size);
+    body.resize(table_size);
+    for (size_t i = 0; i < messages.size(); i++) {
+        const ChatMessage& message = messages[i];
+        set_u32(body, i * 4, (uint32_t)(body.size() - table_size));
+        body += (char)(message.sender == ChatMessage::LLM ? 1 : 0);
+        body += (char)(message.show_reasoning ? 1 : 0);
+        put_string(body, message.text);
+        put_string(body, message.reasoning);
+        put_string(body, message.image_path);
+    }
+
+    uint16_t flags = 0;
+    std::string compressed;
+    if (body.size() >= SESSION_FILE_COMPRESS_MIN) {
+        uLongf compressed_size = compressBound(body.size());
+        compressed.resize(compressed_size);
+        // Fast level: this runs on every compaction, and chat text squeezes well even so
+        if (compress2((Bytef*)&compressed[0], &compressed_size, (const Bytef*)body.data(), body.size(), Z_BEST_SPEED) == Z_OK &&
+            compressed_size < body.size()) {
+            compressed.resize(compressed_size);
+            flags |= SESSION_FILE_COMPRESSED;
+        }
+    }
+    const std::string& stored = (flags & SESSION_FILE_COMPRESSED) ? compressed : body;
+
+    out.clear();
+    out.reserve(HEADER_SIZE + stored.size());
+    out.append("VSES", 4);
+    put_u16(out, SESSION_FILE_VERSION);
+    put_u16(out, flags);
+    put_u32(out, (uint32_t)messages.size());
+    put_u32(out, (uint32_t)body.size());
+    put_u32(out, (uint32_t)stored.size());
+    out += stored;
+}
@@ -0,0 +1,47 @@
+#ifndef SESSION_FILE_H
+#define SESSION_FILE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "types.h"
+
+// Binary snapshot format for one session. All integers are little-endian.
+//
+//   header  "VSES", u16 version, u16 flags, u32 message count,
+//           u32 body size, u32 stored body size
+//   body    u32 offset of each message (from the end of the table), then the
+//           messages: u8 sender, u8 show_reasoning, and text, reasoning and
+//           image_path as u32 length + bytes
+//
+// With SESSION_FILE_COMPRESSED set the body is a zlib stream. The offset
+// table lets a single message be decoded without touching the others.
+
+#define SESSION_FILE_VERSION 1
+#define SESSION_FILE_COMPRESSED 0x1
+
+// Bodies smaller than this aren't worth inflating on every load
+#define SESSION_FILE_COMPRESS_MIN (16 * 1024)
+
+// Largest body a file may claim. A session this size would not fit in
+// memory next to everything else anyway.
+#define SESSION_FILE_MAX_BODY (64 * 1024 * 1024)
+
+struct SessionFile {
+    std::string storage;            // the file as read, or the inflated body
+    const char* body = nullptr;     // start of the offset table
+    size_t body_size = 0;
+    uint32_t message_count = 0;
+};
+
+// Checks the header and inflates the body if needed. data is taken over by
+// the SessionFile, so an uncompressed file is decoded in place.
+bool session_file_open(std::string data, SessionFile& file);
+
+// Decodes one message's stored fields. Returns false if the entry is damaged.
+bool session_file_read_message(const SessionFile& file, uint32_t index, ChatMessage& message);
+
+// Encodes messages, compressing the body when it is large enough to pay off
+void session_file_write(const std::vector<ChatMessage>& messages, std::string& out);
+
+#endif
@@ -1,5 +1,6 @@
 #include "sessions.h"
 #include "ui.h" 
+#include "text_metrics.h"
 
 #define MONO_WHITE RGBA8(255, 255, 255, 255)
 #define MONO_LIGHT_GRAY RGBA8(160, 160, 160, 255)
@@ -15,7 +16,7 @@ void draw_feathered_highlight(float x, float y, float w, float h) {
     }
     float main_width = w - (feather_width * 2);
 
-    vita2d_draw_rectangle(x + feather_width, y, main_width, h, highlight_color);
+    draw_list_rect(x + feather_width, y, main_width, h, highlight_color);
 
     int feather_steps = 15;
     for (int i = 0; i < feather_steps; i++) {
@@ -24,8 +25,8 @@ void draw_feathered_highlight(float x, float y, float w, float h) {
         unsigned int alpha = (unsigned int)(base_alpha * opacity);
         unsigned int color = RGBA8(160, 160, 160, alpha);
 
-        vita2d_draw_rectangle(x + feather_width + main_width + (i * step_width), y, step_width, h, color);
-        vita2d_draw_rectangle(x + feather_width - ((i + 1) * step_width), y, step_width, h, color);
+        draw_list_rect(x + feather_width + main_width + (i * step_width), y, step_width, h, color);
+        draw_list_rect(x + feather_width - ((i + 1) * step_width), y, step_width, h, color);
     }
 }
 
@@ -33,11 +34,11 @@ void draw_sessions_ui(vita2d_pgf* pgf, const std::vector<ChatSession>& sessions,
     vita2d_start_drawing();
     vita2d_clear_screen();
 
-    vita2d_pgf_draw_text(pgf, 20, 30, MONO_WHITE, 1.2f, "Chat Sessions");
+    draw_list_text(20, 30, MONO_WHITE, 1.2f, "Chat Sessions");
 
     // --- Draw "New Chat" Button ---
     const char* new_chat_text = "New Chat";
-    float new_chat_text_width = vita2d_pgf_text_width(pgf, 1.0f, new_chat_text);
+    float new_chat_text_width = text_metrics_width(new_chat_text);
     float new_chat_x = (SCREEN_WIDTH - new_chat_text_width) / 2;
     float new_chat_y = 80;
 
@@ -46,7 +47,7 @@ void draw_sessions_ui(vita2d_pgf* pgf, const std::vector<ChatSession>& sessions,
         float highlight_x = (SCREEN_WIDTH - highlight_w) / 2;
         draw_feathered_highlight(highlight_x, new_chat_y - 22, highlight_w, 35);
     }
-    vita2d_pgf_draw_text(pgf, new_chat_x, new_chat_y, MONO_WHITE, 1.0f, new_chat_text);
+    draw_list_text(new_chat_x, new_chat_y, MONO_WHITE, 1.0f, new_chat_text);
 
 
     // --- Draw Session List ---
@@ -57,8 +58,9 @@ void draw_sessions_ui(vita2d_pgf* pgf, const std::vector<ChatSession>& sessions,
         const auto& session = sessions[i];
         
         std::string preview_text = "Session " + std::to_string(i + 1);
-        if (!session.empty() && !session[0].text.empty()) {
-             preview_text = session[0].text;
+        // Drawn from the summary so sessions that haven't been opened don't need loading
+        if (!session.summary.preview.empty()) {
+             preview_text = session.summary.preview;
         } else {
              preview_text = "New session...";
         }
@@ -67,7 +69,7 @@ void draw_sessions_ui(vita2d_pgf* pgf, const std::vector<ChatSession>& sessions,
             preview_text = preview_text.substr(0, 57) + "...";
         }
         
-        float text_width = vita2d_pgf_text_width(pgf, 1.0f, preview_text.c_str());
+        float text_width = text_metrics_width(preview_text.c_str());
         float text_x = 60; 
         
         if (i == selected_session_index) {
@@ -77,7 +79,7 @@ void draw_sessions_ui(vita2d_pgf* pgf, const std::vector<ChatSession>& sessions,
         }
 
         if (current_y > 50 && current_y < 500) {
-            vita2d_pgf_draw_text(pgf, text_x, current_y, MONO_WHITE, 1.0f, preview_text.c_str());
+            draw_list_text(text_x, current_y, MONO_WHITE, 1.0f, preview_text);
         }
         
         current_y += 50;
@@ -85,12 +87,12 @@ void draw_sessions_ui(vita2d_pgf* pgf, const std::vector<ChatSession>& sessions,
     
     // Instructions at the bottom
     if (!show_delete_confirmation) {
-        vita2d_pgf_draw_text(pgf, 20, 520, MONO_WHITE, 1.0f, "X Select, O Return, □ Delete");
+        draw_list_text(20, 520, MONO_WHITE, 1.0f, "X Select, O Return, □ Delete");
     }
 
     // Draw delete confirmation dialog if active
     if (show_delete_confirmation && selected_session_index >= 0 && selected_session_index < sessions.size()) {
-        vita2d_draw_rectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, RGBA8(0, 0, 0, 200));
+        draw_list_rect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, RGBA8(0, 0, 0, 200));
         
         // Dialog box
         float dialog_w = 400;
@@ -103,19 +105,19 @@ void draw_sessions_ui(vita2d_pgf* pgf, const std::vector<ChatSession>& sessions,
         
         // Dialog title
         const char* dialog_title = "Delete Session?";
-        float title_width = vita2d_pgf_text_width(pgf, 1.2f, dialog_title);
-        vita2d_pgf_draw_text(pgf, dialog_x + (dialog_w - title_width) / 2, dialog_y + 50, MONO_WHITE, 1.2f, dialog_title);
+        float title_width = text_metrics_width(dialog_title, 1.2f);
+        draw_list_text(dialog_x + (dialog_w - title_width) / 2, dialog_y + 50, MONO_WHITE, 1.2f, dialog_title);
         
         // Dialog message
         const char* dialog_msg = "This action cannot be undone.";
-        float msg_width = vita2d_pgf_text_width(pgf, 1.0f, dialog_msg);
-        vita2d_pgf_draw_text(pgf, dialog_x + (dialog_w - msg_width) / 2, dialog_y + 90, MONO_WHITE, 1.0f, dialog_msg);
+        float msg_width = text_metrics_width(dialog_msg);
+        draw_list_text(dialog_x + (dialog_w - msg_width) / 2, dialog_y + 90, MONO_WHITE, 1.0f, dialog_msg);
         
         // Yes/No buttons
         const char* yes_text = "Yes";
         const char* no_text = "No";
-        float yes_width = vita2d_pgf_text_width(pgf, 1.0f, yes_text);
-        float no_width = vita2d_pgf_text_width(pgf, 1.0f, no_text);
+        float yes_width = text_metrics_width(yes_text);
+        float no_width = text_metrics_width(no_text);
         
         float button_spacing = 80;
         float yes_x = dialog_x + (dialog_w / 2) - button_spacing - (yes_width / 2);
@@ -131,9 +133,10 @@ void draw_sessions_ui(vita2d_pgf* pgf, const std::vector<ChatSession>& sessions,
         }
         
         // Draw button text
-        vita2d_pgf_draw_text(pgf, yes_x, button_y, MONO_WHITE, 1.0f, yes_text);
-        vita2d_pgf_draw_text(pgf, no_x, button_y, MONO_WHITE, 1.0f, no_text);
+        draw_list_text(yes_x, button_y, MONO_WHITE, 1.0f, yes_text);
+        draw_list_text(no_x, button_y, MONO_WHITE, 1.0f, no_text);
     }
 
+    draw_list_submit();
     vita2d_end_drawing();
 } 
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "settings.h"
 #include "config.h" 
+#include "persist_writer.h"
 #include <jsoncpp/json/json.h>
 #include <psp2/io/fcntl.h>
 #include <psp2/io/dirent.h>
@@ -7,6 +8,7 @@
 #include <fstream>
 #include <streambuf>
 #include <sys/stat.h>
+#include <algorithm>
 
 
 void ensure_directory_exists(const char* path) {
@@ -17,17 +19,14 @@ Settings load_settings() {
     Settings settings;
     std::string settings_path = "ux0:data/vela/settings.json";
 
-    std::ifstream file(settings_path);
-    if (!file.is_open()) {
+    std::string content;
+    if (!persist_read_file(settings_path, content)) {
 
         settings.endpoint = API_ENDPOINT;
         settings.apiKey = ""; 
         return settings;
     }
 
-    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    file.close();
-
     Json::Value root;
     Json::CharReaderBuilder reader_builder;
     std::unique_ptr<Json::CharReader> const reader(reader_builder.newCharReader());
@@ -36,6 +35,11 @@ Settings load_settings() {
     if (reader->parse(content.c_str(), content.c_str() + content.length(), &root, &errs)) {
         settings.endpoint = root.get("endpoint", API_ENDPOINT).asString();
         settings.apiKey = root.get("apiKey", "").asString();
+        settings.image_quality = std::max(1, std::min(100, root.get("image_quality", settings.image_quality).asInt()));
+        settings.image_cache_mb = std::max(1, root.get("image_cache_mb", settings.image_cache_mb).asInt());
+        settings.image_max_edge = std::max(0, root.get("image_max_edge", settings.image_max_edge).asInt());
+        // Below 10 a button pressed while idle would wait over 100 ms to be seen
+        settings.idle_fps = std::max(10, std::min(60, root.get("idle_fps", settings.idle_fps).asInt()));
         
         if (root.isMember("default_models") && root["default_models"].isObject()) {
             Json::Value default_models_json = root["default_models"];
@@ -50,6 +54,13 @@ Settings load_settings() {
                 settings.models_endpoint_overrides[key] = overrides_json[key].asString();
             }
         }
+
+        if (root.isMember("image_max_edge_overrides") && root["image_max_edge_overrides"].isObject()) {
+            Json::Value sizes_json = root["image_max_edge_overrides"];
+            for (auto const& key : sizes_json.getMemberNames()) {
+                settings.image_max_edge_overrides[key] = std::max(0, sizes_json[key].asInt());
+            }
+        }
     } else {
         // JSON is invalid, return defaults
         settings.endpoint = API_ENDPOINT;
@@ -59,13 +70,17 @@ Settings load_settings() {
     return settings;
 }
 
-void save_settings(const Settings& settings) {
+static bool write_settings(const Settings& settings) {
     std::string dir_path = "ux0:data/vela";
     ensure_directory_exists(dir_path.c_str());
     
     Json::Value root;
     root["endpoint"] = settings.endpoint;
     root["apiKey"] = settings.apiKey;
+    root["image_quality"] = settings.image_quality;
+    root["image_cache_mb"] = settings.image_cache_mb;
+    root["image_max_edge"] = settings.image_max_edge;
+    root["idle_fps"] = settings.idle_fps;
 
     Json::Value default_models_json(Json::objectValue);
     for (const auto& pair : settings.default_models) {
@@ -79,13 +94,28 @@ void save_settings(const Settings& settings) {
     }
     root["models_endpoint_overrides"] = overrides_json;
 
+    Json::Value sizes_json(Json::objectValue);
+    for (const auto& pair : settings.image_max_edge_overrides) {
+        sizes_json[pair.first] = pair.second;
+    }
+    root["image_max_edge_overrides"] = sizes_json;
+
     Json::StreamWriterBuilder writer_builder;
     std::string content = Json::writeString(writer_builder, root);
 
     std::string settings_path = "ux0:data/vela/settings.json";
-    std::ofstream file(settings_path);
-    if (file.is_open()) {
-        file << content;
-        file.close();
+    return persist_write_file(settings_path, content);
+}
+
+void save_settings(const Settings& settings) {
+    // Serialized and written on the persistence writer from this copy
+    persist_writer_submit("settings", [settings]() { return write_settings(settings); });
+}
+
+int image_max_edge_for(const Settings& settings, const std::string& model) {
+    auto it = settings.image_max_edge_overrides.find(model);
+    if (it == settings.image_max_edge_overrides.end()) {
+        it = settings.image_max_edge_overrides.find(settings.endpoint);
     }
-} 
\ No newline at end of file
+    return (it != settings.image_max_edge_overrides.end()) ? it->second : settings.image_max_edge;
+}
@@ -5,4 +5,8 @@
 struct Settings;
 
 Settings load_settings();
-void save_settings(const Settings& settings); 
\ No newline at end of file
+void save_settings(const Settings& settings);
+
+// Upload size for photos sent to model on the current endpoint. A model entry
+// in image_max_edge_overrides wins over an endpoint entry.
+int image_max_edge_for(const Settings& settings, const std::string& model); 
\ No newline at end of file
@@ -0,0 +1,234 @@
+#include "stream.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+
+static const std::string THINK_OPEN = "<think>";
+static const std::string THINK_CLOSE = "</think>";
+
+// Length of the longest suffix of text[from..] that is a proper prefix of tag
+static size_t partial_tag_suffix(const std::string& text, size_t from, const std::string& tag) {
+    size_t max_len = std::min(tag.size() - 1, text.size() - from);
+    for (size_t n = max_len; n > 0; --n) {
+        if (text.compare(text.size() - n, n, tag, 0, n) == 0) {
+            return n;
+        }
+    }
+    return 0;
+}
+
+// Routes a content delta into content or reasoning depending on <think> tags
+static void append_content_delta(StreamState& state, const std::string& delta) {
+    std::string text = state.tag_carry + delta;
+    state.tag_carry.clear();
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        const std::string& tag = state.in_think ? THINK_CLOSE : THINK_OPEN;
+        std::string& target = state.in_think ? state.reasoning : state.content;
+
+        size_t found = text.find(tag, pos);
+        if (found != std::string::npos) {
+            target.append(text, pos, found - pos);
+            pos = found + tag.size();
+            state.in_think = !state.in_think;
+            continue;
+        }
+
+        // Hold back a trailing partial tag until the next delta completes it
+        size_t keep = partial_tag_suffix(text, pos, tag);
+        target.append(text, pos, text.size() - pos - keep);
+        state.tag_carry = text.substr(text.size() - keep);
+        break;
+    }
+}
+
+// Keep at most this much of the body around for showing unrecognized responses
+#define RAW_BODY_LIMIT (64 * 1024)
+
+// Where a scalar at the scanner's current path goes, or NULL if we don't use it
+static std::string* completion_field(const JsonScanner& scanner, CompletionFields& fields) {
+    if (scanner.frames.empty() || scanner.frames[0].is_array) {
+        return NULL;
+    }
+
+    const std::string& root_key = scanner.frames[0].key;
+    if (root_key == "choices") {
+        if (json_scan_at(scanner, "choices.0.delta.content") || json_scan_at(scanner, "choices.0.message.content")) {
+            return &fields.content;
+        }
+        if (json_scan_at(scanner, "choices.0.delta.reasoning_content") || json_scan_at(scanner, "choices.0.message.reasoning_content")) {
+            return &fields.reasoning_content;
+        }
+        if (json_scan_at(scanner, "choices.0.delta.reasoning") || json_scan_at(scanner, "choices.0.message.reasoning")) {
+            return &fields.reasoning;
+        }
+        if (json_scan_at(scanner, "choices.0.finish_reason")) {
+            return &fields.finish_reason;
+        }
+    } else if (root_key == "error") {
+        // Either {"error": "..."} or {"error": {"message": "..."}}
+        if (json_scan_at(scanner, "error") || json_scan_at(scanner, "error.message")) {
+            return &fields.error;
+        }
+    }
+    return NULL;
+}
+
+static JsonScanHandler completion_handler(CompletionFields& fields) {
+    JsonScanHandler handler;
+    handler.want = [&fields](const JsonScanner& scanner) {
+        return completion_field(scanner, fields) != NULL ||
+               json_scan_at(scanner, "usage.prompt_tokens") || json_scan_at(scanner, "usage.completion_tokens");
+    };
+    handler.on_value = [&fields](const JsonScanner& scanner, JsonScanKind kind, const std::string& value) {
+        if (kind == JsonScanKind::NUMBER) {
+            if (json_scan_at(scanner, "usage.prompt_tokens")) {
+                fields.prompt_tokens = atoi(value.c_str());
+            } else if (json_scan_at(scanner, "usage.completion_tokens")) {
+                fields.completion_tokens = atoi(value.c_str());
+            }
+        } else if (kind == JsonScanKind::STRING) {
+            std::string* field = completion_field(scanner, fields);
+            if (field) {
+                *field += value;
+            }
+        }
+    };
+    return handler;
+}
+
+// Applies one completion object's fields. Returns true if content or reasoning changed.
+static bool apply_fields(StreamState& state, const CompletionFields& fields) {
+    size_t content_len = state.content.size();
+    size_t reasoning_len = state.reasoning.size();
+
+    if (!fields.error.empty()) {
+        state.content += "Error: " + fields.error;
+    }
+
+    // Some servers send both spellings of the reasoning field, so only take one
+    state.reasoning += fields.reasoning_content.empty() ? fields.reasoning : fields.reasoning_content;
+    if (!fields.content.empty()) {
+        append_content_delta(state, fields.content);
+    }
+
+    if (!fields.finish_reason.empty()) state.finish_reason = fields.finish_reason;
+    if (fields.prompt_tokens >= 0) state.prompt_tokens = fields.prompt_tokens;
+    if (fields.completion_tokens >= 0) state.completion_tokens = fields.completion_tokens;
+
+    return state.content.size() != content_len || state.reasoning.size() != reasoning_len;
+}
+
+// Decodes one SSE event payload. Returns true if content or reasoning changed.
+static bool handle_event(StreamState& state, const char* data, size_t len) {
+    if (len == 6 && memcmp(data, "[DONE]", 6) == 0) {
+        state.done = true;
+        return false;
+    }
+
+    CompletionFields fields;
+    JsonScanHandler handler = completion_handler(fields);
+    json_scan_reset(state.scanner);
+    if (!json_scan_feed(state.scanner, data, len, handler) || !json_scan_finish(state.scanner, handler)) {
+        return false;
+    }
+    return apply_fields(state, fields);
+}
+
+static bool handle_line(StreamState& state, const std::string& line) {
+    size_t end = line.size();
+    if (end > 0 && line[end - 1] == '\r') {
+        end--;
+    }
+
+    // Only data fields matter to us; comments (": keep-alive") and event/id fields are ignored
+    if (line.compare(0, 5, "data:") != 0) {
+        return false;
+    }
+
+    size_t start = 5;
+    if (start < end && line[start] == ' ') start++;
+
+    if (!state.saw_event) {
+        state.saw_event = true;
+        state.raw_body.clear();
+        state.raw_body.shrink_to_fit();
+    }
+    return handle_event(state, line.data() + start, end > start ? end - start : 0);
+}
+
+static void feed_sse(StreamState& state, const char* data, size_t len, bool& changed) {
+    const char* end = data + len;
+    const char* cursor = data;
+    while (cursor < end) {
+        const char* newline = std::find(cursor, end, '\n');
+        state.line_buffer.append(cursor, newline - cursor);
+        if (newline == end) {
+            break;
+        }
+        changed |= handle_line(state, state.line_buffer);
+        state.line_buffer.clear();
+        cursor = newline + 1;
+    }
+}
+
+bool stream_feed(StreamState& state, const char* data, size_t len) {
+    if (!state.saw_event && state.raw_body.size() < RAW_BODY_LIMIT) {
+        state.raw_body.append(data, std::min(len, RAW_BODY_LIMIT - state.raw_body.size()));
+    }
+
+    // A body that opens with '{' is a plain completion, anything else is treated as SSE
+    if (state.mode == StreamMode::UNKNOWN) {
+        size_t skip = 0;
+        while (skip < len && isspace((unsigned char)data[skip])) skip++;
+        if (skip == len) {
+            return false;
+        }
+        if (data[skip] == '{') {
+            state.mode = StreamMode::JSON;
+            json_scan_reset(state.scanner);
+        } else {
+            state.mode = StreamMode::SSE;
+        }
+    }
+
+    bool changed = false;
+    if (state.mode == StreamMode::JSON) {
+        json_scan_feed(state.scanner, data, len, completion_handler(state.fields));
+    } else {
+        feed_sse(state, data, len, changed);
+    }
+    return changed;
+}
+
+void stream_finish(StreamState& state) {
+    if (state.mode == StreamMode::JSON) {
+        CompletionFields& fields = state.fields;
+        bool complete = json_scan_finish(state.scanner, completion_handler(fields));
+        if (complete && (!fields.content.empty() || !fields.reasoning_content.empty() || !fields.reasoning.empty() || !fields.error.empty())) {
+            // Non-streamed replies are split on <think> tags just like deltas
+            apply_fields(state, fields);
+        } else {
+            state.content = state.raw_body;
+        }
+        state.raw_body.clear();
+        state.fields = CompletionFields();
+    }
+
+    if (!state.line_buffer.empty()) {
+        handle_line(state, state.line_buffer);
+        state.line_buffer.clear();
+    }
+
+    if (!state.tag_carry.empty()) {
+        (state.in_think ? state.reasoning : state.content) += state.tag_carry;
+        state.tag_carry.clear();
+    }
+
+    if (!state.saw_event && state.mode != StreamMode::JSON) {
+        state.content = state.raw_body;
+    }
+    state.raw_body.clear();
+}
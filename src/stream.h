@@ -0,0 +1,60 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <string>
+#include <cstddef>
+#include <functional>
+#include "json_scan.h"
+
+// Receives each chunk of a response body as it is read. Return false to stop reading.
+typedef std::function<bool(const char* data, int len)> HttpChunkCallback;
+
+// Fields picked out of one completion object: an SSE event, or the whole
+// body when the server doesn't stream
+struct CompletionFields {
+    std::string content;
+    std::string reasoning_content;  // llama.cpp/vLLM
+    std::string reasoning;          // OpenRouter
+    std::string error;
+    std::string finish_reason;
+    int prompt_tokens = -1;
+    int completion_tokens = -1;
+};
+
+enum class StreamMode {
+    UNKNOWN,  // nothing but whitespace seen yet
+    SSE,
+    JSON      // plain JSON body, scanned as it arrives
+};
+
+// Incremental state for a `stream: true` chat completion. Bytes from the
+// HTTP body are fed in as they arrive; complete SSE `data:` events are
+// decoded into content/reasoning deltas, with <think> tags split out even
+// when a tag straddles two chunks.
+struct StreamState {
+    StreamMode mode = StreamMode::UNKNOWN;
+    JsonScanner scanner;
+    CompletionFields fields;   // JSON mode: fields collected so far
+    std::string line_buffer;   // partial SSE line carried between chunks
+    std::string raw_body;      // start of the body, shown as-is if it isn't a completion
+    std::string tag_carry;     // possible partial <think>/</think> tag at the end of a delta
+    std::string content;
+    std::string reasoning;
+    std::string finish_reason;
+    int prompt_tokens = -1;
+    int completion_tokens = -1;
+    bool saw_event = false;
+    bool in_think = false;
+    bool done = false;
+};
+
+// Feeds a chunk of the response body. Returns true if content or reasoning changed.
+bool stream_feed(StreamState& state, const char* data, size_t len);
+
+// Flushes anything still buffered once the body has been fully read. If the
+// server ignored `stream: true` and answered with a plain JSON body, its
+// content is applied here. Falls back to the raw body as content if it isn't
+// a recognizable completion.
+void stream_finish(StreamState& state);
+
+#endif
@@ -0,0 +1,202 @@
+#include "text_metrics.h"
+#include <vector>
+#include <unordered_map>
+#include <sstream>
+#include <string.h>
+
+struct AdvanceTable {
+    float scale;
+    int ascii[128];  // -1 until measured
+    std::unordered_map<unsigned int, int> others;
+};
+
+static TextMetricsSource s_source;
+static std::vector<AdvanceTable> s_tables; // one per scale, there are only a few
+static bool s_changed = false;
+
+static size_t decode(const char* text, size_t remaining, unsigned int& codepoint) {
+    unsigned char lead = text[0];
+    size_t length = 1;
+    if (lead >= 0xF8) length = 1;  // never starts a sequence
+    else if (lead >= 0xF0) length = 4;
+    else if (lead >= 0xE0) length = 3;
+    else if (lead >= 0xC0) length = 2;
+
+    codepoint = lead;
+    if (length == 1 || length > remaining) {
+        return 1;
+    }
+
+    unsigned int value = lead & (0x7F >> length);
+    for (size_t k = 1; k < length; k++) {
+        unsigned char next = text[k];
+        if ((next & 0xC0) != 0x80) {
+            return 1;
+        }
+        value = (value << 6) | (next & 0x3F);
+    }
+    codepoint = value;
+    return length;
+}
+
+size_t utf8_decode(const std::string& text, size_t i, unsigned int& codepoint) {
+    return decode(text.data() + i, text.size() - i, codepoint);
+}
+
+static AdvanceTable& table_for(float scale) {
+    for (auto& table : s_tables) {
+        if (table.scale == scale) {
+            return table;
+        }
+    }
+    s_tables.push_back(AdvanceTable());
+    AdvanceTable& table = s_tables.back();
+    table.scale = scale;
+    for (int i = 0; i < 128; i++) {
+        table.ascii[i] = -1;
+    }
+    return table;
+}
+
+static int measure(unsigned int codepoint, float scale) {
+    s_changed = true;
+    return s_source.advance ? s_source.advance(codepoint, scale) : 0;
+}
+
+static int advance_in(AdvanceTable& table, unsigned int codepoint) {
+    if (codepoint < 128) {
+        int& advance = table.ascii[codepoint];
+        if (advance < 0) {
+            advance = measure(codepoint, table.scale);
+        }
+        return advance;
+    }
+
+    auto it = table.others.find(codepoint);
+    if (it != table.others.end()) {
+        return it->second;
+    }
+    int advance = measure(codepoint, table.scale);
+    table.others[codepoint] = advance;
+    return advance;
+}
+
+TextMetricsSource native_text_metrics_source(vita2d_pgf* pgf) {
+    TextMetricsSource source;
+    source.advance = [pgf](unsigned int codepoint, float scale) -> int {
+        char glyph[5] = { 0 };
+        if (codepoint < 0x80) {
+            glyph[0] = codepoint;
+        } else if (codepoint < 0x800) {
+            glyph[0] = 0xC0 | (codepoint >> 6);
+            glyph[1] = 0x80 | (codepoint & 0x3F);
+        } else if (codepoint < 0x10000) {
+            glyph[0] = 0xE0 | (codepoint >> 12);
+            glyph[1] = 0x80 | ((codepoint >> 6) & 0x3F);
+            glyph[2] = 0x80 | (codepoint & 0x3F);
+        } else {
+            glyph[0] = 0xF0 | (codepoint >> 18);
+            glyph[1] = 0x80 | ((codepoint >> 12) & 0x3F);
+            glyph[2] = 0x80 | ((codepoint >> 6) & 0x3F);
+            glyph[3] = 0x80 | (codepoint & 0x3F);
+        }
+        return vita2d_pgf_text_width(pgf, scale, glyph);
+    };
+    return source;
+}
+
+void text_metrics_init(const TextMetricsSource& source) {
+    s_source = source;
+    s_tables.clear();
+    s_changed = false;
+}
+
+void text_metrics_shutdown() {
+    s_source = TextMetricsSource();
+    s_tables.clear();
+}
+
+int text_metrics_advance(unsigned int codepoint, float scale) {
+    return advance_in(table_for(scale), codepoint);
+}
+
+int text_metrics_width(const char* text, float scale) {
+    AdvanceTable& table = table_for(scale);
+    size_t remaining = strlen(text);
+    int max_width = 0;
+    int width = 0;
+
+    while (remaining > 0) {
+        unsigned int codepoint;
+        size_t length = decode(text, remaining, codepoint);
+        text += length;
+        remaining -= length;
+
+        if (codepoint == '\n') {
+            if (width > max_width) max_width = width;
+            width = 0;
+            continue;
+        }
+        width += advance_in(table, codepoint);
+    }
+    return width > max_width ? width : max_width;
+}
+
+int text_metrics_width(const std::string& text, float scale) {
+    return text_metrics_width(text.c_str(), scale);
+}
+
+std::string text_metrics_export() {
+    std::ostringstream out;
+    for (const auto& table : s_tables) {
+        for (int i = 0; i < 128; i++) {
+            if (table.ascii[i] >= 0) {
+                out << table.scale << ' ' << i << ' ' << table.ascii[i] << '\n';
+            }
+        }
+        for (const auto& entry : table.others) {
+            out << table.scale << ' ' << entry.first << ' ' << entry.second << '\n';
+        }
+    }
+    s_changed = false;
+    return out.str();
+}
+
+struct ImportedAdvance {
+    float scale;
+    unsigned int codepoint;
+    int advance;
+};
+
+bool text_metrics_import(const std::string& table) {
+    // Parsed in full first, so a malformed table leaves the current one untouched
+    std::vector<ImportedAdvance> entries;
+    std::istringstream in(table);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        std::istringstream fields(line);
+        ImportedAdvance entry;
+        if (!(fields >> entry.scale >> entry.codepoint >> entry.advance) || entry.advance < 0) {
+            return false;
+        }
+        entries.push_back(entry);
+    }
+
+    for (const auto& entry : entries) {
+        AdvanceTable& advances = table_for(entry.scale);
+        if (entry.codepoint < 128) {
+            advances.ascii[entry.codepoint] = entry.advance;
+        } else {
+            advances.others[entry.codepoint] = entry.advance;
+        }
+    }
+    s_changed = false;
+    return true;
+}
+
+bool text_metrics_changed() {
+    return s_changed;
+}
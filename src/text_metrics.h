@@ -0,0 +1,48 @@
+#ifndef TEXT_METRICS_H
+#define TEXT_METRICS_H
+
+#include <string>
+#include <cstddef>
+#include <functional>
+#include <vita2d.h>
+
+// Cached glyph advances for the default PGF font. Each code point is measured
+// once per scale through a TextMetricsSource and string widths are sums over
+// the table. vita2d advances the pen by the truncated advance of each glyph
+// and doesn't kern PGF text, so the sums match vita2d_pgf_text_width.
+//
+// The table can be exported and loaded back, so the app keeps it across
+// runs and host builds can measure text with advances recorded on a Vita.
+
+struct TextMetricsSource {
+    // Advance of one code point at the given scale, in pixels
+    std::function<int(unsigned int codepoint, float scale)> advance;
+};
+
+// Measures code points with vita2d_pgf_text_width
+TextMetricsSource native_text_metrics_source(vita2d_pgf* pgf);
+
+void text_metrics_init(const TextMetricsSource& source);
+void text_metrics_shutdown();
+
+int text_metrics_advance(unsigned int codepoint, float scale = 1.0f);
+
+// Width of the widest line of text, like vita2d_pgf_text_width
+int text_metrics_width(const char* text, float scale = 1.0f);
+int text_metrics_width(const std::string& text, float scale = 1.0f);
+
+// The table as text, one "<scale> <codepoint> <advance>" line per entry
+std::string text_metrics_export();
+// Adds the entries of an exported table. Returns false, without adding
+// anything, if it was malformed.
+bool text_metrics_import(const std::string& table);
+
+// True if code points were measured since the last export or import
+bool text_metrics_changed();
+
+// Decodes the UTF-8 sequence at text[i] and returns its length. Stray
+// continuation bytes, bytes from 0xF8 up and truncated sequences decode as
+// one byte so they can't swallow what follows.
+size_t utf8_decode(const std::string& text, size_t i, unsigned int& codepoint);
+
+#endif
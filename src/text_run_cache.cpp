@@ -0,0 +1,144 @@
+#include "text_run_cache.h"
+#include "text_metrics.h"
+#include <unordered_map>
+
+#define TEXT_RUN_COLUMNS (TEXT_RUN_ATLAS_WIDTH / TEXT_RUN_SLOT_WIDTH)
+#define TEXT_RUN_SLOTS (TEXT_RUN_COLUMNS * (TEXT_RUN_ATLAS_HEIGHT / TEXT_RUN_SLOT_HEIGHT))
+
+struct TextRunSlot {
+    std::string text;
+    int width = 0;
+    bool occupied = false;
+    unsigned int last_used_frame = 0;
+};
+
+static TextRunBackend s_backend;
+static TextRunCacheStats s_stats;
+static vita2d_texture* s_atlas = NULL;
+static std::vector<TextRunSlot> s_slots;
+static std::unordered_map<std::string, size_t> s_index;
+static std::vector<std::string> s_requested; // asked for this frame but not in the atlas
+static unsigned int s_frame = 1;
+
+static float slot_x(size_t slot) {
+    return (slot % TEXT_RUN_COLUMNS) * TEXT_RUN_SLOT_WIDTH;
+}
+
+static float slot_y(size_t slot) {
+    return (slot / TEXT_RUN_COLUMNS) * TEXT_RUN_SLOT_HEIGHT;
+}
+
+// A free slot, or the least recently used one not needed this frame
+static int find_slot() {
+    int victim = -1;
+    for (size_t i = 0; i < s_slots.size(); i++) {
+        const TextRunSlot& slot = s_slots[i];
+        if (!slot.occupied) {
+            return i;
+        }
+        if (slot.last_used_frame != s_frame && (victim < 0 || slot.last_used_frame < s_slots[victim].last_used_frame)) {
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+bool text_run_cache_init(const TextRunBackend& backend) {
+    s_backend = backend;
+    s_stats = TextRunCacheStats();
+    s_atlas = s_backend.create_atlas ? s_backend.create_atlas(TEXT_RUN_ATLAS_WIDTH, TEXT_RUN_ATLAS_HEIGHT) : NULL;
+    s_slots.assign(s_atlas ? TEXT_RUN_SLOTS : 0, TextRunSlot());
+    s_index.clear();
+    s_requested.clear();
+    return s_atlas != NULL;
+}
+
+void text_run_cache_shutdown() {
+    if (s_atlas && s_backend.free_atlas) {
+        s_backend.free_atlas(s_atlas);
+    }
+    s_atlas = NULL;
+    s_slots.clear();
+    s_index.clear();
+    s_requested.clear();
+}
+
+void text_run_cache_request(const std::string& text) {
+    if (text.empty()) {
+        return;
+    }
+    auto found = s_index.find(text);
+    if (found != s_index.end()) {
+        s_slots[found->second].last_used_frame = s_frame;
+        return;
+    }
+    s_requested.push_back(text);
+}
+
+bool text_run_cache_update() {
+    std::vector<TextRun> runs;
+    for (const auto& text : s_requested) {
+        auto found = s_index.find(text);
+        if (found != s_index.end()) {
+            s_slots[found->second].last_used_frame = s_frame; // asked for twice
+            continue;
+        }
+
+        int width = text_metrics_width(text) + 2; // room for the last glyph to overhang its advance
+        if (width > TEXT_RUN_SLOT_WIDTH) {
+            continue;
+        }
+        int index = find_slot();
+        if (index < 0) {
+            continue; // more lines on screen than slots
+        }
+
+        TextRunSlot& slot = s_slots[index];
+        if (slot.occupied) {
+            s_index.erase(slot.text);
+            s_stats.evictions++;
+        }
+        slot.text = text;
+        slot.width = width;
+        slot.occupied = true;
+        slot.last_used_frame = s_frame;
+        s_index[text] = index;
+        s_stats.misses++;
+
+        TextRun run = { text, slot_x(index), slot_y(index) + TEXT_RUN_BASELINE };
+        runs.push_back(run);
+    }
+    s_requested.clear();
+    s_frame++;
+
+    if (runs.empty()) {
+        return false;
+    }
+    if (s_backend.render) {
+        s_backend.render(s_atlas, runs);
+    }
+    s_stats.renders++;
+    return true;
+}
+
+void text_run_draw(float x, float y, unsigned int color, const std::string& text) {
+    if (text.empty()) {
+        return;
+    }
+    auto found = s_index.find(text);
+    if (found != s_index.end()) {
+        s_stats.hits++;
+        size_t slot = found->second;
+        s_backend.draw_part(s_atlas, x, y - TEXT_RUN_BASELINE, slot_x(slot), slot_y(slot),
+                            s_slots[slot].width, TEXT_RUN_SLOT_HEIGHT, color);
+        return;
+    }
+    s_stats.uncached++;
+    if (s_backend.draw_text) {
+        s_backend.draw_text(x, y, color, text);
+    }
+}
+
+TextRunCacheStats text_run_cache_stats() {
+    return s_stats;
+}
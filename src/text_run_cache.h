@@ -0,0 +1,77 @@
+#ifndef TEXT_RUN_CACHE_H
+#define TEXT_RUN_CACHE_H
+
+#include <string>
+#include <vector>
+#include <functional>
+
+struct vita2d_texture;
+
+// Wrapped chat lines rendered once into a texture atlas and then drawn as a
+// single textured quad each, instead of a quad per glyph every frame. The
+// atlas is split into fixed slots, one line per slot, and slots are reused
+// least-recently-used first.
+//
+// Lines are rendered in white and tinted when drawn, so a line is cached by
+// its text alone. The frame asks for the lines it is about to draw with
+// text_run_cache_request, then text_run_cache_update renders the new ones
+// into their slots, leaving the rest of the atlas as it was; that has to
+// happen before the frame's own scene starts. Lines that didn't get a slot
+// are drawn directly.
+//
+// Rendering and drawing go through a TextRunBackend so the slot policy can
+// be exercised on a host build.
+
+#define TEXT_RUN_ATLAS_WIDTH 960   // vita2d lays out render targets in screen coordinates
+#define TEXT_RUN_ATLAS_HEIGHT 544
+#define TEXT_RUN_SLOT_WIDTH 480
+// Lines are only cached at scale 1.0, where PGF text sits on 20 px lines
+// (MESSAGE_LINE_HEIGHT). A slot leaves 21 px above the baseline for accented
+// capitals and CJK glyphs and 7 below for descenders; the atlas holds 38.
+#define TEXT_RUN_SLOT_HEIGHT 28
+#define TEXT_RUN_BASELINE 21       // baseline offset within a slot
+
+struct TextRun {
+    std::string text;
+    float x;  // left edge of its slot
+    float y;  // baseline within the atlas
+};
+
+struct TextRunBackend {
+    std::function<vita2d_texture*(unsigned int width, unsigned int height)> create_atlas;
+    std::function<void(vita2d_texture* atlas)> free_atlas;
+    // Clears the slot of each run (TEXT_RUN_SLOT_WIDTH by TEXT_RUN_SLOT_HEIGHT,
+    // TEXT_RUN_BASELINE above y) and draws the run into it in white, without
+    // touching the rest of the atlas
+    std::function<void(vita2d_texture* atlas, const std::vector<TextRun>& runs)> render;
+    // Draws part of the atlas tinted with color
+    std::function<void(vita2d_texture* atlas, float x, float y, float tex_x, float tex_y, float w, float h, unsigned int color)> draw_part;
+    // Draws a line that isn't cached, baseline at y
+    std::function<void(float x, float y, unsigned int color, const std::string& text)> draw_text;
+};
+
+struct TextRunCacheStats {
+    unsigned int hits = 0;
+    unsigned int misses = 0;
+    unsigned int renders = 0;     // atlas updates, each rendering the lines added that frame
+    unsigned int evictions = 0;
+    unsigned int uncached = 0;    // lines drawn directly
+};
+
+bool text_run_cache_init(const TextRunBackend& backend);
+void text_run_cache_shutdown();
+
+// Marks text as drawn this frame
+void text_run_cache_request(const std::string& text);
+
+// Gives the lines requested since the last update a slot and renders the
+// ones added into the atlas. Returns true if it rendered, in which case the
+// frame's scene has to wait for the atlas.
+bool text_run_cache_update();
+
+// Draws text with its baseline at (x, y)
+void text_run_draw(float x, float y, unsigned int color, const std::string& text);
+
+TextRunCacheStats text_run_cache_stats();
+
+#endif
@@ -0,0 +1,130 @@
+#include "texture_cache.h"
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+struct CacheEntry {
+    std::string path;
+    vita2d_texture* texture;
+    size_t bytes;
+    unsigned int last_used_frame;
+};
+
+static TextureAllocator s_allocator;
+static TextureCacheStats s_stats;
+static unsigned int s_frame = 0;
+
+// Front is most recently used
+static std::list<CacheEntry> s_lru;
+static std::unordered_map<std::string, std::list<CacheEntry>::iterator> s_index;
+static std::vector<vita2d_texture*> s_pending_free;
+
+static void evict(std::list<CacheEntry>::iterator it) {
+    if (it->texture) {
+        s_pending_free.push_back(it->texture);
+    }
+    s_stats.bytes -= it->bytes;
+    s_stats.evictions++;
+    s_index.erase(it->path);
+    s_lru.erase(it);
+}
+
+// Evicts from the back until the budget is met, skipping anything drawn this frame
+static void enforce_budget() {
+    auto it = s_lru.end();
+    while (s_stats.bytes > s_stats.budget && it != s_lru.begin()) {
+        --it;
+        if (it->last_used_frame == s_frame) {
+            continue;
+        }
+        auto victim = it++;
+        evict(victim);
+    }
+    s_stats.entries = s_lru.size();
+}
+
+static void add_entry(const std::string& path, vita2d_texture* texture, size_t bytes) {
+    CacheEntry entry;
+    entry.path = path;
+    entry.texture = texture;
+    entry.bytes = bytes;
+    entry.last_used_frame = s_frame;
+    s_lru.push_front(entry);
+    s_index[path] = s_lru.begin();
+    s_stats.bytes += bytes;
+    enforce_budget();
+}
+
+void texture_cache_init(const TextureAllocator& allocator, size_t budget_bytes) {
+    s_allocator = allocator;
+    s_stats = TextureCacheStats();
+    s_stats.budget = budget_bytes;
+}
+
+void texture_cache_shutdown() {
+    texture_cache_clear();
+    texture_cache_collect();
+}
+
+vita2d_texture* texture_cache_get(const std::string& path) {
+    auto found = s_index.find(path);
+    if (found != s_index.end()) {
+        s_stats.hits++;
+        s_lru.splice(s_lru.begin(), s_lru, found->second);
+        found->second->last_used_frame = s_frame;
+        return found->second->texture;
+    }
+
+    s_stats.misses++;
+    size_t bytes = 0;
+    vita2d_texture* texture = s_allocator.load ? s_allocator.load(path, bytes) : NULL;
+    if (!texture) {
+        s_stats.load_failures++;
+        bytes = 0;
+    }
+    add_entry(path, texture, bytes);
+    return texture;
+}
+
+void texture_cache_insert(const std::string& path, vita2d_texture* texture, size_t bytes) {
+    auto found = s_index.find(path);
+    if (found != s_index.end()) {
+        evict(found->second);
+        s_stats.evictions--; // a replacement, not a budget eviction
+    }
+    add_entry(path, texture, bytes);
+}
+
+void texture_cache_release(vita2d_texture* texture) {
+    if (texture) {
+        s_pending_free.push_back(texture);
+    }
+}
+
+void texture_cache_clear() {
+    while (!s_lru.empty()) {
+        evict(s_lru.begin());
+    }
+    s_stats.entries = 0;
+}
+
+size_t texture_cache_pending_frees() {
+    return s_pending_free.size();
+}
+
+void texture_cache_collect() {
+    for (vita2d_texture* texture : s_pending_free) {
+        if (s_allocator.free) {
+            s_allocator.free(texture);
+        }
+    }
+    s_pending_free.clear();
+    s_frame++;
+
+    // Entries pinned by the last frame may have left us over budget
+    enforce_budget();
+}
+
+TextureCacheStats texture_cache_stats() {
+    return s_stats;
+}
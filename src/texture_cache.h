@@ -0,0 +1,63 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <string>
+#include <cstddef>
+#include <functional>
+
+struct vita2d_texture;
+
+// LRU cache of decoded message images keyed by file path, kept under a byte
+// budget. Textures are loaded on first use and evicted least-recently-used
+// first. Evicted textures may still be referenced by the frame the GPU is
+// drawing, so they are only freed by texture_cache_collect(), which the
+// frame loop calls once rendering is done.
+//
+// Loading and freeing go through a TextureAllocator so the policy can be
+// exercised on a host build with fake textures.
+
+struct TextureAllocator {
+    // Returns NULL on failure; bytes receives the texture's memory footprint
+    std::function<vita2d_texture*(const std::string& path, size_t& bytes)> load;
+    std::function<void(vita2d_texture* texture)> free;
+};
+
+struct TextureCacheStats {
+    unsigned int hits = 0;
+    unsigned int misses = 0;
+    unsigned int evictions = 0;
+    unsigned int load_failures = 0;
+    size_t bytes = 0;
+    size_t budget = 0;
+    size_t entries = 0;
+};
+
+void texture_cache_init(const TextureAllocator& allocator, size_t budget_bytes);
+
+// Frees everything, including textures waiting for texture_cache_collect()
+void texture_cache_shutdown();
+
+// Returns the texture for path, loading it on a miss. Returns NULL if the
+// image can't be loaded; failures are remembered until the entry is evicted.
+vita2d_texture* texture_cache_get(const std::string& path);
+
+// Hands an already-created texture (e.g. a photo just taken) to the cache
+void texture_cache_insert(const std::string& path, vita2d_texture* texture, size_t bytes);
+
+// Frees a texture the cache doesn't hold, e.g. a photo now drawn from its
+// thumbnail, at the next texture_cache_collect() like an evicted one
+void texture_cache_release(vita2d_texture* texture);
+
+// Evicts every entry, e.g. when switching to another session
+void texture_cache_clear();
+
+// Number of evicted textures waiting to be freed
+size_t texture_cache_pending_frees();
+
+// Frees evicted textures and starts a new frame. Textures used during the
+// current frame are never evicted before the next call.
+void texture_cache_collect();
+
+TextureCacheStats texture_cache_stats();
+
+#endif
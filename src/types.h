@@ -4,6 +4,7 @@
 #include <vector>
 #include <vita2d.h>
 #include <map>
+#include <memory>
 
 #define SCREEN_WIDTH 960
 #define SCREEN_HEIGHT 544
@@ -11,7 +12,8 @@
 enum class AppState {
     CHAT,
     SETTINGS,
-    SESSIONS
+    SESSIONS,
+    IMAGE_VIEWER
 };
 
 struct Settings {
@@ -19,6 +21,11 @@ struct Settings {
     std::string apiKey;
     std::map<std::string, std::string> default_models;
     std::map<std::string, std::string> models_endpoint_overrides; // Maps chat completion endpoints to custom models endpoints
+    int image_quality = 80; // JPEG quality (1-100) for photos sent to the model
+    int image_cache_mb = 16; // Budget for decoded message images
+    int image_max_edge = 0; // Longest edge of uploaded photos in pixels, 0 sends the full frame
+    int idle_fps = 30; // Input polling rate once the screen has been still for a second, 10-60, 60 for no cap
+    std::map<std::string, int> image_max_edge_overrides; // Per-model or per-endpoint image_max_edge
 };
 
 enum class UISelection {
@@ -36,17 +43,66 @@ enum class SettingsSelection {
     MODELS_ENDPOINT_OVERRIDE
 };
 
+struct LayoutRect {
+    float x, y, w, h;
+};
+
+// Measured layout of a message, filled in by wrap_message and layout_message
+// (chat_layout.h). Rects are relative to the top of the message; text blocks
+// start one line height above the baseline of their first line.
+struct MessageLayout {
+    int content_width = 0;                     // width the lines were wrapped to, 0 until wrapped
+    std::vector<float> line_widths;            // one per wrapped_text line
+    std::vector<float> reasoning_line_widths;  // one per wrapped_reasoning line
+    float max_line_width = 0.0f;
+    float max_reasoning_width = 0.0f;
+
+    // What the rects below were computed for
+    bool valid = false;
+    bool show_reasoning = false;
+    int image_width = 0;
+    int image_height = 0;
+
+    int height = 0;
+    LayoutRect bubble = {0, 0, 0, 0};
+    LayoutRect image = {0, 0, 0, 0};
+    LayoutRect reasoning = {0, 0, 0, 0};
+    LayoutRect text = {0, 0, 0, 0};
+};
+
 struct ChatMessage {
     enum Sender { USER, LLM };
     Sender sender;
     std::string text;
     std::vector<std::string> wrapped_text;
     int alpha = 255;
-    vita2d_texture* image = NULL; 
-    std::string image_path;       
+    vita2d_texture* image = NULL;  // only set for a photo that hasn't been saved yet
+    std::string image_path;        // saved photo, decoded on demand through texture_cache.h
+    int image_width = 0;           // known without decoding so layout doesn't need the texture
+    int image_height = 0;
     std::string reasoning;        
     std::vector<std::string> wrapped_reasoning; 
     bool show_reasoning = false; 
+    std::shared_ptr<const std::string> payload_json; // cached request-body form, see payload.h
+    bool dirty = true;             // changed since it was last journaled, see persistence.h
+    MessageLayout layout;
+
+    bool has_image() const { return (image != NULL || !image_path.empty()) && image_width > 0 && image_height > 0; }
+};
+
+// What the session index keeps about a session, so the list can be drawn without loading it
+struct SessionSummary {
+    std::string preview;     // start of the first message
+    int message_count = 0;
+    long long modified = 0;  // time() of the last saved change
+    size_t bytes = 0;        // text held by the messages
 };
 
-using ChatSession = std::vector<ChatMessage>; 
\ No newline at end of file
+struct ChatSession {
+    int id = 0;                         // names its file under ux0:data/vela/sessions/, see persistence.h
+    std::vector<ChatMessage> messages;  // empty until loaded
+    SessionSummary summary;
+    bool loaded = true;                 // false while only the index entry has been read
+    bool dirty = true;                  // changed since it was last written
+    size_t layout_dirty_from = 0;       // first message whose layout may be out of date, see chat_layout.h
+}; 
\ No newline at end of file
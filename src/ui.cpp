@@ -2,6 +2,10 @@
 #include <sstream>
 #include <math.h>
 #include <algorithm>
+#include <map>
+#include "texture_cache.h"
+#include "image_utils.h"
+#include "text_metrics.h"
 
 
 #define MONO_BLACK RGBA8(0, 0, 0, 255)           
@@ -18,7 +22,39 @@ vita2d_texture* gear_icon = NULL;
 vita2d_texture* camera_icon = NULL;
 vita2d_texture* history_icon = NULL;
 
-void draw_quarter_circle(float cx, float cy, float radius, int quadrant, unsigned int color) {
+// Circles up to this radius are drawn from a cached sprite, bigger ones a scanline at a time
+#define CIRCLE_SPRITE_MAX_RADIUS 64
+
+// Anti-aliased white discs keyed by radius, tinted when drawn
+static std::map<int, vita2d_texture*> s_circle_sprites;
+
+static vita2d_texture* circle_sprite(int radius) {
+    auto found = s_circle_sprites.find(radius);
+    if (found != s_circle_sprites.end()) {
+        return found->second;
+    }
+
+    int size = radius * 2;
+    vita2d_texture* sprite = vita2d_create_empty_texture(size, size);
+    if (sprite) {
+        unsigned int stride = vita2d_texture_get_stride(sprite) / 4;
+        unsigned int* pixels = (unsigned int*)vita2d_texture_get_datap(sprite);
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                float dx = x + 0.5f - radius;
+                float dy = y + 0.5f - radius;
+                float coverage = radius - sqrtf(dx * dx + dy * dy) + 0.5f;
+                if (coverage < 0.0f) coverage = 0.0f;
+                if (coverage > 1.0f) coverage = 1.0f;
+                pixels[y * stride + x] = ((unsigned int)(coverage * 255.0f + 0.5f) << 24) | 0x00FFFFFF;
+            }
+        }
+    }
+    s_circle_sprites[radius] = sprite; // a failed allocation is remembered too, those fall back to scanlines
+    return sprite;
+}
+
+static void draw_quarter_circle_scanlines(float cx, float cy, float radius, int quadrant, unsigned int color) {
     for (int y = 0; y <= radius; ++y) {
         int x_width = round(sqrt(radius * radius - y * y));
         if (quadrant == 1) { // Top-right
@@ -33,15 +69,53 @@ void draw_quarter_circle(float cx, float cy, float radius, int quadrant, unsigne
     }
 }
 
+// Sprite for radius, or NULL if it has to be drawn with scanlines. A radius
+// between whole pixels uses the next sprite up, scaled down.
+static vita2d_texture* sprite_for(float radius, int& sprite_radius) {
+    sprite_radius = (int)ceilf(radius);
+    if (sprite_radius < 1 || sprite_radius > CIRCLE_SPRITE_MAX_RADIUS) {
+        return NULL;
+    }
+    return circle_sprite(sprite_radius);
+}
 
-void draw_circle(float cx, float cy, float radius, unsigned int color) {
-    draw_quarter_circle(cx, cy, radius, 1, color); // Top-right
-    draw_quarter_circle(cx, cy, radius, 2, color); // Top-left
-    draw_quarter_circle(cx, cy, radius, 3, color); // Bottom-left
-    draw_quarter_circle(cx, cy, radius, 4, color); // Bottom-right
+static void fill_quarter_circle(float cx, float cy, float radius, int quadrant, unsigned int color) {
+    if (radius <= 0) return;
+
+    int sprite_radius;
+    vita2d_texture* sprite = sprite_for(radius, sprite_radius);
+    if (!sprite) {
+        draw_quarter_circle_scanlines(cx, cy, radius, quadrant, color);
+        return;
+    }
+
+    bool right = (quadrant == 1 || quadrant == 4);
+    bool bottom = (quadrant == 3 || quadrant == 4);
+    float scale = radius / sprite_radius;
+    vita2d_draw_texture_tint_part_scale(sprite, right ? cx : cx - radius, bottom ? cy : cy - radius,
+                                        right ? sprite_radius : 0, bottom ? sprite_radius : 0,
+                                        sprite_radius, sprite_radius, scale, scale, color);
 }
 
-void draw_rounded_rect(float x, float y, float w, float h, float radius, unsigned int color) {
+
+static void fill_circle(float cx, float cy, float radius, unsigned int color) {
+    if (radius <= 0) return;
+
+    int sprite_radius;
+    vita2d_texture* sprite = sprite_for(radius, sprite_radius);
+    if (!sprite) {
+        draw_quarter_circle_scanlines(cx, cy, radius, 1, color); // Top-right
+        draw_quarter_circle_scanlines(cx, cy, radius, 2, color); // Top-left
+        draw_quarter_circle_scanlines(cx, cy, radius, 3, color); // Bottom-left
+        draw_quarter_circle_scanlines(cx, cy, radius, 4, color); // Bottom-right
+        return;
+    }
+
+    float scale = radius / sprite_radius;
+    vita2d_draw_texture_tint_scale(sprite, cx - radius, cy - radius, scale, scale, color);
+}
+
+static void fill_rounded_rect(float x, float y, float w, float h, float radius, unsigned int color) {
     if (h <= 0 || w <= 0) return;
 
     float r = radius;
@@ -49,24 +123,128 @@ void draw_rounded_rect(float x, float y, float w, float h, float radius, unsigne
     if (r > h / 2.0f) r = h / 2.0f;
     if (r < 0) r = 0;
 
+    // Nothing but corners, a circle
+    if (w == h && r == w / 2.0f) {
+        fill_circle(x + r, y + r, r, color);
+        return;
+    }
 
     vita2d_draw_rectangle(x + r, y, w - 2 * r, h, color);
-    vita2d_draw_rectangle(x, y + r, r, h - 2 * r, color);
-    vita2d_draw_rectangle(x + w - r, y + r, r, h - 2 * r, color);
+    if (h > 2 * r) { // pills have no straight sides
+        vita2d_draw_rectangle(x, y + r, r, h - 2 * r, color);
+        vita2d_draw_rectangle(x + w - r, y + r, r, h - 2 * r, color);
+    }
 
 
-    draw_quarter_circle(x + r, y + r, r, 2, color); // Top-left
-    draw_quarter_circle(x + w - r, y + r, r, 1, color); // Top-right
-    draw_quarter_circle(x + r, y + h - r, r, 3, color); // Bottom-left
-    draw_quarter_circle(x + w - r, y + h - r, r, 4, color); // Bottom-right
+    fill_quarter_circle(x + r, y + r, r, 2, color); // Top-left
+    fill_quarter_circle(x + w - r, y + r, r, 1, color); // Top-right
+    fill_quarter_circle(x + r, y + h - r, r, 3, color); // Bottom-left
+    fill_quarter_circle(x + w - r, y + h - r, r, 4, color); // Bottom-right
+}
+
+void draw_circle(float cx, float cy, float radius, unsigned int color) {
+    draw_list_rounded_rect(cx - radius, cy - radius, radius * 2, radius * 2, radius, color);
+}
+
+void draw_rounded_rect(float x, float y, float w, float h, float radius, unsigned int color) {
+    draw_list_rounded_rect(x, y, w, h, radius, color);
+}
+
+DrawBackend native_draw_backend(vita2d_pgf* pgf) {
+    DrawBackend backend;
+    backend.draw = [pgf](const DrawCommand& command) {
+        switch (command.type) {
+        case DRAW_RECT:
+            vita2d_draw_rectangle(command.x, command.y, command.w, command.h, command.color);
+            break;
+        case DRAW_ROUNDED_RECT:
+            fill_rounded_rect(command.x, command.y, command.w, command.h, command.radius, command.color);
+            break;
+        case DRAW_TEXTURE:
+            vita2d_draw_texture_tint_part_scale(command.texture, command.x, command.y,
+                                                command.tex_x, command.tex_y, command.tex_w, command.tex_h,
+                                                command.w / command.tex_w, command.h / command.tex_h, command.color);
+            break;
+        case DRAW_TEXT:
+            vita2d_pgf_draw_text(pgf, command.x, command.y, command.color, command.scale, command.text.c_str());
+            break;
+        }
+    };
+    return backend;
+}
+
+// Thumbnail texture for a message's image, or NULL while it's off screen. Saved
+// images are only decoded (through the texture cache) once they scroll into view.
+static vita2d_texture* visible_message_image(const ChatMessage& msg, float y, float h) {
+    if (y + h < 0 || y > SCREEN_HEIGHT) {
+        return NULL;
+    }
+    return msg.image ? msg.image : texture_cache_get(thumbnail_path_for(msg.image_path));
+}
+
+// Calls fn(line, x, baseline, reasoning) for each wrapped line of msg that
+// lands on screen. Long messages only get the lines that are visible.
+template <typename Fn>
+static void for_each_visible_line(const ChatMessage& msg, int current_y, Fn fn) {
+    const MessageLayout& ml = msg.layout;
+    size_t first, last;
+
+    if (ml.reasoning.h > 0) {
+        float text_y = current_y + ml.reasoning.y + MESSAGE_LINE_HEIGHT;
+        visible_line_range(text_y, msg.wrapped_reasoning.size(), 0, SCREEN_HEIGHT + MESSAGE_LINE_HEIGHT, first, last);
+        for (size_t i = first; i < last; i++) {
+            fn(msg.wrapped_reasoning[i], ml.reasoning.x, text_y + i * MESSAGE_LINE_HEIGHT, true);
+        }
+    }
+
+    float text_y = current_y + ml.text.y + MESSAGE_LINE_HEIGHT;
+    visible_line_range(text_y, msg.wrapped_text.size(), 0, SCREEN_HEIGHT + MESSAGE_LINE_HEIGHT, first, last);
+    for (size_t i = first; i < last; i++) {
+        fn(msg.wrapped_text[i], ml.text.x, text_y + i * MESSAGE_LINE_HEIGHT, false);
+    }
+}
+
+TextRunBackend native_text_run_backend(vita2d_pgf* pgf) {
+    TextRunBackend backend;
+    backend.create_atlas = [](unsigned int width, unsigned int height) {
+        return vita2d_create_empty_texture_rendertarget(width, height, SCE_GXM_TEXTURE_FORMAT_A8B8G8R8);
+    };
+    backend.free_atlas = [](vita2d_texture* atlas) {
+        vita2d_wait_rendering_done();
+        vita2d_free_texture(atlas);
+    };
+    backend.render = [pgf](vita2d_texture* atlas, const std::vector<TextRun>& runs) {
+        // Each slot is cleared to transparent white, so glyph edges blend towards
+        // white rather than black. The clip rectangle keeps the clear and any
+        // overhanging glyphs inside the slot; the other slots keep their lines.
+        vita2d_start_drawing_advanced(atlas, SCE_GXM_SCENE_FRAGMENT_SET_DEPENDENCY);
+        vita2d_set_clear_color(RGBA8(255, 255, 255, 0));
+        vita2d_enable_clipping();
+        for (const auto& run : runs) {
+            int top = run.y - TEXT_RUN_BASELINE;
+            vita2d_set_clip_rectangle(run.x, top, run.x + TEXT_RUN_SLOT_WIDTH, top + TEXT_RUN_SLOT_HEIGHT);
+            vita2d_clear_screen();
+            vita2d_pgf_draw_text(pgf, run.x, run.y, MONO_WHITE, 1.0f, run.text.c_str());
+        }
+        vita2d_disable_clipping();
+        vita2d_end_drawing();
+        vita2d_set_clear_color(MONO_BLACK);
+    };
+    backend.draw_part = [](vita2d_texture* atlas, float x, float y, float tex_x, float tex_y, float w, float h, unsigned int color) {
+        draw_list_texture_part(atlas, x, y, tex_x, tex_y, w, h, 1.0f, 1.0f, color);
+    };
+    backend.draw_text = [](float x, float y, unsigned int color, const std::string& text) {
+        draw_list_text(x, y, color, 1.0f, text);
+    };
+    return backend;
 }
 
 void draw_ui(
     vita2d_pgf *pgf,
     const std::vector<ChatMessage>& chat_history,
+    ChatLayout& layout,
     const std::string& user_question,
     int scroll_offset,
-    int& total_history_height,
     UISelection current_selection,
     const std::vector<std::string>& models,
     int selected_model_index,
@@ -96,19 +274,42 @@ void draw_ui(
         history_icon = vita2d_load_PNG_file("app0:img/history.png");
     }
 
-    vita2d_start_drawing();
+    // Only the messages overlapping the screen are drawn. The hover prompts
+    // sit just above a message, hence the slack below the bottom edge.
+    int view_top = scroll_offset - 50;
+
+    // Lines new to the text run atlas are rendered before the frame's scene
+    bool atlas_rendered = false;
+    if (ui_alpha > 0) {
+        for (size_t i = chat_layout_find(layout, view_top); i < chat_history.size(); i++) {
+            int current_y = layout.tops[i] - view_top;
+            if (current_y > SCREEN_HEIGHT + 30) {
+                break;
+            }
+            for_each_visible_line(chat_history[i], current_y, [](const std::string& line, float, float, bool) {
+                text_run_cache_request(line);
+            });
+        }
+        atlas_rendered = text_run_cache_update();
+    }
+
+    if (atlas_rendered) {
+        vita2d_start_drawing_advanced(NULL, SCE_GXM_SCENE_VERTEX_WAIT_FOR_DEPENDENCY);
+    } else {
+        vita2d_start_drawing();
+    }
     vita2d_clear_screen();
 
     if (start_button_hold_duration > 0.0f) {
         float bar_width = (start_button_hold_duration / 2.0f) * SCREEN_WIDTH;
-        vita2d_draw_rectangle(0, 0, bar_width, 5, MONO_WHITE);
+        draw_list_rect(0, 0, bar_width, 5, MONO_WHITE);
     }
 
     if ((ui_alpha == 0 || is_fetching_models) && models.empty()) {
         const char* loading_text = "Loading Models...";
-        float text_width = vita2d_pgf_text_width(pgf, 1.0f, loading_text);
-        vita2d_pgf_draw_text(pgf, (SCREEN_WIDTH - text_width) / 2, SCREEN_HEIGHT / 2, 
-                             RGBA8(255, 255, 255, 255), 1.0f, loading_text);
+        float text_width = text_metrics_width(loading_text);
+        draw_list_text((SCREEN_WIDTH - text_width) / 2, SCREEN_HEIGHT / 2, 
+                       RGBA8(255, 255, 255, 255), 1.0f, loading_text);
     }
 
     auto apply_alpha = [ui_alpha](unsigned int color) -> unsigned int {
@@ -124,144 +325,63 @@ void draw_ui(
     };
 
     if (ui_alpha > 0) {
-        int current_y = 50 - scroll_offset;
-        total_history_height = 0;
-        
-        int msg_index = 0;
-        
-        for (const auto& msg : chat_history) {
-            bool has_image = (msg.image != NULL);
-            float image_h = has_image ? 150.0f : 0.0f; // Height of the image thumbnail
-            float image_w = has_image ? (150.0f * vita2d_texture_get_width(msg.image) / vita2d_texture_get_height(msg.image)) : 0.0f;
-
-            int message_height = 0;
-            if (&msg != &chat_history[0]) {
-                 total_history_height += 10; // Margin
+        size_t msg_index = chat_layout_find(layout, view_top);
+
+        for (; msg_index < chat_history.size(); msg_index++) {
+            const ChatMessage& msg = chat_history[msg_index];
+            const MessageLayout& ml = msg.layout;
+            int current_y = layout.tops[msg_index] - view_top;
+            if (current_y > SCREEN_HEIGHT + 30) {
+                break;
             }
 
             unsigned int message_alpha = (msg.alpha * ui_alpha) / 255;
             
-            bool is_hovered = (msg_index == hovered_message_index);
+            bool is_hovered = ((int)msg_index == hovered_message_index);
             
             if (is_hovered) {
-                float highlight_x = msg.sender == ChatMessage::USER ? SCREEN_WIDTH - 480 : 10;
-                float highlight_w = 480;
-                float highlight_h = 0;
-                
-                if (msg.sender == ChatMessage::USER) {
-                    highlight_h = msg.wrapped_text.size() * 20 + 20 + (has_image ? image_h + 20 : 0) + 10;
-                } else {
-                    highlight_h = msg.wrapped_text.size() * 20 + 20 + (has_image ? image_h + 10 : 0) + 10;
-                    if (msg.show_reasoning && !msg.wrapped_reasoning.empty()) {
-                        highlight_h += msg.wrapped_reasoning.size() * 20 + 30;
-                    }
-                }
-                
-                vita2d_draw_rectangle(SCREEN_WIDTH - 10, current_y, 5, highlight_h, RGBA8(160, 160, 160, message_alpha));
+                draw_list_rect(SCREEN_WIDTH - 10, current_y, 5, ml.height + 10, RGBA8(160, 160, 160, message_alpha));
             }
 
             if (msg.sender == ChatMessage::USER) {
-                float max_text_width = 0.0f;
-                for (const auto& line : msg.wrapped_text) {
-                    float line_width = vita2d_pgf_text_width(pgf, 1.0f, line.c_str());
-                    if (line_width > max_text_width) max_text_width = line_width;
-                }
-                float content_width = std::max(image_w, max_text_width);
-                float bubble_width = content_width + 30;
-                if (bubble_width > 480.0f) bubble_width = 480.0f;
-
-                message_height = msg.wrapped_text.size() * 20 + 20 + (has_image ? image_h + 20 : 0);
-                
-                float bubble_x = SCREEN_WIDTH - bubble_width - 20;
-
-                
-                int text_y = current_y + 25;
-
-                if (has_image) {
-                    vita2d_draw_texture_scale(msg.image, bubble_x + 15, text_y, image_w / vita2d_texture_get_width(msg.image), image_h / vita2d_texture_get_height(msg.image));
-                    text_y += image_h + 20;
-                }
-
-                for (const auto& line : msg.wrapped_text) {
-                    vita2d_pgf_draw_text(pgf, bubble_x + 15, text_y, RGBA8(255, 255, 255, message_alpha), 1.0f, line.c_str());
-                    text_y += 20;
+                if (msg.has_image() && is_hovered) {
+                    const char* view_prompt = "△ View Image";
+                    float view_prompt_w = text_metrics_width(view_prompt);
+                    draw_list_text(SCREEN_WIDTH - 35 - view_prompt_w, current_y - 10, RGBA8(128, 128, 128, message_alpha), 1.0f, view_prompt);
                 }
             } else {
-                message_height = msg.wrapped_text.size() * 20 + 20 + (has_image ? image_h + 10 : 0);
-                
-                if (msg.show_reasoning && !msg.wrapped_reasoning.empty()) {
-                    message_height += msg.wrapped_reasoning.size() * 20 + 30; // Extra space for reasoning
-                }
-                
                 if (!msg.reasoning.empty() && is_hovered) {
                     const char* thinking_prompt = msg.show_reasoning ? "△ Hide Thinking" : "△ Show Thinking";
-                    vita2d_pgf_draw_text(pgf, 35, current_y - 10, RGBA8(128, 128, 128, message_alpha), 1.0f, thinking_prompt);
+                    draw_list_text(35, current_y - 10, RGBA8(128, 128, 128, message_alpha), 1.0f, thinking_prompt);
                 }
                 
-                // Calculate the maximum width needed for the content
-                float max_text_width = 0.0f;
-                
-                // Check width needed for regular text
-                for (const auto& line : msg.wrapped_text) {
-                    float line_width = vita2d_pgf_text_width(pgf, 1.0f, line.c_str());
-                    if (line_width > max_text_width) max_text_width = line_width;
-                }
-                
-                // Check width needed for reasoning text if shown
-                if (msg.show_reasoning && !msg.wrapped_reasoning.empty()) {
-                    for (const auto& line : msg.wrapped_reasoning) {
-                        float line_width = vita2d_pgf_text_width(pgf, 1.0f, line.c_str()) + 10; // Extra indent for reasoning
-                        if (line_width > max_text_width) max_text_width = line_width;
-                    }
-                }
-                
-                // Add padding and ensure minimum width
-                float content_width = std::max(image_w, max_text_width);
-                float bubble_width = content_width + 50; // Add padding (15px left + 35px right)
-                
-                // Cap at maximum width
-                if (bubble_width > 480.0f) bubble_width = 480.0f;
-                // Ensure minimum width
-                if (bubble_width < 100.0f) bubble_width = 100.0f;
-                
                 unsigned int bubble_color = is_hovered ? RGBA8(50, 50, 50, message_alpha) : RGBA8(40, 40, 40, message_alpha);
-                draw_rounded_rect(20, current_y, bubble_width, message_height, 10, bubble_color);
-                int text_y = current_y + 25;
-
-                if (has_image) {
-                    vita2d_draw_texture_scale(msg.image, 30, text_y, image_w / vita2d_texture_get_width(msg.image), image_h / vita2d_texture_get_height(msg.image));
-                    text_y += image_h + 10;
-                }
-                
-                if (msg.show_reasoning && !msg.wrapped_reasoning.empty()) {
-                    for (const auto& line : msg.wrapped_reasoning) {
-                        vita2d_pgf_draw_text(pgf, 45, text_y, RGBA8(180, 180, 180, message_alpha), 1.0f, line.c_str());
-                        text_y += 20;
-                    }
-                    
-                    text_y += 10;
-                }
+                draw_rounded_rect(ml.bubble.x, current_y + ml.bubble.y, ml.bubble.w, ml.bubble.h, 10, bubble_color);
+            }
 
-                for (const auto& line : msg.wrapped_text) {
-                    vita2d_pgf_draw_text(pgf, 35, text_y, RGBA8(255, 255, 255, message_alpha), 1.0f, line.c_str());
-                    text_y += 20;
+            if (msg.has_image()) {
+                vita2d_texture* image = visible_message_image(msg, current_y + ml.image.y, ml.image.h);
+                if (image) {
+                    draw_list_texture(image, ml.image.x, current_y + ml.image.y, ml.image.w / vita2d_texture_get_width(image), ml.image.h / vita2d_texture_get_height(image));
                 }
             }
-            total_history_height += message_height;
-            current_y += message_height + 10;
-            msg_index++;
+
+            for_each_visible_line(msg, current_y, [message_alpha](const std::string& line, float x, float y, bool reasoning) {
+                unsigned int color = reasoning ? RGBA8(180, 180, 180, message_alpha) : RGBA8(255, 255, 255, message_alpha);
+                text_run_draw(x, y, color, line);
+            });
         }
 
         // Clamp scroll offset
-        int max_scroll = total_history_height - (SCREEN_HEIGHT - 170); 
+        int max_scroll = layout.total_height - (SCREEN_HEIGHT - 170);
         if (max_scroll < 0) max_scroll = 0;
         scroll_offset = std::max(0, std::min(scroll_offset, max_scroll));
 
         if (scroll_offset > 0) {
-            vita2d_pgf_draw_text(pgf, SCREEN_WIDTH - 30, 40, RGBA8(255, 255, 255, ui_alpha), 1.0f, "^");
+            draw_list_text(SCREEN_WIDTH - 30, 40, RGBA8(255, 255, 255, ui_alpha), 1.0f, "^");
         }
         if (scroll_offset < max_scroll) {
-            vita2d_pgf_draw_text(pgf, SCREEN_WIDTH - 30, SCREEN_HEIGHT - 100, RGBA8(255, 255, 255, ui_alpha), 1.0f, "v");
+            draw_list_text(SCREEN_WIDTH - 30, SCREEN_HEIGHT - 100, RGBA8(255, 255, 255, ui_alpha), 1.0f, "v");
         }
     }
 
@@ -285,9 +405,9 @@ void draw_ui(
         model_display_text = "No model selected";
     }
     
-    float model_text_width = vita2d_pgf_text_width(pgf, 1.0f, model_display_text.c_str());
-    vita2d_pgf_draw_text(pgf, model_pill_x + (model_pill_w - model_text_width) / 2, model_pill_y + 30, 
-                         RGBA8(255, 255, 255, model_pill_alpha), 1.0f, model_display_text.c_str());
+    float model_text_width = text_metrics_width(model_display_text.c_str());
+    draw_list_text(model_pill_x + (model_pill_w - model_text_width) / 2, model_pill_y + 30, 
+                   RGBA8(255, 255, 255, model_pill_alpha), 1.0f, model_display_text);
     
     if (model_dropup_h > 1.0f && !is_fetching_models && !available_models.empty()) {
         float dropup_y = model_pill_y - model_dropup_h - 5;
@@ -299,9 +419,9 @@ void draw_ui(
                 unsigned int item_color = (i == selected_model_index) ? 
                     RGBA8(160, 160, 160, model_pill_alpha) : RGBA8(255, 255, 255, model_pill_alpha);
                 
-                vita2d_pgf_draw_text(pgf, model_pill_x + 20, item_y + 15, item_color, 1.0f, available_models[i].c_str());
+                draw_list_text(model_pill_x + 20, item_y + 15, item_color, 1.0f, available_models[i]);
                 if (i == selected_model_index) {
-                     vita2d_draw_rectangle(model_pill_x + 5, item_y, 5, 20, RGBA8(160, 160, 160, model_pill_alpha));
+                     draw_list_rect(model_pill_x + 5, item_y, 5, 20, RGBA8(160, 160, 160, model_pill_alpha));
                 }
             }
         }
@@ -329,7 +449,7 @@ void draw_ui(
             float icon_x = circle1_cx - (44 * scale) / 2;
             float icon_y = pill_y + outer_circle_radius - (44 * scale) / 2;
             
-            vita2d_draw_texture_scale(gear_icon, icon_x, icon_y, scale, scale);
+            draw_list_texture(gear_icon, icon_x, icon_y, scale, scale);
         }
 
         unsigned int pill_base_color = can_interact ? MONO_DARK_GRAY : RGBA8(24, 24, 24, 255);
@@ -350,15 +470,15 @@ void draw_ui(
             float icon_x = circle_history_cx - (44 * scale) / 2;
             float icon_y = pill_y + outer_circle_radius - (44 * scale) / 2;
             
-            vita2d_draw_texture_scale(history_icon, icon_x, icon_y, scale, scale);
+            draw_list_texture(history_icon, icon_x, icon_y, scale, scale);
         }
         
         if (staged_photo) {
             float thumb_size = 36.0f; 
-            vita2d_draw_texture_scale(staged_photo, pill_x + 12, pill_y + 12, 
-                                     thumb_size / vita2d_texture_get_width(staged_photo), 
-                                     thumb_size / vita2d_texture_get_height(staged_photo));
-            vita2d_pgf_draw_text(pgf, pill_x + 60, pill_y + 38, RGBA8(255, 255, 255, ui_alpha), 1.0f, "Image ready...");
+            draw_list_texture(staged_photo, pill_x + 12, pill_y + 12, 
+                              thumb_size / vita2d_texture_get_width(staged_photo), 
+                              thumb_size / vita2d_texture_get_height(staged_photo));
+            draw_list_text(pill_x + 60, pill_y + 38, RGBA8(255, 255, 255, ui_alpha), 1.0f, "Image ready...");
         } else {
             std::string display_text;
             if (!user_question.empty()) {
@@ -368,7 +488,7 @@ void draw_ui(
             } else {
                 display_text = "";
             }
-            vita2d_pgf_draw_text(pgf, pill_x + 30, pill_y + 38, RGBA8(255, 255, 255, ui_alpha), 1.0f, display_text.c_str());
+            draw_list_text(pill_x + 30, pill_y + 38, RGBA8(255, 255, 255, ui_alpha), 1.0f, display_text);
         }
 
         float inner_circle_radius = pill_h / 2 - 8;
@@ -391,12 +511,12 @@ void draw_ui(
             float icon_x = circle2_cx - (44 * scale) / 2;
             float icon_y = pill_y + outer_circle_radius - (44 * scale) / 2;
             
-            vita2d_draw_texture_scale(camera_icon, icon_x, icon_y, scale, scale);
+            draw_list_texture(camera_icon, icon_x, icon_y, scale, scale);
         }
     }
 
     if (camera_overlay_alpha > 0) {
-        vita2d_draw_rectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, RGBA8(0, 0, 0, camera_overlay_alpha));
+        draw_list_rect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, RGBA8(0, 0, 0, camera_overlay_alpha));
     
         if (camera_texture != NULL) {
             unsigned int full_alpha = (camera_overlay_alpha * 255) / 180;
@@ -408,14 +528,14 @@ void draw_ui(
             float x = (SCREEN_WIDTH - tex_width) / 2.0f;
             float y = (SCREEN_HEIGHT - tex_height) / 2.0f;
             
-            vita2d_draw_texture_tint(camera_texture, x, y, RGBA8(255, 255, 255, full_alpha));
+            draw_list_texture(camera_texture, x, y, 1.0f, 1.0f, RGBA8(255, 255, 255, full_alpha));
             
             unsigned int hud_bg_alpha = (120 * camera_overlay_alpha) / 180;
             unsigned int hud_text_alpha = full_alpha;
 
             auto draw_hud_text = [&](float x, float y, const char* text) {
-                vita2d_pgf_draw_text(pgf, x + 1, y + 1, RGBA8(0, 0, 0, hud_text_alpha), 1.0f, text);
-                vita2d_pgf_draw_text(pgf, x, y, RGBA8(255, 255, 255, hud_text_alpha), 1.0f, text);
+                draw_list_text(x + 1, y + 1, RGBA8(0, 0, 0, hud_text_alpha), 1.0f, text);
+                draw_list_text(x, y, RGBA8(255, 255, 255, hud_text_alpha), 1.0f, text);
             };
 
             float top_banner_y = 48; 
@@ -424,14 +544,14 @@ void draw_ui(
 
             if (photo_taken) {
                 const char* confirm_text = "Photo Taken!";
-                float text_w = vita2d_pgf_text_width(pgf, 1.0f, confirm_text);
+                float text_w = text_metrics_width(confirm_text);
                 draw_hud_text((SCREEN_WIDTH - text_w) / 2, top_banner_y, confirm_text);
 
                 const char* redo_prompt = "L Redo";
                 const char* confirm_prompt = "O Confirm & Exit";
                 draw_hud_text(40, bottom_banner_y, redo_prompt);
                 
-                float confirm_prompt_w = vita2d_pgf_text_width(pgf, 1.0f, confirm_prompt);
+                float confirm_prompt_w = text_metrics_width(confirm_prompt);
                 draw_hud_text(SCREEN_WIDTH - 40 - confirm_prompt_w, bottom_banner_y, confirm_prompt);
 
             } else {
@@ -439,63 +559,135 @@ void draw_ui(
                 draw_hud_text(65, top_banner_y, "Live View");
 
                 const char* capture_prompt = "R Capture";
-                float capture_prompt_w = vita2d_pgf_text_width(pgf, 1.0f, capture_prompt);
+                float capture_prompt_w = text_metrics_width(capture_prompt);
                 draw_hud_text(SCREEN_WIDTH - 40 - capture_prompt_w, top_banner_y, capture_prompt);
                 
                 const char* switch_prompt = "△ Switch";
                 const char* exit_prompt = "O Exit";
                 draw_hud_text(40, bottom_banner_y, switch_prompt);
                 
-                float exit_prompt_w = vita2d_pgf_text_width(pgf, 1.0f, exit_prompt);
+                float exit_prompt_w = text_metrics_width(exit_prompt);
                 draw_hud_text(SCREEN_WIDTH - 40 - exit_prompt_w, bottom_banner_y, exit_prompt);
             }
         }
     }
 
+    draw_list_submit();
     vita2d_end_drawing();
 }
 
-std::vector<std::string> wrap_text(vita2d_pgf *pgf, const std::string& text, int max_line_width_pixels) {
+// Line widths are accumulated from per-glyph advances rather than measuring
+// each candidate line, so wrapping is linear in the length of the text. A
+// word too wide for a line of its own is broken between code points.
+std::vector<std::string> wrap_text(vita2d_pgf *pgf, const std::string& text, int max_line_width_pixels, std::vector<float>* line_widths) {
     std::vector<std::string> lines;
     std::string current_line;
+    int current_width = 0;
     std::string word;
+    int word_width = 0;
+    std::vector<std::pair<size_t, int> > word_glyphs; // end offset in word, advance
+    int space_width = text_metrics_advance(' ');
 
-    for (char c : text) {
-        if (c == ' ' || c == '\n') {
-            if (!word.empty()) {
-                std::string temp_line = current_line + (current_line.empty() ? "" : " ") + word;
-                if (vita2d_pgf_text_width(pgf, 1.0f, temp_line.c_str()) > max_line_width_pixels) {
-                    lines.push_back(current_line);
-                    current_line = word;
-                } else {
-                    current_line = temp_line;
+    if (line_widths) {
+        line_widths->clear();
+    }
+
+    auto push_line = [&]() {
+        lines.push_back(current_line);
+        if (line_widths) {
+            line_widths->push_back(current_width);
+        }
+        current_line.clear();
+        current_width = 0;
+    };
+
+    auto flush_word = [&]() {
+        if (word.empty()) {
+            return;
+        }
+
+        int joined_width = current_line.empty() ? word_width : current_width + space_width + word_width;
+        if (joined_width <= max_line_width_pixels) {
+            if (!current_line.empty()) current_line += ' ';
+            current_line += word;
+            current_width = joined_width;
+        } else if (word_width <= max_line_width_pixels) {
+            push_line();
+            current_line = word;
+            current_width = word_width;
+        } else {
+            if (!current_line.empty()) {
+                push_line();
+            }
+            size_t start = 0;
+            for (const auto& glyph : word_glyphs) {
+                if (!current_line.empty() && current_width + glyph.second > max_line_width_pixels) {
+                    push_line();
                 }
-                word.clear();
+                current_line.append(word, start, glyph.first - start);
+                current_width += glyph.second;
+                start = glyph.first;
             }
+        }
+
+        word.clear();
+        word_width = 0;
+        word_glyphs.clear();
+    };
+
+    for (size_t i = 0; i < text.size(); ) {
+        char c = text[i];
+        if (c == ' ' || c == '\n') {
+            flush_word();
             if (c == '\n') {
-                lines.push_back(current_line);
-                current_line.clear();
+                push_line();
             }
-        } else {
-            word += c;
+            i++;
+            continue;
         }
+
+        unsigned int codepoint;
+        size_t length = utf8_decode(text, i, codepoint);
+        int advance = text_metrics_advance(codepoint);
+        word.append(text, i, length);
+        word_width += advance;
+        word_glyphs.push_back(std::make_pair(word.size(), advance));
+        i += length;
     }
 
-    if (!word.empty()) {
-        std::string temp_line = current_line + (current_line.empty() ? "" : " ") + word;
-        if (vita2d_pgf_text_width(pgf, 1.0f, temp_line.c_str()) > max_line_width_pixels) {
-            lines.push_back(current_line);
-            lines.push_back(word);
-        } else {
-            lines.push_back(temp_line);
-        }
-    } else if (!current_line.empty()) {
-        lines.push_back(current_line);
+    flush_word();
+    if (!current_line.empty()) {
+        push_line();
     }
 
     return lines;
 }
 
+void draw_image_viewer(vita2d_pgf* pgf, const ChatMessage& msg) {
+    vita2d_start_drawing();
+    vita2d_clear_screen();
+
+    // Full resolution is only loaded here; the chat view sticks to thumbnails
+    vita2d_texture* image = msg.image ? msg.image : texture_cache_get(msg.image_path);
+    if (image) {
+        float width = vita2d_texture_get_width(image);
+        float height = vita2d_texture_get_height(image);
+        float scale = std::min((SCREEN_WIDTH - 40) / width, (SCREEN_HEIGHT - 60) / height);
+        draw_list_texture(image, (SCREEN_WIDTH - width * scale) / 2, (SCREEN_HEIGHT - 20 - height * scale) / 2, scale, scale);
+    } else {
+        const char* error_text = "Could not load image";
+        float error_w = text_metrics_width(error_text);
+        draw_list_text((SCREEN_WIDTH - error_w) / 2, SCREEN_HEIGHT / 2, MONO_GRAY, 1.0f, error_text);
+    }
+
+    const char* close_prompt = "O Close";
+    float close_prompt_w = text_metrics_width(close_prompt);
+    draw_list_text(SCREEN_WIDTH - 40 - close_prompt_w, SCREEN_HEIGHT - 15, MONO_LIGHT_GRAY, 1.0f, close_prompt);
+
+    draw_list_submit();
+    vita2d_end_drawing();
+}
+
 void draw_scene(vita2d_pgf* pgf, const std::string& text) {
     vita2d_start_drawing();
     vita2d_clear_screen();
@@ -503,10 +695,11 @@ void draw_scene(vita2d_pgf* pgf, const std::string& text) {
     std::vector<std::string> lines = wrap_text(pgf, text, 50);
     int y = 30;
     for (const auto& line : lines) {
-        vita2d_pgf_draw_text(pgf, 20, y, RGBA8(255, 255, 255, 255), 1.0f, line.c_str());
+        draw_list_text(20, y, RGBA8(255, 255, 255, 255), 1.0f, line);
         y += 20;
     }
     
+    draw_list_submit();
     vita2d_end_drawing();
     vita2d_swap_buffers();
 }
@@ -524,6 +717,12 @@ void cleanup_ui_textures() {
         vita2d_free_texture(history_icon);
         history_icon = NULL;
     }
+    for (auto& sprite : s_circle_sprites) {
+        if (sprite.second != NULL) {
+            vita2d_free_texture(sprite.second);
+        }
+    }
+    s_circle_sprites.clear();
 }
 
 void draw_settings_ui(
@@ -546,9 +745,9 @@ void draw_settings_ui(
     
     if (ui_alpha > 0) {
         const char* title = "Settings";
-        float title_width = vita2d_pgf_text_width(pgf, 1.5f, title);
+        float title_width = text_metrics_width(title, 1.5f);
         float title_x = (SCREEN_WIDTH - title_width) / 2;
-        vita2d_pgf_draw_text(pgf, title_x, 100, RGBA8(255, 255, 255, ui_alpha), 1.5f, title);
+        draw_list_text(title_x, 100, RGBA8(255, 255, 255, ui_alpha), 1.5f, title);
         
         std::string endpoint_text = "Endpoint: " + settings.endpoint;
         std::string apikey_text = std::string("API Key: ") + (settings.apiKey.empty() ? "[Not set]" : "********");
@@ -567,10 +766,10 @@ void draw_settings_ui(
             override_text += "[Not set]";
         }
 
-        float endpoint_text_width = vita2d_pgf_text_width(pgf, 1.0f, endpoint_text.c_str());
-        float apikey_text_width = vita2d_pgf_text_width(pgf, 1.0f, apikey_text.c_str());
-        float default_model_text_width = vita2d_pgf_text_width(pgf, 1.0f, default_model_text.c_str());
-        float override_text_width = vita2d_pgf_text_width(pgf, 1.0f, override_text.c_str());
+        float endpoint_text_width = text_metrics_width(endpoint_text.c_str());
+        float apikey_text_width = text_metrics_width(apikey_text.c_str());
+        float default_model_text_width = text_metrics_width(default_model_text.c_str());
+        float override_text_width = text_metrics_width(override_text.c_str());
         
         float max_text_width = std::max({endpoint_text_width, apikey_text_width, default_model_text_width, override_text_width});
         float text_x = (SCREEN_WIDTH - max_text_width) / 2;
@@ -580,10 +779,10 @@ void draw_settings_ui(
         float default_model_y = 270;
         float override_y = 320;
 
-        vita2d_pgf_draw_text(pgf, text_x, endpoint_y, RGBA8(255, 255, 255, ui_alpha), 1.0f, endpoint_text.c_str());
-        vita2d_pgf_draw_text(pgf, text_x, apikey_y, RGBA8(255, 255, 255, ui_alpha), 1.0f, apikey_text.c_str());
-        vita2d_pgf_draw_text(pgf, text_x, default_model_y, RGBA8(255, 255, 255, ui_alpha), 1.0f, default_model_text.c_str());
-        vita2d_pgf_draw_text(pgf, text_x, override_y, RGBA8(255, 255, 255, ui_alpha), 1.0f, override_text.c_str());
+        draw_list_text(text_x, endpoint_y, RGBA8(255, 255, 255, ui_alpha), 1.0f, endpoint_text);
+        draw_list_text(text_x, apikey_y, RGBA8(255, 255, 255, ui_alpha), 1.0f, apikey_text);
+        draw_list_text(text_x, default_model_y, RGBA8(255, 255, 255, ui_alpha), 1.0f, default_model_text);
+        draw_list_text(text_x, override_y, RGBA8(255, 255, 255, ui_alpha), 1.0f, override_text);
 
         int selection_y_center = 0;
         if (selection == SettingsSelection::ENDPOINT) {
@@ -607,7 +806,7 @@ void draw_settings_ui(
         
         float feather_width = 30.0f; 
         float main_width = highlight_width - (feather_width * 2);
-        vita2d_draw_rectangle(highlight_x + feather_width, highlight_y, main_width, highlight_height, highlight_color);
+        draw_list_rect(highlight_x + feather_width, highlight_y, main_width, highlight_height, highlight_color);
         
         int feather_steps = 15; 
         for (int i = 0; i < feather_steps; i++) {
@@ -617,13 +816,13 @@ void draw_settings_ui(
             unsigned int right_alpha = (unsigned int)(base_alpha * right_opacity);
             unsigned int right_color = RGBA8(160, 160, 160, right_alpha);
             float right_x = highlight_x + feather_width + main_width + (i * step_width);
-            vita2d_draw_rectangle(right_x, highlight_y, step_width, highlight_height, right_color);
+            draw_list_rect(right_x, highlight_y, step_width, highlight_height, right_color);
             
             float left_opacity = (float)(feather_steps - i) / feather_steps; 
             unsigned int left_alpha = (unsigned int)(base_alpha * left_opacity);
             unsigned int left_color = RGBA8(160, 160, 160, left_alpha);
             float left_x = highlight_x + feather_width - ((i + 1) * step_width);
-            vita2d_draw_rectangle(left_x, highlight_y, step_width, highlight_height, left_color);
+            draw_list_rect(left_x, highlight_y, step_width, highlight_height, left_color);
         }
 
         if (model_selection_open && !available_models.empty()) {
@@ -636,14 +835,14 @@ void draw_settings_ui(
 
             for (size_t i = 0; i < available_models.size(); ++i) {
                 unsigned int text_color = (i == (size_t)selected_model_index) ? MONO_WHITE : MONO_LIGHT_GRAY;
-                vita2d_pgf_draw_text(pgf, dropdown_x + 20, dropdown_y + 30 + (i * 35), text_color, 1.0f, available_models[i].c_str());
+                draw_list_text(dropdown_x + 20, dropdown_y + 30 + (i * 35), text_color, 1.0f, available_models[i]);
             }
         }
 
         const char* instructions = "X Edit, O Return";
-        float instructions_width = vita2d_pgf_text_width(pgf, 1.0f, instructions);
+        float instructions_width = text_metrics_width(instructions);
         float instructions_x = (SCREEN_WIDTH - instructions_width) / 2;
-        vita2d_pgf_draw_text(pgf, instructions_x, SCREEN_HEIGHT - 50, RGBA8(255, 255, 255, ui_alpha), 1.0f, instructions);
+        draw_list_text(instructions_x, SCREEN_HEIGHT - 50, RGBA8(255, 255, 255, ui_alpha), 1.0f, instructions);
         
         if (show_connecting_popup) {
             float popup_width = 400;
@@ -664,9 +863,9 @@ void draw_settings_ui(
                 title_color = RGBA8(255, 255, 255, 255); 
             }
             
-            float popup_title_width = vita2d_pgf_text_width(pgf, 1.2f, popup_title);
+            float popup_title_width = text_metrics_width(popup_title, 1.2f);
             float popup_title_x = (SCREEN_WIDTH - popup_title_width) / 2;
-            vita2d_pgf_draw_text(pgf, popup_title_x, popup_y + 40, title_color, 1.2f, popup_title);
+            draw_list_text(popup_title_x, popup_y + 40, title_color, 1.2f, popup_title);
             
             const char* popup_msg;
             if (connection_failed) {
@@ -677,11 +876,12 @@ void draw_settings_ui(
                 popup_msg = "Testing connection";
             }
             
-            float popup_msg_width = vita2d_pgf_text_width(pgf, 1.0f, popup_msg);
+            float popup_msg_width = text_metrics_width(popup_msg);
             float popup_msg_x = (SCREEN_WIDTH - popup_msg_width) / 2;
-            vita2d_pgf_draw_text(pgf, popup_msg_x, popup_y + 70, RGBA8(200, 200, 200, 255), 1.0f, popup_msg);
+            draw_list_text(popup_msg_x, popup_y + 70, RGBA8(200, 200, 200, 255), 1.0f, popup_msg);
         }
     }
     
+    draw_list_submit();
     vita2d_end_drawing();
 } 
\ No newline at end of file
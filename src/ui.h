@@ -5,9 +5,12 @@
 #include <vector>
 #include <vita2d.h>
 #include "types.h"
+#include "chat_layout.h"
+#include "text_run_cache.h"
+#include "draw_list.h"
 
 
-void draw_quarter_circle(float cx, float cy, float radius, int quadrant, unsigned int color);
+// Recorded into the frame's draw list (draw_list.h)
 void draw_circle(float cx, float cy, float radius, unsigned int color);
 void draw_rounded_rect(float x, float y, float w, float h, float radius, unsigned int color);
 
@@ -15,9 +18,9 @@ void draw_rounded_rect(float x, float y, float w, float h, float radius, unsigne
 void draw_ui(
     vita2d_pgf *pgf,
     const std::vector<ChatMessage>& chat_history,
+    ChatLayout& layout,
     const std::string& user_question,
     int scroll_offset,
-    int& total_history_height,
     UISelection current_selection,
     const std::vector<std::string>& available_models,
     int selected_model_index,
@@ -52,7 +55,20 @@ void draw_settings_ui(
 );
 
 
-std::vector<std::string> wrap_text(vita2d_pgf *pgf, const std::string& text, int max_line_width_pixels);
+// Full-screen view of a message's image at full resolution
+void draw_image_viewer(vita2d_pgf* pgf, const ChatMessage& msg);
+
+
+// Renders text runs (text_run_cache.h) with the PGF font into a render target
+TextRunBackend native_text_run_backend(vita2d_pgf* pgf);
+
+
+// Draws commands from the draw list with vita2d and the PGF font
+DrawBackend native_draw_backend(vita2d_pgf* pgf);
+
+
+// line_widths, if given, receives the measured width of each line
+std::vector<std::string> wrap_text(vita2d_pgf *pgf, const std::string& text, int max_line_width_pixels, std::vector<float>* line_widths = NULL);
 
 
 void draw_scene(vita2d_pgf* pgf, const std::string& text);
@@ -0,0 +1,106 @@
+#include "test.h"
+#include "base64.h"
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+// Encodings are decoded with an independent reference decoder and compared
+// with the scalar encoder. On ARM builds base64_encode_to takes the NEON
+// block path, so lengths cover whole 48-byte blocks plus tails of 0-2
+// bytes, at every alignment of the input and output.
+
+static int decode_char(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+static bool reference_decode(const std::string& text, std::vector<unsigned char>& out) {
+    out.clear();
+    if (text.size() % 4 != 0) return false;
+    for (size_t i = 0; i < text.size(); i += 4) {
+        int pad = (text[i + 3] == '=') + (text[i + 2] == '=');
+        if (pad > 0 && i + 4 != text.size()) return false;
+        unsigned int value = 0;
+        for (int k = 0; k < 4; k++) {
+            int bits = (k >= 4 - pad) ? 0 : decode_char(text[i + k]);
+            if (bits < 0) return false;
+            value = (value << 6) | bits;
+        }
+        out.push_back(value >> 16);
+        if (pad < 2) out.push_back((value >> 8) & 0xFF);
+        if (pad < 1) out.push_back(value & 0xFF);
+    }
+    return true;
+}
+
+static void test_known_vectors() {
+    const char* vectors[][2] = {
+        { "", "" }, { "f", "Zg==" }, { "fo", "Zm8=" }, { "foo", "Zm9v" },
+        { "foob", "Zm9vYg==" }, { "fooba", "Zm9vYmE=" }, { "foobar", "Zm9vYmFy" },
+    };
+    for (const auto& vector : vectors) {
+        std::string out;
+        base64_append(out, (const unsigned char*)vector[0], strlen(vector[0]));
+        CHECK_EQ(out, vector[1]);
+    }
+}
+
+static void test_round_trip() {
+    std::vector<unsigned char> data(48 * 8 + 16 + 2);
+    srand(7);
+    for (auto& byte : data) byte = rand() & 0xFF;
+    for (size_t i = 0; i < 64; i++) data[i] = 0xFF - i; // high bytes and the '+'/'/' range
+
+    std::vector<char> out(base64_encoded_size(data.size()) + 16);
+    std::vector<char> scalar(out.size());
+    std::vector<unsigned char> decoded;
+
+    for (size_t in_offset = 0; in_offset < 16; in_offset++) {
+        for (size_t out_offset = 0; out_offset < 4; out_offset++) {
+            for (size_t len = 0; len + in_offset + 2 <= data.size(); len += (len < 200 ? 1 : 47)) {
+                const unsigned char* in = data.data() + in_offset;
+                size_t written = base64_encode_to(in, len, out.data() + out_offset);
+                size_t scalar_written = base64_encode_scalar_to(in, len, scalar.data());
+                std::string encoded(out.data() + out_offset, written);
+
+                CHECK_EQ(written, base64_encoded_size(len));
+                CHECK_EQ(encoded, std::string(scalar.data(), scalar_written));
+                CHECK(reference_decode(encoded, decoded));
+                CHECK(decoded == std::vector<unsigned char>(in, in + len));
+            }
+        }
+    }
+}
+
+static void test_stream() {
+    std::vector<unsigned char> data(1000);
+    srand(11);
+    for (auto& byte : data) byte = rand() & 0xFF;
+    std::string expected;
+    base64_append(expected, data.data(), data.size());
+
+    for (int run = 0; run < 200; run++) {
+        std::string out;
+        Base64Stream stream;
+        stream.out = &out;
+        size_t pos = 0;
+        while (pos < data.size()) {
+            size_t len = std::min<size_t>(rand() % (run < 100 ? 4 : 130), data.size() - pos);
+            base64_stream_write(stream, data.data() + pos, len);
+            pos += len;
+        }
+        base64_stream_finish(stream);
+        CHECK_EQ(out, expected);
+    }
+}
+
+int main() {
+    test_known_vectors();
+    test_round_trip();
+    test_stream();
+    return test_result();
+}
@@ -0,0 +1,78 @@
+#include "test.h"
+#include "chat_layout.h"
+
+// Cost of chat_layout_update per frame on long sessions: a frame where
+// nothing changed, a reply streaming into the last message, and reasoning
+// toggled on the first message, which moves every message below it.
+// Switching sessions lays everything out again, which is what every frame
+// cost before messages were marked. The lines are already wrapped; wrapping
+// itself is left to the text metrics.
+
+// Stand-in for ui.cpp: one line per 40 bytes, 8 px each
+std::vector<std::string> wrap_text(vita2d_pgf*, const std::string& text, int, std::vector<float>* line_widths) {
+    std::vector<std::string> lines;
+    for (size_t i = 0; i < text.size(); i += 40) {
+        lines.push_back(text.substr(i, 40));
+    }
+    if (line_widths) {
+        line_widths->assign(lines.size(), 320.0f);
+    }
+    return lines;
+}
+
+static ChatSession make_session(int count, size_t reply_size) {
+    ChatSession session;
+    session.id = 1;
+    for (int i = 0; i < count; i++) {
+        ChatMessage message;
+        message.sender = i % 2 ? ChatMessage::LLM : ChatMessage::USER;
+        message.text = std::string(message.sender == ChatMessage::LLM ? reply_size : 80, 'x');
+        if (message.sender == ChatMessage::LLM) {
+            message.reasoning = std::string(200, 'r');
+        }
+        wrap_message(NULL, message, BUBBLE_CONTENT_WIDTH);
+        session.messages.push_back(message);
+    }
+    return session;
+}
+
+template <typename Fn>
+static void bench(const char* name, ChatSession& session, ChatLayout& layout, Fn change) {
+    const int frames = 2000;
+    double start = now_us();
+    for (int i = 0; i < frames; i++) {
+        change(session, i);
+        chat_layout_update(layout, session);
+    }
+    double us = (now_us() - start) / frames;
+    printf("  %-18s %8.3f us per frame\n", name, us);
+}
+
+static void run(const char* title, int count, size_t reply_size) {
+    ChatSession session = make_session(count, reply_size);
+    ChatLayout layout;
+    double start = now_us();
+    chat_layout_update(layout, session);
+    printf("%s: %d messages, %d px tall, first layout %.0f us\n", title, count, layout.total_height, now_us() - start);
+
+    bench("unchanged", session, layout, [](ChatSession&, int) {});
+    bench("streaming last", session, layout, [](ChatSession& s, int) {
+        chat_layout_invalidate(s, s.messages.size() - 1);
+        s.messages.back().layout.valid = false;
+    });
+    size_t first_llm = session.messages.size() > 1 ? 1 : 0;
+    bench("toggle first", session, layout, [first_llm](ChatSession& s, int) {
+        s.messages[first_llm].show_reasoning = !s.messages[first_llm].show_reasoning;
+        chat_layout_invalidate(s, first_llm);
+    });
+    bench("session switch", session, layout, [](ChatSession& s, int i) {
+        s.id = 1 + i % 2;
+    });
+}
+
+int main() {
+    run("1k messages", 1000, 1500);
+    run("10k messages", 10000, 600);
+    run("one 5k-line reply", 2, 5000 * 40);
+    return test_result();
+}
@@ -0,0 +1,160 @@
+// chat_layout_update against laying the whole session out from scratch,
+// after the kinds of changes the app makes: replies streaming in, reasoning
+// toggled, messages appended or removed and sessions switched.
+
+#include "chat_layout.h"
+#include "test.h"
+
+// Stand-in for ui.cpp: 10 px per byte, wrapped every 30 bytes and at newlines
+std::vector<std::string> wrap_text(vita2d_pgf*, const std::string& text, int, std::vector<float>* line_widths) {
+    std::vector<std::string> lines;
+    std::istringstream in(text);
+    std::string line;
+    while (std::getline(in, line)) {
+        for (size_t i = 0; i == 0 || i < line.size(); i += 30) {
+            lines.push_back(line.substr(i, 30));
+        }
+    }
+    if (line_widths) {
+        line_widths->clear();
+        for (const auto& wrapped : lines) {
+            line_widths->push_back(wrapped.size() * 10.0f);
+        }
+    }
+    return lines;
+}
+
+static ChatMessage make_message(int i) {
+    ChatMessage message;
+    message.sender = i % 2 ? ChatMessage::LLM : ChatMessage::USER;
+    message.text = std::string(10 + (i * 37) % 100, 'x');
+    if (message.sender == ChatMessage::LLM && i % 3 == 0) {
+        message.reasoning = std::string(50 + i % 70, 'r');
+    }
+    if (i % 11 == 0) {
+        message.image_path = "image.jpg";
+        message.image_width = 640;
+        message.image_height = 480;
+    }
+    wrap_message(NULL, message, BUBBLE_CONTENT_WIDTH);
+    return message;
+}
+
+// Lays a copy of the session out from nothing and compares
+static void check_matches_fresh(const ChatLayout& layout, const ChatSession& session) {
+    ChatSession copy = session;
+    copy.layout_dirty_from = 0;
+    for (auto& message : copy.messages) {
+        message.layout.valid = false;
+    }
+    ChatLayout fresh;
+    chat_layout_update(fresh, copy);
+
+    CHECK_EQ(layout.tops.size(), session.messages.size());
+    CHECK_EQ(layout.total_height, fresh.total_height);
+    CHECK(layout.tops == fresh.tops);
+    CHECK(layout.bottoms == fresh.bottoms);
+    CHECK_EQ(session.layout_dirty_from, session.messages.size());
+}
+
+static void test_updates() {
+    ChatSession session;
+    session.id = 1;
+    for (int i = 0; i < 200; i++) {
+        session.messages.push_back(make_message(i));
+    }
+    ChatLayout layout;
+    chat_layout_update(layout, session);
+    check_matches_fresh(layout, session);
+
+    // A reply streaming into the last message
+    ChatMessage& last = session.messages.back();
+    for (int i = 0; i < 5; i++) {
+        last.text += std::string(45, 'y') + "\n";
+        wrap_message(NULL, last, BUBBLE_CONTENT_WIDTH);
+        chat_layout_invalidate(session, session.messages.size() - 1);
+        chat_layout_update(layout, session);
+        check_matches_fresh(layout, session);
+    }
+
+    // Reasoning shown on a message near the top moves everything below it
+    session.messages[3].show_reasoning = true;
+    chat_layout_invalidate(session, 3);
+    chat_layout_update(layout, session);
+    check_matches_fresh(layout, session);
+    session.messages[3].show_reasoning = false;
+    chat_layout_invalidate(session, 3);
+    chat_layout_update(layout, session);
+    check_matches_fresh(layout, session);
+
+    // Two marks in one frame
+    session.messages[150].show_reasoning = true;
+    session.messages[9].show_reasoning = true;
+    chat_layout_invalidate(session, 150);
+    chat_layout_invalidate(session, 9);
+    chat_layout_update(layout, session);
+    check_matches_fresh(layout, session);
+
+    // Appended and removed messages need no mark
+    session.messages.push_back(make_message(200));
+    session.messages.push_back(make_message(201));
+    chat_layout_update(layout, session);
+    check_matches_fresh(layout, session);
+    session.messages.pop_back();
+    chat_layout_update(layout, session);
+    check_matches_fresh(layout, session);
+
+    // Nothing marked: the layout is left alone
+    std::vector<int> tops = layout.tops;
+    chat_layout_update(layout, session);
+    CHECK(layout.tops == tops);
+}
+
+static void test_switch_sessions() {
+    ChatSession a;
+    a.id = 1;
+    for (int i = 0; i < 20; i++) {
+        a.messages.push_back(make_message(i));
+    }
+    ChatSession b;
+    b.id = 2;
+    ChatLayout layout;
+    chat_layout_update(layout, a);
+    check_matches_fresh(layout, a);
+
+    chat_layout_update(layout, b);
+    CHECK_EQ(layout.total_height, 0);
+    CHECK(layout.tops.empty());
+
+    // Back to a session laid out before: its marks were cleared, but the layout wasn't kept
+    chat_layout_update(layout, a);
+    check_matches_fresh(layout, a);
+
+    b.messages.push_back(make_message(1));
+    chat_layout_update(layout, b);
+    check_matches_fresh(layout, b);
+}
+
+static void test_find() {
+    ChatSession session;
+    session.id = 1;
+    for (int i = 0; i < 50; i++) {
+        session.messages.push_back(make_message(i));
+    }
+    ChatLayout layout;
+    chat_layout_update(layout, session);
+    CHECK_EQ(chat_layout_find(layout, 0), 0u);
+    for (size_t i = 0; i < 50; i++) {
+        CHECK_EQ(chat_layout_find(layout, layout.tops[i]), i);
+        CHECK_EQ(chat_layout_find(layout, layout.bottoms[i]), i);
+        CHECK_EQ(chat_layout_find(layout, layout.bottoms[i] + 1), i + 1);
+    }
+    CHECK_EQ(chat_layout_find(layout, layout.total_height + 1), 50u);
+}
+
+int main() {
+    test_updates();
+    test_switch_sessions();
+    test_find();
+    return test_result();
+}
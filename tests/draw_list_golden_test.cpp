@@ -0,0 +1,132 @@
+// Golden frames: draw_ui and draw_sessions_ui recorded through
+// recording_draw_backend and compared, as draw_list_dump text, against
+// tests/data/frames.dump. Text is measured by the fake PGF font in
+// host/fake_vita2d.cpp.
+//
+// After an intended change to what a frame draws, rewrite the file with
+//   VELA_UPDATE_GOLDEN=1 ./draw_list_golden_test
+// and review the diff.
+
+#include "ui.h"
+#include "sessions.h"
+#include "text_metrics.h"
+#include "texture_cache.h"
+#include "test.h"
+#include <cstdlib>
+
+// Only unsaved photos (ChatMessage::image) are used here
+std::string thumbnail_path_for(const std::string& image_path) {
+    return image_path + ".thumb";
+}
+
+static std::vector<DrawCommand> s_commands;
+
+static ChatMessage make_message(ChatMessage::Sender sender, const std::string& text, const std::string& reasoning = "") {
+    ChatMessage message;
+    message.sender = sender;
+    message.text = text;
+    message.reasoning = reasoning;
+    wrap_message(NULL, message, BUBBLE_CONTENT_WIDTH);
+    return message;
+}
+
+static ChatSession make_session() {
+    ChatSession session;
+    session.id = 1;
+    session.messages.push_back(make_message(ChatMessage::USER, "What is the tallest mountain on Earth?"));
+    ChatMessage reply = make_message(ChatMessage::LLM,
+        "Mount Everest, at 8,849 m above sea level. Measured from its base, Mauna Kea in Hawaii is taller.",
+        "The user asks for the tallest mountain. Everest by elevation; mention Mauna Kea.");
+    reply.show_reasoning = true;
+    wrap_message(NULL, reply, BUBBLE_CONTENT_WIDTH);
+    session.messages.push_back(reply);
+
+    ChatMessage photo = make_message(ChatMessage::USER, "And this one?");
+    photo.image = vita2d_create_empty_texture(640, 480);
+    photo.image_width = 640;
+    photo.image_height = 480;
+    wrap_message(NULL, photo, BUBBLE_CONTENT_WIDTH);
+    session.messages.push_back(photo);
+
+    std::string long_reply;
+    for (int i = 1; i <= 40; i++) {
+        long_reply += "Line " + std::to_string(i) + " of a long answer.\n";
+    }
+    session.messages.push_back(make_message(ChatMessage::LLM, long_reply, "Hidden reasoning."));
+    return session;
+}
+
+static std::string chat_frame(ChatSession& session, int scroll_offset, bool models_open, int hovered) {
+    ChatLayout layout;
+    chat_layout_update(layout, session);
+    std::vector<std::string> models = { "llama-3.1-8b", "qwen2.5-vl-7b", "gpt-4o-mini" };
+    s_commands.clear();
+    draw_ui(NULL, session.messages, layout, "Tell me more", scroll_offset, UISelection::INPUT_PILL,
+            models, 1, models_open, false, true, 255, 255, false, NULL, false, NULL, 0,
+            models_open ? models.size() * 35 + 15 : 0.0f, hovered, 0.0f);
+    return draw_list_dump(s_commands);
+}
+
+static std::string sessions_frame() {
+    std::vector<ChatSession> sessions;
+    for (int i = 0; i < 4; i++) {
+        ChatSession session;
+        session.id = i + 1;
+        session.loaded = false;
+        session.summary.preview = "Session number " + std::to_string(i + 1) + " about something";
+        session.summary.message_count = 2 + i * 3;
+        session.summary.modified = 1700000000 + i * 86400;
+        sessions.push_back(session);
+    }
+    s_commands.clear();
+    draw_sessions_ui(NULL, sessions, 0, 1, true, false);
+    return draw_list_dump(s_commands);
+}
+
+int main() {
+    text_metrics_init(native_text_metrics_source(NULL));
+    text_run_cache_init(native_text_run_backend(NULL));
+    draw_list_init(recording_draw_backend(&s_commands));
+
+    ChatSession session = make_session();
+    std::string frames;
+    frames += "# chat, top\n" + chat_frame(session, 0, false, 1);
+    frames += "# chat, scrolled into the long reply with the model list open\n" + chat_frame(session, 600, true, 3);
+    frames += "# sessions, delete confirmation\n" + sessions_frame();
+
+    std::string path = std::string(VELA_TEST_DATA) + "/frames.dump";
+    if (getenv("VELA_UPDATE_GOLDEN")) {
+        std::ofstream(path, std::ios::binary) << frames;
+        printf("wrote %s\n", path.c_str());
+        return 0;
+    }
+
+    std::string expected = test_data("frames.dump");
+    if (frames != expected) {
+        std::istringstream got_lines(frames), expected_lines(expected);
+        std::string got_line, expected_line;
+        for (int line = 1; ; line++) {
+            bool more_got = (bool)std::getline(got_lines, got_line);
+            bool more_expected = (bool)std::getline(expected_lines, expected_line);
+            if (!more_got && !more_expected) {
+                break;
+            }
+            if (got_line != expected_line || more_got != more_expected) {
+                fprintf(stderr, "frames.dump:%d differs\n  expected: %s\n  got:      %s\n", line,
+                        more_expected ? expected_line.c_str() : "(end)", more_got ? got_line.c_str() : "(end)");
+                break;
+            }
+        }
+        s_test_failures++;
+    }
+
+    for (auto& message : session.messages) {
+        if (message.image) {
+            vita2d_free_texture(message.image);
+        }
+    }
+    draw_list_shutdown();
+    text_run_cache_shutdown();
+    text_metrics_shutdown();
+    return test_result();
+}
@@ -0,0 +1,75 @@
+#include "test.h"
+#include "frame_pacing.h"
+
+// The idle wait of the main loop, simulated vblank by vblank: one vblank
+// per still frame for the first second, then wakes that average exactly
+// idle_fps for every rate, never more than ceil(60 / idle_fps) vblanks
+// apart, and a drawn frame starts the count over.
+
+// Still iterations until the cap kicks in; returns the vblanks they waited
+static int run_uncapped(IdlePacing& pacing, int idle_fps) {
+    int vblanks = 0;
+    for (int i = 0; i < IDLE_CAP_AFTER_FRAMES; i++) {
+        int wait = idle_pacing_wait(pacing, idle_fps);
+        CHECK_EQ(wait, 1);
+        vblanks += wait;
+    }
+    return vblanks;
+}
+
+static void test_rates() {
+    for (int fps = 10; fps <= 60; fps++) {
+        IdlePacing pacing;
+        CHECK_EQ(run_uncapped(pacing, fps), IDLE_CAP_AFTER_FRAMES);
+
+        // Ten seconds of capped waits wake exactly fps * 10 times
+        int longest = (60 + fps - 1) / fps;
+        int vblanks = 0;
+        int wakes = 0;
+        while (vblanks < 600) {
+            int wait = idle_pacing_wait(pacing, fps);
+            CHECK(wait >= 60 / fps);
+            CHECK(wait <= longest);
+            vblanks += wait;
+            wakes++;
+        }
+        CHECK_EQ(vblanks, 600);
+        CHECK_EQ(wakes, fps * 10);
+    }
+
+    // 25 fps alternates between 2 and 3 vblanks
+    IdlePacing pacing;
+    run_uncapped(pacing, 25);
+    CHECK_EQ(idle_pacing_wait(pacing, 25), 3);
+    CHECK_EQ(idle_pacing_wait(pacing, 25), 2);
+    CHECK_EQ(idle_pacing_wait(pacing, 25), 3);
+    CHECK_EQ(idle_pacing_wait(pacing, 25), 2);
+    CHECK_EQ(idle_pacing_wait(pacing, 25), 2);
+
+    // The floor of 10 fps keeps a press waiting at most 6 vblanks
+    pacing = IdlePacing();
+    run_uncapped(pacing, 10);
+    for (int i = 0; i < 20; i++) {
+        CHECK_EQ(idle_pacing_wait(pacing, 10), 6);
+    }
+}
+
+static void test_reset() {
+    IdlePacing pacing;
+    run_uncapped(pacing, 25);
+    idle_pacing_wait(pacing, 25);
+    CHECK(pacing.phase != 0);
+
+    // A drawn frame goes back to a wake per vblank for another second
+    idle_pacing_reset(pacing);
+    CHECK_EQ(pacing.frames, 0);
+    CHECK_EQ(pacing.phase, 0);
+    run_uncapped(pacing, 25);
+    CHECK_EQ(idle_pacing_wait(pacing, 25), 3);
+}
+
+int main() {
+    test_rates();
+    test_reset();
+    return test_result();
+}
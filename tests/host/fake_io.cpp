@@ -0,0 +1,165 @@
+#include "fake_io.h"
+#include <psp2/io/fcntl.h>
+#include <psp2/io/dirent.h>
+#include <psp2/io/stat.h>
+#include <psp2/kernel/clib.h>
+#include <psp2/kernel/processmgr.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+std::map<std::string, std::string> fake_io_files;
+std::function<void(const std::string& path)> fake_io_before_remove;
+
+struct FakeFd {
+    std::string path;
+    int flags;
+    size_t pos;
+};
+
+static std::map<SceUID, FakeFd> s_fds;
+static std::map<SceUID, std::vector<std::string>> s_dirs;  // names still to be read
+static SceUID s_next_fd = 1;
+
+void fake_io_reset() {
+    fake_io_files.clear();
+    fake_io_before_remove = nullptr;
+    s_fds.clear();
+    s_dirs.clear();
+}
+
+SceUID sceIoOpen(const char* file, int flags, SceMode) {
+    auto it = fake_io_files.find(file);
+    if (it == fake_io_files.end()) {
+        if (!(flags & SCE_O_CREAT)) {
+            return -1;
+        }
+        it = fake_io_files.insert(std::make_pair(std::string(file), std::string())).first;
+    }
+    if (flags & SCE_O_TRUNC) {
+        it->second.clear();
+    }
+    FakeFd fd = { file, flags, 0 };
+    s_fds[s_next_fd] = fd;
+    return s_next_fd++;
+}
+
+int sceIoClose(SceUID fd) {
+    return s_fds.erase(fd) ? 0 : -1;
+}
+
+int sceIoRead(SceUID fd, void* data, SceSize size) {
+    auto it = s_fds.find(fd);
+    if (it == s_fds.end()) {
+        return -1;
+    }
+    const std::string& content = fake_io_files[it->second.path];
+    size_t count = it->second.pos < content.size() ? std::min((size_t)size, content.size() - it->second.pos) : 0;
+    memcpy(data, content.data() + it->second.pos, count);
+    it->second.pos += count;
+    return (int)count;
+}
+
+int sceIoWrite(SceUID fd, const void* data, SceSize size) {
+    auto it = s_fds.find(fd);
+    if (it == s_fds.end()) {
+        return -1;
+    }
+    std::string& content = fake_io_files[it->second.path];
+    if (it->second.flags & SCE_O_APPEND) {
+        it->second.pos = content.size();
+    }
+    if (content.size() < it->second.pos + size) {
+        content.resize(it->second.pos + size);
+    }
+    memcpy(&content[it->second.pos], data, size);
+    it->second.pos += size;
+    return (int)size;
+}
+
+SceOff sceIoLseek(SceUID fd, SceOff offset, int whence) {
+    auto it = s_fds.find(fd);
+    if (it == s_fds.end()) {
+        return -1;
+    }
+    SceOff base = 0;
+    if (whence == SCE_SEEK_CUR) {
+        base = (SceOff)it->second.pos;
+    } else if (whence == SCE_SEEK_END) {
+        base = (SceOff)fake_io_files[it->second.path].size();
+    }
+    it->second.pos = (size_t)(base + offset);
+    return (SceOff)it->second.pos;
+}
+
+int sceIoSyncByFd(SceUID fd, int) {
+    return s_fds.count(fd) ? 0 : -1;
+}
+
+int sceIoRemove(const char* file) {
+    if (fake_io_before_remove) {
+        fake_io_before_remove(file);
+    }
+    return fake_io_files.erase(file) ? 0 : -1;
+}
+
+// Like the Vita, refuses to replace an existing file
+int sceIoRename(const char* oldname, const char* newname) {
+    auto it = fake_io_files.find(oldname);
+    if (it == fake_io_files.end() || fake_io_files.count(newname)) {
+        return -1;
+    }
+    std::string content = std::move(it->second);
+    fake_io_files.erase(it);
+    fake_io_files[newname] = std::move(content);
+    return 0;
+}
+
+SceUID sceIoDopen(const char* dirname) {
+    std::string prefix = std::string(dirname) + "/";
+    std::vector<std::string> names;
+    for (const auto& file : fake_io_files) {
+        if (file.first.compare(0, prefix.size(), prefix) == 0 && file.first.find('/', prefix.size()) == std::string::npos) {
+            names.push_back(file.first.substr(prefix.size()));
+        }
+    }
+    s_dirs[s_next_fd] = names;
+    return s_next_fd++;
+}
+
+int sceIoDread(SceUID fd, SceIoDirent* dir) {
+    auto it = s_dirs.find(fd);
+    if (it == s_dirs.end()) {
+        return -1;
+    }
+    if (it->second.empty()) {
+        return 0;
+    }
+    snprintf(dir->d_name, sizeof(dir->d_name), "%s", it->second.front().c_str());
+    it->second.erase(it->second.begin());
+    return 1;
+}
+
+int sceIoDclose(SceUID fd) {
+    return s_dirs.erase(fd) ? 0 : -1;
+}
+
+int sceIoMkdir(const char*, SceMode) {
+    return 0;
+}
+
+int sceClibPrintf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int result = vprintf(format, args);
+    va_end(args);
+    return result;
+}
+
+SceUInt64 sceKernelGetProcessTimeWide(void) {
+    return (SceUInt64)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
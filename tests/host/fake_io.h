@@ -0,0 +1,22 @@
+#ifndef FAKE_IO_H
+#define FAKE_IO_H
+
+#include <string>
+#include <map>
+#include <functional>
+
+// In-memory stand-in for the sceIo calls, so persistence can be tested on
+// the host. Files are keyed by their full path; directories aren't tracked,
+// so listing one returns the files whose paths lie directly under it.
+
+// Everything currently on the "card"
+extern std::map<std::string, std::string> fake_io_files;
+
+// Called with the path at the start of every sceIoRemove, before anything is
+// removed, so a test can copy fake_io_files as a crash would have left them
+extern std::function<void(const std::string& path)> fake_io_before_remove;
+
+// Drops every file and hook
+void fake_io_reset();
+
+#endif
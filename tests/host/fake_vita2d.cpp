@@ -0,0 +1,107 @@
+#include <vita2d.h>
+#include "fake_vita2d.h"
+#include <vector>
+
+// vita2d for host tests that draw. Nothing reaches a screen: textures only
+// know their size, PGF text is 10 px per code point on 20 px lines, and the
+// drawing calls are only counted.
+
+struct vita2d_texture {
+    unsigned int width;
+    unsigned int height;
+    std::vector<unsigned int> pixels;
+};
+
+FakeVita2dCalls fake_vita2d_calls;
+
+static vita2d_texture* create(unsigned int w, unsigned int h) {
+    fake_vita2d_calls.textures_created++;
+    vita2d_texture* texture = new vita2d_texture;
+    texture->width = w;
+    texture->height = h;
+    texture->pixels.assign((size_t)w * h, 0);
+    return texture;
+}
+
+void vita2d_start_drawing(void) {}
+void vita2d_start_drawing_advanced(vita2d_texture*, unsigned int) {}
+void vita2d_end_drawing(void) {}
+void vita2d_swap_buffers(void) {}
+void vita2d_wait_rendering_done(void) {}
+void vita2d_clear_screen(void) {}
+void vita2d_set_clear_color(unsigned int) {}
+void vita2d_enable_clipping(void) {}
+void vita2d_disable_clipping(void) {}
+void vita2d_set_clip_rectangle(int, int, int, int) {}
+void vita2d_draw_rectangle(float, float, float, float, unsigned int) {
+    fake_vita2d_calls.rectangles++;
+}
+
+vita2d_texture* vita2d_create_empty_texture(unsigned int w, unsigned int h) {
+    return create(w, h);
+}
+
+vita2d_texture* vita2d_create_empty_texture_rendertarget(unsigned int w, unsigned int h, SceGxmTextureFormat) {
+    return create(w, h);
+}
+
+// Icons are all 32x32
+vita2d_texture* vita2d_load_PNG_file(const char*) {
+    return create(32, 32);
+}
+
+void vita2d_free_texture(vita2d_texture* texture) {
+    delete texture;
+}
+
+unsigned int vita2d_texture_get_width(const vita2d_texture* texture) {
+    return texture->width;
+}
+
+unsigned int vita2d_texture_get_height(const vita2d_texture* texture) {
+    return texture->height;
+}
+
+unsigned int vita2d_texture_get_stride(const vita2d_texture* texture) {
+    return texture->width * 4;
+}
+
+void* vita2d_texture_get_datap(const vita2d_texture* texture) {
+    return (void*)texture->pixels.data();
+}
+
+void vita2d_draw_texture_tint_scale(const vita2d_texture*, float, float, float, float, unsigned int) {
+    fake_vita2d_calls.texture_quads++;
+}
+
+void vita2d_draw_texture_tint_part_scale(const vita2d_texture*, float, float, float, float, float, float, float, float, unsigned int) {
+    fake_vita2d_calls.texture_quads++;
+}
+
+int vita2d_pgf_draw_text(vita2d_pgf*, int, int, unsigned int, float, const char*) {
+    fake_vita2d_calls.text++;
+    return 0;
+}
+
+int vita2d_pgf_text_width(vita2d_pgf*, float scale, const char* text) {
+    int widest = 0;
+    int width = 0;
+    for (const char* p = text; *p; p++) {
+        if (*p == '\n') {
+            widest = width > widest ? width : widest;
+            width = 0;
+        } else if ((*p & 0xC0) != 0x80) {
+            width += 10;
+        }
+    }
+    widest = width > widest ? width : widest;
+    return (int)(widest * scale);
+}
+
+int vita2d_pgf_text_height(vita2d_pgf*, float scale, const char* text) {
+    int lines = 1;
+    for (const char* p = text; *p; p++) {
+        if (*p == '\n') lines++;
+    }
+    return (int)(lines * 20 * scale);
+}
@@ -0,0 +1,18 @@
+#ifndef FAKE_VITA2D_H
+#define FAKE_VITA2D_H
+
+// Calls made to the fake vita2d in host/fake_vita2d.cpp, so tests can count
+// what a frame costs in draw calls
+
+struct FakeVita2dCalls {
+    unsigned int rectangles = 0;
+    unsigned int texture_quads = 0;    // vita2d_draw_texture_tint_scale and _part_scale
+    unsigned int text = 0;
+    unsigned int textures_created = 0;
+
+    unsigned int draws() const { return rectangles + texture_quads + text; }
+};
+
+extern FakeVita2dCalls fake_vita2d_calls;
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef HOST_PSP2_IO_DIRENT_H
+#define HOST_PSP2_IO_DIRENT_H
+
+#include <psp2/types.h>
+
+typedef struct SceIoDirent {
+    char d_name[256];
+} SceIoDirent;
+
+// Lists the files directly under a directory of the fake_io.cpp file system
+SceUID sceIoDopen(const char* dirname);
+int sceIoDread(SceUID fd, SceIoDirent* dir);
+int sceIoDclose(SceUID fd);
+
+#endif
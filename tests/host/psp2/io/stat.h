@@ -0,0 +1,8 @@
+#ifndef HOST_PSP2_IO_STAT_H
+#define HOST_PSP2_IO_STAT_H
+
+#include <psp2/types.h>
+
+int sceIoMkdir(const char* dir, SceMode mode);
+
+#endif
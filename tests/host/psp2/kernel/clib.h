@@ -0,0 +1,6 @@
+#ifndef HOST_PSP2_KERNEL_CLIB_H
+#define HOST_PSP2_KERNEL_CLIB_H
+
+int sceClibPrintf(const char* format, ...);
+
+#endif
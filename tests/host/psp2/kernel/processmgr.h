@@ -0,0 +1,8 @@
+#ifndef HOST_PSP2_KERNEL_PROCESSMGR_H
+#define HOST_PSP2_KERNEL_PROCESSMGR_H
+
+#include <psp2/types.h>
+
+SceUInt64 sceKernelGetProcessTimeWide(void);
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef HOST_PSP2_TYPES_H
+#define HOST_PSP2_TYPES_H
+
+// The few SDK types the host-tested sources use
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int SceUID;
+typedef int64_t SceOff;
+typedef int SceMode;
+typedef unsigned int SceSize;
+typedef uint64_t SceUInt64;
+typedef int32_t SceInt32;
+typedef uint32_t SceUInt32;
+
+#endif
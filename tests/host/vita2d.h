@@ -0,0 +1,52 @@
+#ifndef HOST_VITA2D_H
+#define HOST_VITA2D_H
+
+// Just enough of vita2d for the host-tested sources to compile. Textures and
+// fonts are opaque; fake_vita2d.cpp implements the calls for tests that draw.
+
+#include <psp2/types.h>
+
+#define RGBA8(r, g, b, a) ((((a) & 0xFF) << 24) | (((b) & 0xFF) << 16) | (((g) & 0xFF) << 8) | (((r) & 0xFF) << 0))
+
+typedef struct vita2d_texture vita2d_texture;
+typedef struct vita2d_pgf vita2d_pgf;
+
+typedef enum {
+    SCE_GXM_TEXTURE_FORMAT_A8B8G8R8
+} SceGxmTextureFormat;
+
+enum {
+    SCE_GXM_SCENE_FRAGMENT_SET_DEPENDENCY = 0x00000001,
+    SCE_GXM_SCENE_VERTEX_WAIT_FOR_DEPENDENCY = 0x00000002
+};
+
+void vita2d_start_drawing(void);
+void vita2d_start_drawing_advanced(vita2d_texture* target, unsigned int flags);
+void vita2d_end_drawing(void);
+void vita2d_swap_buffers(void);
+void vita2d_wait_rendering_done(void);
+void vita2d_clear_screen(void);
+void vita2d_set_clear_color(unsigned int color);
+void vita2d_enable_clipping(void);
+void vita2d_disable_clipping(void);
+void vita2d_set_clip_rectangle(int x_min, int y_min, int x_max, int y_max);
+
+void vita2d_draw_rectangle(float x, float y, float w, float h, unsigned int color);
+
+vita2d_texture* vita2d_create_empty_texture(unsigned int w, unsigned int h);
+vita2d_texture* vita2d_create_empty_texture_rendertarget(unsigned int w, unsigned int h, SceGxmTextureFormat format);
+vita2d_texture* vita2d_load_PNG_file(const char* filename);
+void vita2d_free_texture(vita2d_texture* texture);
+unsigned int vita2d_texture_get_width(const vita2d_texture* texture);
+unsigned int vita2d_texture_get_height(const vita2d_texture* texture);
+unsigned int vita2d_texture_get_stride(const vita2d_texture* texture);
+void* vita2d_texture_get_datap(const vita2d_texture* texture);
+void vita2d_draw_texture_tint_scale(const vita2d_texture* texture, float x, float y, float x_scale, float y_scale, unsigned int color);
+void vita2d_draw_texture_tint_part_scale(const vita2d_texture* texture, float x, float y, float tex_x, float tex_y,
+                                         float tex_w, float tex_h, float x_scale, float y_scale, unsigned int color);
+
+int vita2d_pgf_draw_text(vita2d_pgf* font, int x, int y, unsigned int color, float scale, const char* text);
+int vita2d_pgf_text_width(vita2d_pgf* font, float scale, const char* text);
+int vita2d_pgf_text_height(vita2d_pgf* font, float scale, const char* text);
+
+#endif
@@ -0,0 +1,73 @@
+#include "test.h"
+#include "image_resize.h"
+#include "image_utils.h"
+#include <cmath>
+
+// What image_max_edge buys for a photo upload: for each size, the time to
+// downscale a camera frame, JPEG+base64 encode it into the request body,
+// and the body's size with the time it takes to send at an assumed Wi-Fi
+// rate. The frame is synthetic, smooth shading with sensor-like noise, so
+// the encoded sizes are only indicative of real photos.
+
+// Sustained upload rate assumed for the Vita's Wi-Fi
+#define UPLOAD_BYTES_PER_SEC (512 * 1024)
+
+static std::vector<unsigned char> make_frame(int width, int height) {
+    std::vector<unsigned char> rgba((size_t)width * height * 4);
+    unsigned int noise = 12345;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            unsigned char* p = &rgba[((size_t)y * width + x) * 4];
+            for (int c = 0; c < 3; c++) {
+                noise = noise * 1103515245 + 12345;
+                float shade = 128 + 80 * sinf(x * 0.02f + c) * cosf(y * 0.03f - c);
+                p[c] = (unsigned char)std::max(0.0f, std::min(255.0f, shade + (int)((noise >> 16) % 17) - 8));
+            }
+            p[3] = 255;
+        }
+    }
+    return rgba;
+}
+
+static void run(int width, int height) {
+    const int quality = 80;
+    const int runs = 10;
+    std::vector<unsigned char> frame = make_frame(width, height);
+    printf("%dx%d frame, JPEG q=%d:\n", width, height, quality);
+
+    const int edges[] = {0, 512, 384, 256};
+    for (int max_edge : edges) {
+        int out_width, out_height;
+        image_fit_size(width, height, max_edge, out_width, out_height);
+        CHECK(std::max(out_width, out_height) <= (max_edge ? max_edge : std::max(width, height)));
+
+        std::vector<unsigned char> resized;
+        double start = now_us();
+        for (int i = 0; i < runs; i++) {
+            if (max_edge) {
+                image_downscale_rgba(frame.data(), width, height, width * 4, resized, out_width, out_height);
+            } else {
+                resized = frame;
+            }
+        }
+        double resize_us = (now_us() - start) / runs;
+
+        std::string body;
+        start = now_us();
+        for (int i = 0; i < runs; i++) {
+            body.clear();
+            CHECK(append_rgba_as_base64_jpeg(body, resized.data(), out_width, out_height, quality));
+        }
+        double encode_us = (now_us() - start) / runs;
+
+        printf("  max_edge %3d -> %3dx%-3d resize %6.0f us, encode %6.0f us, %4u KB base64, ~%4.0f ms to send\n",
+               max_edge, out_width, out_height, resize_us, encode_us, (unsigned int)(body.size() / 1024),
+               body.size() * 1000.0 / UPLOAD_BYTES_PER_SEC);
+    }
+}
+
+int main() {
+    run(640, 480);
+    run(960, 544);
+    return test_result();
+}
@@ -0,0 +1,222 @@
+// The image saver over an in-memory ImageFileSystem: photos and thumbnails
+// only appear under their names through a rename of a complete .tmp file,
+// a failed write or rename leaves nothing behind, leftovers from a crash
+// are removed on start, and a failed save stops the message pointing at
+// the missing file.
+
+#include "image_saver.h"
+#include "image_utils.h"
+#include "test.h"
+#include <map>
+#include <mutex>
+#include <thread>
+
+static std::mutex s_fs_mutex;
+static std::map<std::string, std::string> s_files;
+static std::vector<std::string> s_ops;
+static std::string s_fail_write;   // this path gets half its data, then the write fails
+static std::string s_fail_rename;  // renames to this path fail
+
+static ImageFileSystem memory_file_system() {
+    ImageFileSystem fs;
+    fs.write_file = [](const std::string& path, const void* data, size_t len) {
+        std::lock_guard<std::mutex> lock(s_fs_mutex);
+        s_ops.push_back("write " + path);
+        bool fail = path == s_fail_write;
+        s_files[path] = std::string(static_cast<const char*>(data), fail ? len / 2 : len);
+        return !fail;
+    };
+    fs.rename = [](const std::string& from, const std::string& to) {
+        std::lock_guard<std::mutex> lock(s_fs_mutex);
+        s_ops.push_back("rename " + from + " " + to);
+        if (to == s_fail_rename || !s_files.count(from)) {
+            return false;
+        }
+        s_files[to] = s_files[from];
+        s_files.erase(from);
+        return true;
+    };
+    fs.remove = [](const std::string& path) {
+        std::lock_guard<std::mutex> lock(s_fs_mutex);
+        s_ops.push_back("remove " + path);
+        s_files.erase(path);
+    };
+    fs.list_dir = [](const std::string& dir) {
+        std::lock_guard<std::mutex> lock(s_fs_mutex);
+        std::vector<std::string> names;
+        for (const auto& file : s_files) {
+            if (file.first.compare(0, dir.size() + 1, dir + "/") == 0) {
+                names.push_back(file.first.substr(dir.size() + 1));
+            }
+        }
+        return names;
+    };
+    return fs;
+}
+
+static void reset_fs() {
+    std::lock_guard<std::mutex> lock(s_fs_mutex);
+    s_files.clear();
+    s_ops.clear();
+    s_fail_write.clear();
+    s_fail_rename.clear();
+}
+
+// Saves a 16x12 gradient and waits for its result
+static ImageSaveResult save(const std::string& path, const std::string& thumbnail_path, size_t pixel_bytes = 16 * 12 * 4) {
+    std::vector<unsigned char> rgba(pixel_bytes);
+    for (size_t i = 0; i < rgba.size(); i++) {
+        rgba[i] = (unsigned char)(i * 7);
+    }
+    int id = image_saver_submit(path, thumbnail_path, 6, std::move(rgba), 16, 12);
+
+    std::vector<ImageSaveResult> results;
+    double deadline = now_us() + 5e6;
+    while (now_us() < deadline) {
+        image_saver_poll(results);
+        if (!results.empty()) {
+            CHECK_EQ(results.size(), 1u);
+            CHECK_EQ(results[0].id, id);
+            CHECK_EQ(results[0].path, path);
+            return results[0];
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    fprintf(stderr, "no result for %s\n", path.c_str());
+    s_test_failures++;
+    return ImageSaveResult();
+}
+
+static bool is_png(const std::string& data) {
+    return data.compare(0, 8, "\x89PNG\r\n\x1a\n") == 0;
+}
+
+// Big-endian height from the PNG header
+static int png_height(const std::string& data) {
+    return data.size() < 24 ? 0 : (unsigned char)data[22] << 8 | (unsigned char)data[23];
+}
+
+static void test_writes_through_tmp_and_rename() {
+    reset_fs();
+    ImageSaveResult result = save("img/a.png", "img/a.thumb.png");
+    CHECK(result.ok);
+
+    std::vector<std::string> expected = {
+        "write img/a.png.tmp", "rename img/a.png.tmp img/a.png",
+        "write img/a.thumb.png.tmp", "rename img/a.thumb.png.tmp img/a.thumb.png",
+    };
+    CHECK(s_ops == expected);
+    CHECK_EQ(s_files.size(), 2u);
+    CHECK(is_png(s_files["img/a.png"]));
+    CHECK(is_png(s_files["img/a.thumb.png"]));
+    CHECK_EQ(png_height(s_files["img/a.png"]), 12);
+    CHECK_EQ(png_height(s_files["img/a.thumb.png"]), 6);
+}
+
+static void test_failed_write_leaves_nothing() {
+    reset_fs();
+    s_fail_write = "img/b.png.tmp";
+    ImageSaveResult result = save("img/b.png", "img/b.thumb.png");
+    CHECK(!result.ok);
+
+    // The partial .tmp is removed, and no thumbnail is made for a photo that isn't there
+    std::vector<std::string> expected = { "write img/b.png.tmp", "remove img/b.png.tmp" };
+    CHECK(s_ops == expected);
+    CHECK(s_files.empty());
+}
+
+static void test_failed_rename_leaves_nothing() {
+    reset_fs();
+    s_fail_rename = "img/c.png";
+    CHECK(!save("img/c.png", "").ok);
+    CHECK(s_files.empty());
+    CHECK_EQ(s_ops.back(), "remove img/c.png.tmp");
+}
+
+// A missing thumbnail is made again on first draw, so the photo still counts as saved
+static void test_failed_thumbnail_is_not_fatal() {
+    reset_fs();
+    s_fail_write = "img/d.thumb.png.tmp";
+    CHECK(save("img/d.png", "img/d.thumb.png").ok);
+    CHECK_EQ(s_files.size(), 1u);
+    CHECK(s_files.count("img/d.png") == 1);
+}
+
+static void test_bad_pixels_are_rejected() {
+    reset_fs();
+    CHECK(!save("img/e.png", "", 100).ok);
+    CHECK(s_ops.empty());
+}
+
+static void test_remove_partials() {
+    reset_fs();
+    s_files["img/f.png.tmp"] = "half";
+    s_files["img/g.thumb.png.tmp"] = "half";
+    s_files["img/h.png"] = "whole";
+    s_files["other/i.png.tmp"] = "half";
+    image_saver_remove_partials("img");
+    CHECK_EQ(s_files.size(), 2u);
+    CHECK(s_files.count("img/h.png") == 1);
+    CHECK(s_files.count("other/i.png.tmp") == 1);
+}
+
+static void test_apply_result() {
+    std::vector<ChatSession> sessions(1);
+    ChatSession& session = sessions[0];
+    session.messages.resize(3);
+    session.messages[0].image_path = "img/old.png";
+    session.messages[1].image = vita2d_create_empty_texture(16, 12);
+    session.messages[1].image_path = "img/j.png";
+    session.messages[2].image = vita2d_create_empty_texture(16, 12);
+    session.messages[2].image_path = "img/k.png";
+    for (auto& msg : session.messages) {
+        msg.dirty = false;
+    }
+    session.dirty = false;
+
+    // Unrelated results change nothing
+    ImageSaveResult result;
+    result.path = "img/old.png";
+    CHECK(!apply_image_save_result(sessions, result));
+    CHECK_EQ(session.messages[0].image_path, "img/old.png");
+
+    // A saved photo is drawn from its thumbnail from now on
+    result.path = "img/j.png";
+    result.ok = true;
+    CHECK(!apply_image_save_result(sessions, result));
+    CHECK(session.messages[1].image == NULL);
+    CHECK_EQ(session.messages[1].image_path, "img/j.png");
+    CHECK_EQ(texture_cache_pending_frees(), 1u);
+    CHECK(!session.dirty);
+
+    // A failed one stays on screen from memory, but the history forgets the file
+    result.path = "img/k.png";
+    result.ok = false;
+    CHECK(apply_image_save_result(sessions, result));
+    CHECK(session.messages[2].image != NULL);
+    CHECK(session.messages[2].image_path.empty());
+    CHECK(session.messages[2].dirty);
+    CHECK(session.dirty);
+
+    texture_cache_collect();
+    vita2d_free_texture(session.messages[2].image);
+}
+
+int main() {
+    TextureAllocator allocator;
+    allocator.free = vita2d_free_texture;
+    texture_cache_init(allocator, 1 << 20);
+    CHECK(image_saver_start(memory_file_system()));
+
+    test_writes_through_tmp_and_rename();
+    test_failed_write_leaves_nothing();
+    test_failed_rename_leaves_nothing();
+    test_failed_thumbnail_is_not_fatal();
+    test_bad_pixels_are_rejected();
+    test_remove_partials();
+    test_apply_result();
+
+    image_saver_stop();
+    texture_cache_shutdown();
+    return test_result();
+}
@@ -0,0 +1,101 @@
+// Journal framing: whole records come back, and reading stops at the first
+// record that is cut short or fails its checksum.
+
+#include "journal.h"
+#include "test.h"
+
+static std::string three_records(std::vector<size_t>& ends) {
+    std::string data;
+    const char* payloads[] = { "{\"session\":1,\"index\":0}", "", "{\"session\":2,\"index\":7,\"text\":\"\xc3\xa9\"}" };
+    for (const char* payload : payloads) {
+        journal_append_record(data, payload);
+        ends.push_back(data.size());
+    }
+    return data;
+}
+
+static void test_whole_records() {
+    std::vector<size_t> ends;
+    std::string data = three_records(ends);
+    std::vector<std::string> records;
+    CHECK_EQ(journal_read_records(data.data(), data.size(), records), data.size());
+    CHECK_EQ(records.size(), 3u);
+    if (records.size() == 3) {
+        CHECK_EQ(records[0], "{\"session\":1,\"index\":0}");
+        CHECK(records[1].empty());
+        CHECK_EQ(records[2], "{\"session\":2,\"index\":7,\"text\":\"\xc3\xa9\"}");
+    }
+}
+
+// Every possible cut keeps exactly the records that ended before it
+static void test_truncated() {
+    std::vector<size_t> ends;
+    std::string data = three_records(ends);
+    for (size_t cut = 0; cut < data.size(); cut++) {
+        size_t expected_records = 0;
+        size_t expected_valid = 0;
+        while (expected_records < ends.size() && ends[expected_records] <= cut) {
+            expected_valid = ends[expected_records++];
+        }
+
+        std::vector<std::string> records;
+        CHECK_EQ(journal_read_records(data.data(), cut, records), expected_valid);
+        CHECK_EQ(records.size(), expected_records);
+    }
+}
+
+// A cut inside the 8-byte header of the second record
+static void test_truncated_mid_header() {
+    std::vector<size_t> ends;
+    std::string data = three_records(ends);
+    for (size_t header_bytes = 1; header_bytes < 8; header_bytes++) {
+        std::vector<std::string> records;
+        CHECK_EQ(journal_read_records(data.data(), ends[0] + header_bytes, records), ends[0]);
+        CHECK_EQ(records.size(), 1u);
+    }
+}
+
+static void test_crc_mismatch() {
+    std::vector<size_t> ends;
+    std::string data = three_records(ends);
+
+    // A flipped payload byte in the last record drops just that record
+    std::string corrupt = data;
+    corrupt[ends[2] - 1] ^= 0x01;
+    std::vector<std::string> records;
+    CHECK_EQ(journal_read_records(corrupt.data(), corrupt.size(), records), ends[1]);
+    CHECK_EQ(records.size(), 2u);
+
+    // A bad stored checksum in the first record drops everything after it too
+    corrupt = data;
+    corrupt[4] ^= 0x80;
+    records.clear();
+    CHECK_EQ(journal_read_records(corrupt.data(), corrupt.size(), records), 0u);
+    CHECK(records.empty());
+
+    // So does a length that runs past the end of the file
+    corrupt = data;
+    corrupt[ends[0]] = (char)0xFF;
+    records.clear();
+    CHECK_EQ(journal_read_records(corrupt.data(), corrupt.size(), records), ends[0]);
+    CHECK_EQ(records.size(), 1u);
+}
+
+// A length past JOURNAL_MAX_RECORD is rejected without reading it
+static void test_oversized_length() {
+    std::string data;
+    journal_append_record(data, "ok");
+    data += std::string("\xff\xff\xff\x7f\0\0\0\0", 8);
+    std::vector<std::string> records;
+    CHECK_EQ(journal_read_records(data.data(), data.size(), records), data.size() - 8);
+    CHECK_EQ(records.size(), 1u);
+}
+
+int main() {
+    test_whole_records();
+    test_truncated();
+    test_truncated_mid_header();
+    test_crc_mismatch();
+    test_oversized_length();
+    return test_result();
+}
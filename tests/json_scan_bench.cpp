@@ -0,0 +1,86 @@
+#include "test.h"
+#include "stream.h"
+#include <jsoncpp/json/json.h>
+#include <memory>
+#include <vector>
+
+// Reply throughput of the streaming scanner against parsing each SSE event
+// into a jsoncpp document, as stream.cpp did before. The recording is the
+// events of openai_stream.sse repeated into a long reply, read in 1 KB
+// chunks like the HTTP reader does.
+
+static std::string long_recording(size_t events) {
+    std::string sample = test_data("openai_stream.sse");
+    std::vector<std::string> lines;
+    std::istringstream in(sample);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, 6, "data: ") == 0 && line.find("\"content\":\"") != std::string::npos) {
+            lines.push_back(line);
+        }
+    }
+
+    std::string body;
+    for (size_t i = 0; i < events; i++) {
+        body += lines[i % lines.size()];
+        body += "\n\n";
+    }
+    body += "data: [DONE]\n\n";
+    return body;
+}
+
+static size_t run_scanner(const std::string& body) {
+    StreamState state;
+    for (size_t i = 0; i < body.size(); i += 1024) {
+        stream_feed(state, body.data() + i, std::min<size_t>(1024, body.size() - i));
+    }
+    stream_finish(state);
+    return state.content.size();
+}
+
+static size_t run_jsoncpp(const std::string& body) {
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    std::string content;
+    std::string line;
+    for (size_t i = 0; i < body.size(); i += 1024) {
+        const char* chunk = body.data() + i;
+        size_t len = std::min<size_t>(1024, body.size() - i);
+        for (size_t k = 0; k < len; k++) {
+            if (chunk[k] != '\n') {
+                line += chunk[k];
+                continue;
+            }
+            if (line.compare(0, 6, "data: ") == 0 && line.compare(6, 6, "[DONE]") != 0) {
+                Json::Value root;
+                std::string errors;
+                if (reader->parse(line.data() + 6, line.data() + line.size(), &root, &errors)) {
+                    const Json::Value& delta = root["choices"][0]["delta"];
+                    if (delta.isMember("content")) content += delta["content"].asString();
+                }
+            }
+            line.clear();
+        }
+    }
+    return content.size();
+}
+
+template <typename Fn>
+static void bench(const char* name, const std::string& body, Fn fn) {
+    const int runs = 20;
+    size_t content = 0;
+    double start = now_us();
+    for (int i = 0; i < runs; i++) {
+        content = fn(body);
+    }
+    double us = (now_us() - start) / runs;
+    printf("%-8s %8.0f us per reply, %6.1f MB/s (%zu bytes of content)\n", name, us, body.size() / us, content);
+}
+
+int main() {
+    std::string body = long_recording(5000);
+    printf("%zu byte recording, 5000 events\n", body.size());
+    bench("scanner", body, run_scanner);
+    bench("jsoncpp", body, run_jsoncpp);
+    return test_result();
+}
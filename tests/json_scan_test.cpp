@@ -0,0 +1,134 @@
+#include "test.h"
+#include "json_scan.h"
+#include "stream.h"
+#include <vector>
+
+// Each corpus file is fed whole, a byte at a time and split in two at every
+// offset, so multi-byte UTF-8, escapes and \uXXXX sequences land on chunk
+// boundaries.
+
+struct StreamCase {
+    const char* file;
+    const char* content;
+    const char* reasoning;
+    const char* finish_reason;
+    int prompt_tokens;
+    int completion_tokens;
+};
+
+static const StreamCase STREAM_CASES[] = {
+    { "openai_stream.sse", "Héllo 日本語 😀\n\"quoted\" back\\slash tab\t café 😀 日", "", "stop", 12, 34 },
+    { "llamacpp_reasoning.sse", "Answer: 42", "Let me think about über.", "length", -1, -1 },
+    { "think_tags.sse", "done", "plan ñ", "", -1, -1 },
+    { "plain_body.json", "Plain reply é ✓", "hm \"ok\"", "stop", 7, 9 },
+    { "error_body.json", "Error: Invalid API key: \"sk-…\"", "", "", -1, -1 },
+};
+
+static StreamState run_stream(const std::vector<std::string>& chunks) {
+    StreamState state;
+    for (const auto& chunk : chunks) {
+        stream_feed(state, chunk.data(), chunk.size());
+    }
+    stream_finish(state);
+    return state;
+}
+
+static void check_stream(const StreamCase& test, const std::vector<std::string>& chunks, const char* how) {
+    StreamState state = run_stream(chunks);
+    bool ok = state.content == test.content && state.reasoning == test.reasoning &&
+              state.finish_reason == test.finish_reason &&
+              state.prompt_tokens == test.prompt_tokens && state.completion_tokens == test.completion_tokens;
+    if (!ok) {
+        fprintf(stderr, "%s (%s): content \"%s\" reasoning \"%s\" finish \"%s\" tokens %d/%d\n", test.file, how,
+                state.content.c_str(), state.reasoning.c_str(), state.finish_reason.c_str(),
+                state.prompt_tokens, state.completion_tokens);
+        s_test_failures++;
+    }
+}
+
+static void test_stream_corpus() {
+    for (const auto& test : STREAM_CASES) {
+        std::string body = test_data(test.file);
+
+        check_stream(test, std::vector<std::string>{ body }, "whole");
+
+        std::vector<std::string> bytes;
+        for (char c : body) bytes.push_back(std::string(1, c));
+        check_stream(test, bytes, "byte at a time");
+
+        for (size_t split = 1; split < body.size(); split++) {
+            check_stream(test, std::vector<std::string>{ body.substr(0, split), body.substr(split) }, "split");
+        }
+    }
+}
+
+static std::vector<std::string> scan_models(const std::vector<std::string>& chunks, bool& complete) {
+    std::vector<std::string> models;
+    JsonScanner scanner;
+    JsonScanHandler handler;
+    handler.want = [](const JsonScanner& s) { return json_scan_at(s, "data.*.id"); };
+    handler.on_value = [&models](const JsonScanner&, JsonScanKind kind, const std::string& value) {
+        if (kind == JsonScanKind::STRING) models.push_back(value);
+    };
+    bool ok = true;
+    for (const auto& chunk : chunks) {
+        ok = ok && json_scan_feed(scanner, chunk.data(), chunk.size(), handler);
+    }
+    complete = ok && json_scan_finish(scanner, handler);
+    return models;
+}
+
+static void test_models() {
+    std::string body = test_data("models.json");
+    for (size_t split = 0; split <= body.size(); split++) {
+        bool complete;
+        std::vector<std::string> models = scan_models({ body.substr(0, split), body.substr(split) }, complete);
+        CHECK(complete);
+        CHECK_EQ(models.size(), 3u);
+        if (models.size() == 3) {
+            CHECK_EQ(models[0], "gpt-4o-mini");
+            CHECK_EQ(models[1], "qwen3:8b");
+            CHECK_EQ(models[2], "llama-3.1-é");
+        }
+    }
+}
+
+static bool scans(const std::string& json) {
+    JsonScanner scanner;
+    JsonScanHandler handler;
+    handler.want = [](const JsonScanner&) { return true; };
+    handler.on_value = [](const JsonScanner&, JsonScanKind, const std::string&) {};
+    return json_scan_feed(scanner, json.data(), json.size(), handler) && json_scan_finish(scanner, handler);
+}
+
+static void test_malformed() {
+    CHECK(scans("{\"a\": [1, -2.5e-3, true, false, null, \"x\"]}"));
+    CHECK(!scans("{\"a\": }"));
+    CHECK(!scans("{\"a\" 1}"));
+    CHECK(!scans("[1, 2"));
+    CHECK(!scans("{\"a\": \"unterminated}"));
+    CHECK(!scans("{\"a\": \"\\q\"}"));
+    CHECK(!scans("{\"a\": \"\\u12G4\"}"));
+    CHECK(!scans("{} {}"));
+    CHECK(!scans("tru"));
+}
+
+static void test_unicode_escapes() {
+    std::string value;
+    JsonScanner scanner;
+    JsonScanHandler handler;
+    handler.want = [](const JsonScanner&) { return true; };
+    handler.on_value = [&value](const JsonScanner&, JsonScanKind, const std::string& v) { value = v; };
+    std::string json = "\"\\u0041\\u00e9\\u20ac\\ud83d\\ude00\\/\\b\\f\\r\"";
+    CHECK(json_scan_feed(scanner, json.data(), json.size(), handler));
+    CHECK(json_scan_finish(scanner, handler));
+    CHECK_EQ(value, "Aé€😀/\b\f\r");
+}
+
+int main() {
+    test_stream_corpus();
+    test_models();
+    test_malformed();
+    test_unicode_escapes();
+    return test_result();
+}
@@ -0,0 +1,138 @@
+// Draw calls native_draw_backend makes, counted in the fake vita2d: circles
+// are one sprite quad and rounded rects at most three rectangles plus four
+// corner quads, with one disc sprite per whole-pixel radius. A chat frame
+// is replayed command by command to check every command it records, and
+// its totals are printed.
+
+#include "ui.h"
+#include "text_metrics.h"
+#include "text_run_cache.h"
+#include "host/fake_vita2d.h"
+#include "test.h"
+
+std::string thumbnail_path_for(const std::string& image_path) {
+    return image_path + ".thumb";
+}
+
+static DrawBackend s_native;
+
+// Draw calls for one command
+static FakeVita2dCalls draw(const DrawCommand& command) {
+    FakeVita2dCalls before = fake_vita2d_calls;
+    s_native.draw(command);
+    FakeVita2dCalls calls;
+    calls.rectangles = fake_vita2d_calls.rectangles - before.rectangles;
+    calls.texture_quads = fake_vita2d_calls.texture_quads - before.texture_quads;
+    calls.text = fake_vita2d_calls.text - before.text;
+    calls.textures_created = fake_vita2d_calls.textures_created - before.textures_created;
+    return calls;
+}
+
+static DrawCommand rounded_rect(float w, float h, float radius) {
+    DrawCommand command;
+    command.type = DRAW_ROUNDED_RECT;
+    command.x = 20;
+    command.y = 30;
+    command.w = w;
+    command.h = h;
+    command.radius = radius;
+    command.color = 0xFFFFFFFF;
+    return command;
+}
+
+static void test_primitives() {
+    // A circle is one quad; its sprite is built the first time only
+    FakeVita2dCalls calls = draw(rounded_rect(20, 20, 10));
+    CHECK_EQ(calls.draws(), 1u);
+    CHECK_EQ(calls.texture_quads, 1u);
+    CHECK_EQ(calls.textures_created, 1u);
+    CHECK_EQ(draw(rounded_rect(20, 20, 10)).textures_created, 0u);
+
+    // A bubble is three rectangles and four corners from the same sprite
+    calls = draw(rounded_rect(200, 60, 10));
+    CHECK_EQ(calls.rectangles, 3u);
+    CHECK_EQ(calls.texture_quads, 4u);
+    CHECK_EQ(calls.textures_created, 0u);
+
+    // A pill has no straight sides
+    calls = draw(rounded_rect(120, 30, 15));
+    CHECK_EQ(calls.rectangles, 1u);
+    CHECK_EQ(calls.texture_quads, 4u);
+
+    // A fractional radius, as the dropup animates, scales the next sprite down
+    calls = draw(rounded_rect(200, 60, 14.5f));
+    CHECK_EQ(calls.draws(), 7u);
+    calls = draw(rounded_rect(200, 60, 14.2f));
+    CHECK_EQ(calls.textures_created, 0u);
+
+    // Past the largest sprite, corners fall back to a rectangle per scanline
+    calls = draw(rounded_rect(300, 300, 100));
+    CHECK_EQ(calls.texture_quads, 0u);
+    CHECK(calls.rectangles > 100u);
+}
+
+static ChatSession make_session() {
+    ChatSession session;
+    session.id = 1;
+    for (int i = 0; i < 6; i++) {
+        ChatMessage message;
+        message.sender = i % 2 ? ChatMessage::LLM : ChatMessage::USER;
+        message.text = i % 2 ? "A reply that runs over a few lines of the bubble so it wraps at least twice or so." : "A question?";
+        if (i == 3) {
+            message.reasoning = "Some reasoning.";
+            message.show_reasoning = true;
+        }
+        wrap_message(NULL, message, BUBBLE_CONTENT_WIDTH);
+        session.messages.push_back(message);
+    }
+    return session;
+}
+
+static void test_chat_frame(bool models_open) {
+    ChatSession session = make_session();
+    ChatLayout layout;
+    chat_layout_update(layout, session);
+    std::vector<std::string> models = { "llama-3.1-8b", "qwen2.5-vl-7b", "gpt-4o-mini" };
+
+    std::vector<DrawCommand> commands;
+    draw_list_init(recording_draw_backend(&commands));
+    draw_ui(NULL, session.messages, layout, "Tell me more", 0, UISelection::INPUT_PILL,
+            models, 1, models_open, false, true, 255, 255, false, NULL, false, NULL, 0,
+            models_open ? models.size() * 35 + 15 : 0.0f, -1, 0.0f);
+    CHECK(!commands.empty());
+
+    FakeVita2dCalls total;
+    unsigned int rounded = 0;
+    for (const auto& command : commands) {
+        FakeVita2dCalls calls = draw(command);
+        total.rectangles += calls.rectangles;
+        total.texture_quads += calls.texture_quads;
+        total.text += calls.text;
+        if (command.type == DRAW_ROUNDED_RECT) {
+            rounded++;
+            CHECK(calls.draws() <= 7u);
+        } else {
+            CHECK_EQ(calls.draws(), 1u);
+        }
+    }
+    CHECK(rounded > 0u);
+    printf("chat frame%s: %zu commands (%u rounded) -> %u draw calls: %u rectangles, %u texture quads, %u text\n",
+           models_open ? " with the model list open" : "", commands.size(), rounded, total.draws(),
+           total.rectangles, total.texture_quads, total.text);
+}
+
+int main() {
+    text_metrics_init(native_text_metrics_source(NULL));
+    text_run_cache_init(native_text_run_backend(NULL));
+    s_native = native_draw_backend(NULL);
+
+    test_primitives();
+    test_chat_frame(false);
+    test_chat_frame(true);
+
+    draw_list_shutdown();
+    text_run_cache_shutdown();
+    cleanup_ui_textures();
+    text_metrics_shutdown();
+    return test_result();
+}
@@ -0,0 +1,173 @@
+// The network worker over a stubbed transport: streamed replies, model
+// lists delivered once, and cancelling queued, waiting and in-flight
+// requests, including stopping the worker while a request hangs.
+
+#include "net_worker.h"
+#include "test.h"
+#include <cstring>
+#include <mutex>
+#include <condition_variable>
+#include <set>
+#include <thread>
+
+// Requests whose prompt is "hang" block in the transport until aborted, like
+// a server that never answers
+static std::mutex s_stub_mutex;
+static std::condition_variable s_stub_cv;
+static std::set<int> s_aborted;
+static int s_chat_calls = 0;
+static int s_fetch_calls = 0;
+static int s_hanging_id = 0;
+
+static const char* SSE_CHUNKS[] = {
+    "data: {\"choices\":[{\"delta\":{\"content\":\"Hel\"}}]}\n\n",
+    "data: {\"choices\":[{\"delta\":{\"content\":\"lo\"}}]}\n\ndata: {\"choices\":[{\"delta\":{},",
+    "\"finish_reason\":\"stop\"}]}\n\ndata: [DONE]\n\n",
+};
+
+static NetTransport stub_transport() {
+    NetTransport transport;
+    transport.post_chat = [](const NetRequest& request, const HttpChunkCallback& on_chunk) -> std::string {
+        std::unique_lock<std::mutex> lock(s_stub_mutex);
+        s_chat_calls++;
+        if (request.prompt == "hang") {
+            s_hanging_id = request.id;
+            s_stub_cv.notify_all();
+            bool aborted = s_stub_cv.wait_for(lock, std::chrono::seconds(5), [&] { return s_aborted.count(request.id) > 0; });
+            return aborted ? "Error: cancelled" : "Error: timed out";
+        }
+        lock.unlock();
+        for (const char* chunk : SSE_CHUNKS) {
+            if (!on_chunk(chunk, strlen(chunk))) {
+                break;
+            }
+        }
+        return "";
+    };
+    transport.fetch_models = [](const NetRequest&) {
+        std::lock_guard<std::mutex> lock(s_stub_mutex);
+        s_fetch_calls++;
+        return std::vector<std::string>{"model-a", "model-b"};
+    };
+    transport.abort = [](int request_id) {
+        std::lock_guard<std::mutex> lock(s_stub_mutex);
+        s_aborted.insert(request_id);
+        s_stub_cv.notify_all();
+    };
+    return transport;
+}
+
+static void wait_until_hanging(int request_id) {
+    std::unique_lock<std::mutex> lock(s_stub_mutex);
+    s_stub_cv.wait_for(lock, std::chrono::seconds(5), [&] { return s_hanging_id == request_id; });
+    CHECK_EQ(s_hanging_id, request_id);
+}
+
+// Polls like the render thread until an event of type arrives for request_id
+// or two seconds pass. Returns every event seen meanwhile.
+static std::vector<NetEvent> poll_until(int request_id, NetEventType type) {
+    std::vector<NetEvent> seen;
+    std::vector<NetEvent> events;
+    double deadline = now_us() + 2e6;
+    while (now_us() < deadline) {
+        net_worker_poll(events);
+        seen.insert(seen.end(), events.begin(), events.end());
+        for (const auto& event : events) {
+            if (event.request_id == request_id && event.type == type) {
+                return seen;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    fprintf(stderr, "no event %d for request %d\n", (int)type, request_id);
+    s_test_failures++;
+    return seen;
+}
+
+static NetRequest chat_request(const std::string& prompt) {
+    NetRequest request;
+    request.kind = NetRequestKind::CHAT;
+    request.prompt = prompt;
+    return request;
+}
+
+static void test_chat_streams() {
+    int id = net_worker_submit(chat_request("hi"));
+    std::vector<NetEvent> events = poll_until(id, NetEventType::CHAT_DONE);
+
+    std::string content;
+    int done = 0;
+    for (const auto& event : events) {
+        CHECK_EQ(event.request_id, id);
+        if (event.type == NetEventType::CHAT_DELTA) {
+            content += event.content;
+        } else if (event.type == NetEventType::CHAT_DONE) {
+            done++;
+            CHECK(!event.cancelled);
+            CHECK_EQ(event.error, "");
+            CHECK_EQ(event.finish_reason, "stop");
+        }
+    }
+    CHECK_EQ(content, "Hello");
+    CHECK_EQ(done, 1);
+}
+
+static void test_models_delivered_once() {
+    int fetches_before = s_fetch_calls;
+    NetRequest request;
+    request.kind = NetRequestKind::FETCH_MODELS;
+    int id = net_worker_submit(request);
+
+    std::vector<NetEvent> events = poll_until(id, NetEventType::MODELS);
+    CHECK_EQ(events.size(), 1u);
+    CHECK_EQ(events.back().models.size(), 2u);
+
+    // Nothing more turns up on later frames
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    net_worker_poll(events);
+    CHECK(events.empty());
+    CHECK_EQ(s_fetch_calls, fetches_before + 1);
+}
+
+// Cancelling a request stuck waiting for the server's first byte aborts it in
+// the transport, and a request queued behind it never reaches the transport
+static void test_cancel_before_first_byte() {
+    int chats_before = s_chat_calls;
+    int hanging = net_worker_submit(chat_request("hang"));
+    int queued = net_worker_submit(chat_request("hi"));
+    wait_until_hanging(hanging);
+
+    net_worker_cancel(queued);
+    std::vector<NetEvent> events = poll_until(queued, NetEventType::CHAT_DONE);
+    CHECK_EQ(events.size(), 1u);
+    CHECK(events.back().cancelled);
+
+    double start = now_us();
+    net_worker_cancel(hanging);
+    events = poll_until(hanging, NetEventType::CHAT_DONE);
+    CHECK(now_us() - start < 1e6);
+    CHECK_EQ(events.size(), 1u);
+    CHECK(events.back().cancelled);
+    CHECK(s_aborted.count(hanging) == 1);
+    CHECK_EQ(s_chat_calls, chats_before + 1);
+}
+
+// Stopping at exit doesn't wait on a request the server never answers
+static void test_stop_aborts_in_flight() {
+    int hanging = net_worker_submit(chat_request("hang"));
+    wait_until_hanging(hanging);
+
+    double start = now_us();
+    net_worker_stop();
+    CHECK(now_us() - start < 1e6);
+    CHECK(s_aborted.count(hanging) == 1);
+}
+
+int main() {
+    CHECK(net_worker_start(stub_transport()));
+    test_chat_streams();
+    test_models_delivered_once();
+    test_cancel_before_first_byte();
+    test_stop_aborts_in_flight();
+    return test_result();
+}
@@ -0,0 +1,99 @@
+#include "test.h"
+#include "payload.h"
+#include <jsoncpp/json/json.h>
+#include <memory>
+
+// Building the body of the next turn on long sessions: the jsoncpp tree the
+// app used to build and serialize from scratch on every send, against
+// build_chat_payload with every fragment cached except the new message.
+// The gather into the send buffer is timed as part of each cached turn.
+// Both bodies are parsed back and compared once, so the two paths agree.
+
+static ChatSession make_session(int count) {
+    ChatSession session;
+    for (int i = 0; i < count; i++) {
+        ChatMessage message;
+        message.sender = i % 2 ? ChatMessage::LLM : ChatMessage::USER;
+        if (message.sender == ChatMessage::USER) {
+            message.text = "Question " + std::to_string(i) + ": what does \"this\" do?";
+        } else {
+            message.text = std::string(400, 'a') + "\n```\nint main() {\n\treturn 0;\n}\n```\n" + "\xe4\xbd\xa0\xe5\xa5\xbd " +
+                           std::string(300, 'b');
+        }
+        session.messages.push_back(message);
+    }
+    return session;
+}
+
+static std::string jsoncpp_payload(const std::string& model, const std::vector<ChatMessage>& messages) {
+    Json::Value root;
+    root["model"] = model;
+    root["stream"] = true;
+
+    Json::Value array(Json::arrayValue);
+    for (const auto& msg : messages) {
+        Json::Value message;
+        message["role"] = msg.sender == ChatMessage::USER ? "user" : "assistant";
+        message["content"] = msg.text;
+        array.append(message);
+    }
+    root["messages"] = array;
+
+    Json::StreamWriterBuilder writer;
+    return Json::writeString(writer, root);
+}
+
+static Json::Value parse(const std::string& body) {
+    Json::Value root;
+    std::string errors;
+    Json::CharReaderBuilder reader;
+    std::unique_ptr<Json::CharReader> parser(reader.newCharReader());
+    CHECK(parser->parse(body.data(), body.data() + body.size(), &root, &errors));
+    return root;
+}
+
+static void run(const char* title, int count) {
+    const std::string model = "gpt-4o-mini";
+    ChatSession session = make_session(count);
+    const int turns = count >= 10000 ? 20 : 100;
+
+    std::string body = jsoncpp_payload(model, session.messages);
+    size_t body_size = body.size();
+    double start = now_us();
+    for (int i = 0; i < turns; i++) {
+        body = jsoncpp_payload(model, session.messages);
+    }
+    double jsoncpp_us = (now_us() - start) / turns;
+
+    std::string send_buffer;
+    start = now_us();
+    build_chat_payload(model, session.messages, true).gather(send_buffer);
+    double first_us = now_us() - start;
+    CHECK(parse(send_buffer) == parse(body));
+
+    // Each turn adds a message whose fragment hasn't been built yet
+    double cached_us = 0;
+    for (int i = 0; i < turns; i++) {
+        ChatMessage message;
+        message.sender = ChatMessage::USER;
+        message.text = "Follow-up " + std::to_string(i);
+        session.messages.push_back(message);
+
+        start = now_us();
+        build_chat_payload(model, session.messages, true).gather(send_buffer);
+        cached_us += now_us() - start;
+        session.messages.pop_back();
+    }
+    cached_us /= turns;
+
+    printf("%s: %.1f MB body\n", title, body_size / 1048576.0);
+    printf("  %-22s %10.0f us per turn\n", "jsoncpp", jsoncpp_us);
+    printf("  %-22s %10.0f us\n", "fragments, first turn", first_us);
+    printf("  %-22s %10.0f us per turn (%.1fx)\n", "fragments, cached", cached_us, jsoncpp_us / cached_us);
+}
+
+int main() {
+    run("1k messages", 1000);
+    run("10k messages", 10000);
+    return test_result();
+}
@@ -0,0 +1,111 @@
+#include "test.h"
+#include "persistence.h"
+#include "host/fake_io.h"
+
+// Cost of save_sessions on the in-memory file system for 50 sessions of
+// 200 messages: the first save, which writes every snapshot and the index,
+// a save after a message was added to one session, which only appends to
+// the journal, and a save with nothing dirty. Nothing starts the
+// persistence writer, so the writes happen inside save_sessions. The card
+// is far slower than memory, so the bytes written are shown as well.
+//
+// Then the session part of a cold start: reading the index, opening one
+// session from the list, and for comparison loading every session up
+// front as startup did before the index carried summaries.
+
+bool read_image_size(const std::string&, int&, int&) {
+    return false;
+}
+
+static size_t bytes_on_card() {
+    size_t total = 0;
+    for (const auto& file : fake_io_files) {
+        total += file.second.size();
+    }
+    return total;
+}
+
+// Short questions and replies of about 1 KB, from a small vocabulary so
+// they compress roughly like real text
+static ChatMessage make_message(int i) {
+    static const char* words[] = { "the ", "model ", "Vita ", "screen ", "answer ", "of ", "a ", "quick ", "\"quoted\" ", "line\n" };
+    static unsigned int seed = 1;
+    ChatMessage message;
+    message.sender = i % 2 ? ChatMessage::LLM : ChatMessage::USER;
+    size_t size = message.sender == ChatMessage::LLM ? 1200 : 150;
+    while (message.text.size() < size) {
+        seed = seed * 1103515245 + 12345;
+        message.text += words[(seed >> 16) % 10];
+    }
+    return message;
+}
+
+static std::vector<ChatSession> make_sessions(int count, int messages) {
+    std::vector<ChatSession> sessions;
+    for (int s = 0; s < count; s++) {
+        ChatSession session = new_chat_session();
+        for (int i = 0; i < messages; i++) {
+            session.messages.push_back(make_message(i));
+        }
+        sessions.push_back(session);
+    }
+    return sessions;
+}
+
+// Times one save and reports how much it wrote
+static void timed_save(const char* name, std::vector<ChatSession>& sessions) {
+    size_t before = bytes_on_card();
+    double start = now_us();
+    CHECK(save_sessions(sessions));
+    double us = now_us() - start;
+    printf("  %-16s %9.0f us, card grew by %zu bytes\n", name, us, bytes_on_card() - before);
+}
+
+static void bench_saves(int count, int messages) {
+    fake_io_reset();
+    std::vector<ChatSession> sessions = make_sessions(count, messages);
+    printf("save, %d sessions of %d messages:\n", count, messages);
+
+    timed_save("everything", sessions);
+
+    sessions[count / 2].messages.push_back(make_message(messages));
+    sessions[count / 2].dirty = true;
+    timed_save("one new message", sessions);
+
+    timed_save("nothing dirty", sessions);
+}
+
+static void bench_cold_start(int count, int messages) {
+    fake_io_reset();
+    std::vector<ChatSession> saved = make_sessions(count, messages);
+    CHECK(save_sessions(saved));
+    printf("cold start, %d sessions of %d messages:\n", count, messages);
+
+    double start = now_us();
+    std::vector<ChatSession> sessions = load_sessions();
+    double index_us = now_us() - start;
+    CHECK_EQ(sessions.size(), (size_t)count);
+
+    start = now_us();
+    CHECK(load_session_messages(sessions[count / 2]));
+    double open_us = now_us() - start;
+    CHECK_EQ(sessions[count / 2].messages.size(), (size_t)messages);
+
+    start = now_us();
+    for (auto& session : sessions) {
+        load_session_messages(session);
+    }
+    double all_us = now_us() - start + index_us;
+
+    printf("  %-16s %9.0f us\n", "index", index_us);
+    printf("  %-16s %9.0f us\n", "open one", open_us);
+    printf("  %-16s %9.0f us\n", "index + all", all_us);
+}
+
+int main() {
+    bench_saves(50, 200);
+    bench_cold_start(10, 50);
+    bench_cold_start(100, 50);
+    bench_cold_start(1000, 50);
+    return test_result();
+}
@@ -0,0 +1,186 @@
+// Session saves through the journal, on the in-memory file system from
+// host/fake_io.h. Nothing starts the persistence writer, so each save is
+// written before save_sessions returns.
+
+#include "persistence.h"
+#include "persist_writer.h"
+#include "host/fake_io.h"
+#include "test.h"
+
+#define SESSIONS_DIR "ux0:data/vela/sessions"
+#define JOURNAL_PATH SESSIONS_DIR "/journal.bin"
+#define INDEX_PATH SESSIONS_DIR "/index.json"
+
+// Messages here never have images
+bool read_image_size(const std::string&, int&, int&) {
+    return false;
+}
+
+static std::string snapshot_path(int id) {
+    return SESSIONS_DIR "/" + std::to_string(id) + ".bin";
+}
+
+static std::string message_text(int i) {
+    // About 1 KB each, so the journal passes 256 KB after a couple of hundred
+    return "message " + std::to_string(i) + " " + std::string(1000, 'a' + i % 26);
+}
+
+static void add_message(ChatSession& session, int i) {
+    ChatMessage message;
+    message.sender = i % 2 ? ChatMessage::LLM : ChatMessage::USER;
+    message.text = message_text(i);
+    if (message.sender == ChatMessage::LLM) {
+        message.reasoning = "because " + std::to_string(i);
+    }
+    session.messages.push_back(message);
+    session.dirty = true;
+}
+
+static size_t journal_size() {
+    auto it = fake_io_files.find(JOURNAL_PATH);
+    return it == fake_io_files.end() ? 0 : it->second.size();
+}
+
+// Loads the sessions back from what is on the fake card, with every session read in full
+static std::vector<ChatSession> reload() {
+    std::vector<ChatSession> sessions = load_sessions();
+    for (auto& session : sessions) {
+        load_session_messages(session);
+    }
+    return sessions;
+}
+
+static void check_messages(const ChatSession& session, int count) {
+    CHECK_EQ(session.messages.size(), (size_t)count);
+    for (int i = 0; i < count && i < (int)session.messages.size(); i++) {
+        const ChatMessage& message = session.messages[i];
+        CHECK_EQ(message.text, message_text(i));
+        CHECK_EQ(message.sender, i % 2 ? ChatMessage::LLM : ChatMessage::USER);
+        if (i % 2) {
+            CHECK_EQ(message.reasoning, "because " + std::to_string(i));
+        }
+    }
+}
+
+// Appends one message per save until a save compacts the journal. Returns
+// how many messages the session ended up with.
+static int save_until_compacted(std::vector<ChatSession>& sessions) {
+    int count = (int)sessions[0].messages.size();
+    size_t largest = 0;
+    while (count < 1000) {
+        add_message(sessions[0], count++);
+        save_sessions(sessions);
+        if (!fake_io_files.count(JOURNAL_PATH)) {
+            break;
+        }
+        CHECK(journal_size() > largest);
+        largest = journal_size();
+    }
+    // save_sessions only estimates the record sizes, so allow some slack around 256 KB
+    CHECK(largest > 240 * 1024);
+    CHECK(largest < 300 * 1024);
+    return count;
+}
+
+static void test_compaction() {
+    fake_io_reset();
+    std::vector<ChatSession> sessions = load_sessions();
+    CHECK_EQ(sessions.size(), 1u);
+
+    int count = save_until_compacted(sessions);
+    CHECK(!fake_io_files.count(JOURNAL_PATH));
+    CHECK(fake_io_files.count(snapshot_path(sessions[0].id)));
+    CHECK(fake_io_files.count(INDEX_PATH));
+
+    // Everything is in the snapshot now; the index alone says how big it is
+    std::vector<ChatSession> loaded = load_sessions();
+    CHECK_EQ(loaded.size(), 1u);
+    CHECK(!loaded[0].loaded);
+    CHECK_EQ(loaded[0].summary.message_count, count);
+    load_session_messages(loaded[0]);
+    check_messages(loaded[0], count);
+
+    // Saves after compaction start a fresh journal on top of the snapshot
+    add_message(loaded[0], count);
+    add_message(loaded[0], count + 1);
+    save_sessions(loaded);
+    CHECK(journal_size() > 0);
+    CHECK(journal_size() < 4096);
+    loaded = reload();
+    check_messages(loaded[0], count + 2);
+}
+
+// Power lost after the snapshots were written but before the journal was
+// removed: replaying the journal over them must not duplicate anything
+static void test_crash_before_journal_removed() {
+    fake_io_reset();
+    std::map<std::string, std::string> crash_image;
+    bool crashed = false;
+    fake_io_before_remove = [&](const std::string& path) {
+        if (path == JOURNAL_PATH && !crashed) {
+            crash_image = fake_io_files;
+            crashed = true;
+        }
+    };
+
+    std::vector<ChatSession> sessions = load_sessions();
+    int count = save_until_compacted(sessions);
+    CHECK(crashed);
+    CHECK(crash_image.count(JOURNAL_PATH));
+    CHECK(crash_image.count(snapshot_path(sessions[0].id)));
+
+    fake_io_files = crash_image;
+    fake_io_before_remove = nullptr;
+    std::vector<ChatSession> loaded = reload();
+    CHECK_EQ(loaded.size(), 1u);
+    check_messages(loaded[0], count);
+    CHECK_EQ(loaded[0].summary.message_count, count);
+
+    // The leftover journal is still whole, so it is kept until the next compaction
+    CHECK_EQ(fake_io_files[JOURNAL_PATH], crash_image[JOURNAL_PATH]);
+    add_message(loaded[0], count);
+    save_sessions(loaded);
+    loaded = reload();
+    check_messages(loaded[0], count + 1);
+}
+
+// A record cut short by a power loss is dropped on load and the journal is
+// compacted straight away; a corrupt record drops everything after it
+static void test_torn_journal_on_load() {
+    fake_io_reset();
+    std::vector<ChatSession> sessions = load_sessions();
+    for (int i = 0; i < 5; i++) {
+        add_message(sessions[0], i);
+        save_sessions(sessions);
+    }
+    std::string journal = fake_io_files[JOURNAL_PATH];
+    std::map<std::string, std::string> saved = fake_io_files;
+
+    fake_io_files[JOURNAL_PATH] = journal.substr(0, journal.size() - 3);
+    std::vector<ChatSession> loaded = reload();
+    check_messages(loaded[0], 4);
+    CHECK(!fake_io_files.count(JOURNAL_PATH));
+    loaded = reload();
+    check_messages(loaded[0], 4);
+
+    // Garbage past the last whole record
+    fake_io_files = saved;
+    fake_io_files[JOURNAL_PATH] = journal + std::string("\x10\0\0\0garbage", 11);
+    loaded = reload();
+    check_messages(loaded[0], 5);
+    CHECK(!fake_io_files.count(JOURNAL_PATH));
+
+    // A flipped byte inside the last record
+    fake_io_files = saved;
+    fake_io_files[JOURNAL_PATH] = journal;
+    fake_io_files[JOURNAL_PATH][journal.size() - 2] ^= 0x20;
+    loaded = reload();
+    check_messages(loaded[0], 4);
+}
+
+int main() {
+    test_compaction();
+    test_crash_before_journal_removed();
+    test_torn_journal_on_load();
+    return test_result();
+}
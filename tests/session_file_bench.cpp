@@ -0,0 +1,130 @@
+#include "test.h"
+#include "persistence.h"
+#include "session_file.h"
+#include <jsoncpp/json/json.h>
+#include <memory>
+
+// Load time of a session from its binary snapshot against parsing the JSON
+// layout of earlier builds into a jsoncpp document and copying every string
+// out, on synthetic histories. The JSON comes from session_binary_to_json.
+
+bool read_image_size(const std::string&, int&, int&) {
+    return false;
+}
+
+// Replies of a few paragraphs with some reasoning, like a long chat
+static std::vector<ChatMessage> synthetic_history(int count, size_t reply_size) {
+    static const char* words[] = { "the ", "model ", "Vita ", "screen ", "answer ", "of ", "a ", "quick ", "\"quoted\" ", "line\n" };
+    std::vector<ChatMessage> messages;
+    unsigned int seed = 1;
+    for (int i = 0; i < count; i++) {
+        ChatMessage message;
+        message.sender = i % 2 ? ChatMessage::LLM : ChatMessage::USER;
+        size_t size = message.sender == ChatMessage::LLM ? reply_size : reply_size / 8;
+        while (message.text.size() < size) {
+            seed = seed * 1103515245 + 12345;
+            message.text += words[(seed >> 16) % 10];
+        }
+        if (message.sender == ChatMessage::LLM) {
+            message.reasoning = message.text.substr(0, size / 4);
+        }
+        messages.push_back(message);
+    }
+    return messages;
+}
+
+static size_t load_json(const std::string& json) {
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    Json::Value root;
+    std::string errors;
+    if (!reader->parse(json.data(), json.data() + json.size(), &root, &errors)) {
+        return 0;
+    }
+    std::vector<ChatMessage> messages;
+    for (const auto& item : root) {
+        ChatMessage message;
+        message.sender = item["sender"].asString() == "user" ? ChatMessage::USER : ChatMessage::LLM;
+        message.text = item["text"].asString();
+        message.reasoning = item["reasoning"].asString();
+        message.show_reasoning = item["show_reasoning"].asBool();
+        message.image_path = item["image_path"].asString();
+        messages.push_back(message);
+    }
+    return messages.size();
+}
+
+static size_t load_binary(const std::string& binary) {
+    SessionFile file;
+    if (!session_file_open(binary, file)) {
+        return 0;
+    }
+    std::vector<ChatMessage> messages(file.message_count);
+    for (uint32_t i = 0; i < file.message_count; i++) {
+        session_file_read_message(file, i, messages[i]);
+    }
+    return messages.size();
+}
+
+// The same body stored without compression, to show what inflating costs
+static std::string uncompressed_copy(const std::string& binary) {
+    SessionFile file;
+    session_file_open(binary, file);
+    std::string raw = binary.substr(0, 20);
+    raw[6] = 0;
+    raw[7] = 0;
+    for (int i = 0; i < 4; i++) {
+        raw[16 + i] = (char)((file.body_size >> (8 * i)) & 0xFF);
+    }
+    raw.append(file.body, file.body_size);
+    return raw;
+}
+
+// What showing the end of a session needs: the newest message only
+static size_t load_last(const std::string& binary) {
+    SessionFile file;
+    ChatMessage message;
+    if (!session_file_open(binary, file) || file.message_count == 0) {
+        return 0;
+    }
+    return session_file_read_message(file, file.message_count - 1, message) ? 1 : 0;
+}
+
+template <typename Fn>
+static void bench(const char* name, const std::string& data, Fn fn) {
+    const int runs = 10;
+    size_t messages = 0;
+    double start = now_us();
+    for (int i = 0; i < runs; i++) {
+        messages = fn(data);
+    }
+    double us = (now_us() - start) / runs;
+    printf("  %-12s %9.0f us for %zu messages from %zu bytes\n", name, us, messages, data.size());
+}
+
+static void run(const char* title, int count, size_t reply_size) {
+    std::vector<ChatMessage> messages = synthetic_history(count, reply_size);
+    std::string binary;
+    double start = now_us();
+    session_file_write(messages, binary);
+    double write_us = now_us() - start;
+
+    std::string json;
+    session_binary_to_json(binary, json);
+    printf("%s: %d messages, JSON %zu bytes, binary %zu bytes, written in %.0f us\n",
+           title, count, json.size(), binary.size(), write_us);
+
+    bench("jsoncpp", json, load_json);
+    bench("binary", binary, load_binary);
+    bench("binary last", binary, load_last);
+    std::string raw = uncompressed_copy(binary);
+    bench("raw", raw, load_binary);
+    bench("raw last", raw, load_last);
+}
+
+int main() {
+    run("short", 40, 800);
+    run("long", 1000, 1500);
+    run("huge", 5000, 3000);
+    return test_result();
+}
@@ -0,0 +1,137 @@
+// Binary session snapshots: round trips with and without compression, single
+// messages decoded by index, and damaged files rejected before anything is
+// allocated from their headers.
+
+#include "session_file.h"
+#include "test.h"
+#include <zlib.h>
+
+static std::vector<ChatMessage> make_messages(int count, size_t text_size) {
+    std::vector<ChatMessage> messages;
+    for (int i = 0; i < count; i++) {
+        ChatMessage message;
+        message.sender = i % 2 ? ChatMessage::LLM : ChatMessage::USER;
+        message.text = "message " + std::to_string(i) + " " + std::string(text_size, 'a' + i % 26);
+        if (i % 2) {
+            message.reasoning = "thinking about " + std::to_string(i);
+            message.show_reasoning = i % 4 == 1;
+        }
+        if (i % 7 == 0) {
+            message.image_path = "ux0:data/vela/images/" + std::to_string(i) + ".jpg";
+        }
+        messages.push_back(message);
+    }
+    return messages;
+}
+
+static void check_same(const ChatMessage& a, const ChatMessage& b) {
+    CHECK_EQ(a.sender, b.sender);
+    CHECK_EQ(a.show_reasoning, b.show_reasoning);
+    CHECK_EQ(a.text, b.text);
+    CHECK_EQ(a.reasoning, b.reasoning);
+    CHECK_EQ(a.image_path, b.image_path);
+}
+
+static uint16_t flags_of(const std::string& data) {
+    return (unsigned char)data[6] | ((unsigned char)data[7] << 8);
+}
+
+static void set_u32(std::string& data, size_t pos, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        data[pos + i] = (char)((value >> (8 * i)) & 0xFF);
+    }
+}
+
+static void test_round_trip(int count, size_t text_size, bool compressed) {
+    std::vector<ChatMessage> messages = make_messages(count, text_size);
+    std::string data;
+    session_file_write(messages, data);
+    CHECK_EQ((flags_of(data) & SESSION_FILE_COMPRESSED) != 0, compressed);
+
+    SessionFile file;
+    CHECK(session_file_open(data, file));
+    CHECK_EQ(file.message_count, (uint32_t)count);
+    for (int i = 0; i < count; i++) {
+        ChatMessage message;
+        CHECK(session_file_read_message(file, i, message));
+        check_same(message, messages[i]);
+    }
+    ChatMessage message;
+    CHECK(!session_file_read_message(file, count, message));
+}
+
+static void test_empty() {
+    std::string data;
+    session_file_write(std::vector<ChatMessage>(), data);
+    SessionFile file;
+    CHECK(session_file_open(data, file));
+    CHECK_EQ(file.message_count, 0u);
+}
+
+static void test_damaged() {
+    std::string small;
+    session_file_write(make_messages(10, 20), small);
+    std::string large;
+    session_file_write(make_messages(400, 200), large);
+    CHECK(flags_of(large) & SESSION_FILE_COMPRESSED);
+
+    SessionFile file;
+    for (size_t cut = 0; cut < small.size(); cut++) {
+        CHECK(!session_file_open(small.substr(0, cut), file));
+    }
+    for (size_t cut = 0; cut < large.size(); cut += 97) {
+        CHECK(!session_file_open(large.substr(0, cut), file));
+    }
+
+    std::string bad = small;
+    bad[0] = 'X';
+    CHECK(!session_file_open(bad, file));
+
+    bad = small;
+    bad[4] = SESSION_FILE_VERSION + 1;
+    CHECK(!session_file_open(bad, file));
+
+    // A huge body size in the header must be refused, not allocated
+    bad = large;
+    set_u32(bad, 12, 0xFFFFFFF0u);
+    CHECK(!session_file_open(bad, file));
+    bad = large;
+    set_u32(bad, 12, SESSION_FILE_MAX_BODY + 1);
+    CHECK(!session_file_open(bad, file));
+
+    // ... including one under the cap that no deflate stream could inflate to
+    std::string tiny_body(64, '\0');
+    uLongf tiny_size = compressBound(tiny_body.size());
+    std::string tiny(tiny_size, '\0');
+    CHECK_EQ(compress2((Bytef*)&tiny[0], &tiny_size, (const Bytef*)tiny_body.data(), tiny_body.size(), Z_BEST_SPEED), Z_OK);
+    tiny.resize(tiny_size);
+    std::string forged("VSES\x01\x00\x01\x00", 8);
+    forged += std::string(12, '\0');
+    set_u32(forged, 12, (uint32_t)(tiny.size() * 1032 + 1));
+    set_u32(forged, 16, (uint32_t)tiny.size());
+    forged += tiny;
+    CHECK(!session_file_open(forged, file));
+
+    // A body size that is plausible but wrong fails to inflate
+    CHECK(session_file_open(large, file));
+    bad = large;
+    set_u32(bad, 12, (uint32_t)file.body_size + 1);
+    CHECK(!session_file_open(bad, file));
+
+    // An offset pointing past the body fails that message only
+    bad = small;
+    set_u32(bad, 20 + 4 * 3, 0x7FFFFFFF);
+    CHECK(session_file_open(bad, file));
+    ChatMessage message;
+    CHECK(!session_file_read_message(file, 3, message));
+    CHECK(session_file_read_message(file, 4, message));
+}
+
+int main() {
+    test_empty();
+    test_round_trip(1, 10, false);
+    test_round_trip(50, 100, false);
+    test_round_trip(400, 200, true);
+    test_damaged();
+    return test_result();
+}
@@ -0,0 +1,55 @@
+#ifndef VELA_TEST_H
+#define VELA_TEST_H
+
+#include <cstdio>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+
+// Minimal checks for the host tests. Failures are reported and counted, and
+// each test program returns test_result() from main.
+
+static int s_test_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+        s_test_failures++; \
+    } \
+} while (0)
+
+#define CHECK_EQ(a, b) do { \
+    if (!((a) == (b))) { \
+        std::ostringstream check_out; \
+        check_out << (a) << " != " << (b); \
+        fprintf(stderr, "%s:%d: CHECK_EQ failed: %s == %s (%s)\n", __FILE__, __LINE__, #a, #b, check_out.str().c_str()); \
+        s_test_failures++; \
+    } \
+} while (0)
+
+static int test_result() {
+    if (s_test_failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", s_test_failures);
+        return 1;
+    }
+    return 0;
+}
+
+// Reads a file from tests/data
+static std::string test_data(const std::string& name) {
+    std::ifstream in(std::string(VELA_TEST_DATA) + "/" + name, std::ios::binary);
+    std::ostringstream content;
+    content << in.rdbuf();
+    if (!in) {
+        fprintf(stderr, "missing test data: %s\n", name.c_str());
+        s_test_failures++;
+    }
+    return content.str();
+}
+
+static double now_us() {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif
@@ -0,0 +1,111 @@
+// UTF-8 decoding of well-formed and broken text, string widths from the
+// advance table, and export/import of the table.
+
+#include "text_metrics.h"
+#include "test.h"
+
+// native_text_metrics_source isn't used here
+int vita2d_pgf_text_width(vita2d_pgf*, float, const char*) {
+    return 0;
+}
+
+static int s_measured = 0;
+
+// Every code point is 10 px wide at scale 1, except a few wide ones
+static TextMetricsSource counting_source() {
+    TextMetricsSource source;
+    source.advance = [](unsigned int codepoint, float scale) {
+        s_measured++;
+        int advance = codepoint >= 0x3000 ? 20 : 10;
+        return (int)(advance * scale);
+    };
+    return source;
+}
+
+// Code points and lengths of every sequence in text
+static std::string decode_all(const std::string& text) {
+    std::ostringstream out;
+    for (size_t i = 0; i < text.size();) {
+        unsigned int codepoint;
+        size_t length = utf8_decode(text, i, codepoint);
+        out << std::hex << codepoint << '/' << length << ' ';
+        i += length;
+    }
+    return out.str();
+}
+
+static void test_decode() {
+    CHECK_EQ(decode_all("a"), "61/1 ");
+    CHECK_EQ(decode_all("\xc3\xa9"), "e9/2 ");
+    CHECK_EQ(decode_all("\xe2\x82\xac"), "20ac/3 ");
+    CHECK_EQ(decode_all("\xf0\x9f\x98\x80"), "1f600/4 ");
+
+    // Stray continuation bytes and truncated sequences are single bytes
+    CHECK_EQ(decode_all("\x80" "a"), "80/1 61/1 ");
+    CHECK_EQ(decode_all("\xe2\x82"), "e2/1 82/1 ");
+    CHECK_EQ(decode_all("\xe2" "ab"), "e2/1 61/1 62/1 ");
+    CHECK_EQ(decode_all("\xf0\x9f\x98" "a"), "f0/1 9f/1 98/1 61/1 ");
+
+    // Bytes from 0xF8 up never start a sequence, whatever follows them
+    for (int lead = 0xF8; lead <= 0xFF; lead++) {
+        std::string text;
+        text += (char)lead;
+        text += "\x80\x80\x80\x80" "a";
+        std::ostringstream expected;
+        expected << std::hex << lead << "/1 80/1 80/1 80/1 80/1 61/1 ";
+        CHECK_EQ(decode_all(text), expected.str());
+    }
+}
+
+static void test_width() {
+    text_metrics_init(counting_source());
+    s_measured = 0;
+    CHECK_EQ(text_metrics_width("abc"), 30);
+    CHECK_EQ(s_measured, 3);
+    CHECK_EQ(text_metrics_width("cab"), 30);
+    CHECK_EQ(s_measured, 3);
+
+    CHECK_EQ(text_metrics_width("ab\nabcd\na"), 40);
+    CHECK_EQ(text_metrics_width("\xe3\x81\x82\xe3\x81\x84"), 40);
+    CHECK_EQ(text_metrics_width("ab", 2.0f), 40);
+    CHECK_EQ(text_metrics_width("\xff" "a"), 20);
+    CHECK_EQ(text_metrics_width(""), 0);
+    text_metrics_shutdown();
+}
+
+static void test_export_import() {
+    text_metrics_init(counting_source());
+    text_metrics_width("hello \xe3\x81\x82");
+    text_metrics_width("hi", 0.5f);
+    CHECK(text_metrics_changed());
+    std::string table = text_metrics_export();
+    CHECK(!text_metrics_changed());
+
+    // Loaded into a fresh table, nothing has to be measured again
+    text_metrics_init(counting_source());
+    CHECK(text_metrics_import(table));
+    s_measured = 0;
+    CHECK_EQ(text_metrics_width("hello \xe3\x81\x82"), 80);
+    CHECK_EQ(text_metrics_width("hi", 0.5f), 10);
+    CHECK_EQ(s_measured, 0);
+    CHECK(!text_metrics_changed());
+
+    // A malformed table is rejected as a whole, even after good lines
+    text_metrics_init(counting_source());
+    text_metrics_width("a");
+    std::string before = text_metrics_export();
+    CHECK(!text_metrics_import("1 98 12\n1 12354 25\n1 99 oops\n"));
+    CHECK(!text_metrics_import("1 98 12\n1 99 -3\n"));
+    CHECK_EQ(text_metrics_export(), before);
+    s_measured = 0;
+    CHECK_EQ(text_metrics_advance('b'), 10);
+    CHECK_EQ(s_measured, 1);
+    text_metrics_shutdown();
+}
+
+int main() {
+    test_decode();
+    test_width();
+    test_export_import();
+    return test_result();
+}
@@ -0,0 +1,142 @@
+// The text run atlas: each update renders only the lines that got a slot
+// that frame, slots stay inside the atlas without overlapping, and lines
+// are evicted least recently used first.
+
+#include "text_run_cache.h"
+#include "text_metrics.h"
+#include "test.h"
+#include <set>
+
+// native_text_metrics_source isn't used here
+int vita2d_pgf_text_width(vita2d_pgf*, float, const char*) {
+    return 0;
+}
+
+static std::vector<std::vector<TextRun>> s_renders;
+static int s_drawn_parts = 0;
+static int s_drawn_text = 0;
+
+static TextRunBackend recording_backend() {
+    TextRunBackend backend;
+    backend.create_atlas = [](unsigned int, unsigned int) {
+        static int atlas;
+        return (vita2d_texture*)&atlas;
+    };
+    backend.free_atlas = [](vita2d_texture*) {};
+    backend.render = [](vita2d_texture*, const std::vector<TextRun>& runs) {
+        s_renders.push_back(runs);
+    };
+    backend.draw_part = [](vita2d_texture*, float, float, float, float, float, float, unsigned int) {
+        s_drawn_parts++;
+    };
+    backend.draw_text = [](float, float, unsigned int, const std::string&) {
+        s_drawn_text++;
+    };
+    return backend;
+}
+
+static std::string line(int i) {
+    return "line " + std::to_string(i);
+}
+
+// One frame that draws lines [first, first + count)
+static bool frame(int first, int count) {
+    for (int i = first; i < first + count; i++) {
+        text_run_cache_request(line(i));
+    }
+    bool rendered = text_run_cache_update();
+    for (int i = first; i < first + count; i++) {
+        text_run_draw(10, 100, 0xFFFFFFFF, line(i));
+    }
+    return rendered;
+}
+
+static void test_renders_new_lines_only() {
+    s_renders.clear();
+    CHECK(frame(0, 20));
+    CHECK_EQ(s_renders.size(), 1u);
+    CHECK_EQ(s_renders.back().size(), 20u);
+    CHECK_EQ(s_drawn_parts, 20);
+
+    // Scrolling by two lines renders just those two
+    CHECK(frame(2, 20));
+    CHECK_EQ(s_renders.size(), 2u);
+    CHECK_EQ(s_renders.back().size(), 2u);
+    if (s_renders.back().size() == 2) {
+        CHECK_EQ(s_renders.back()[0].text, line(20));
+        CHECK_EQ(s_renders.back()[1].text, line(21));
+    }
+
+    // Nothing new, nothing rendered
+    CHECK(!frame(2, 20));
+    CHECK_EQ(s_renders.size(), 2u);
+}
+
+static void test_slots() {
+    // Fill every slot, then some: every slot rect must be inside the atlas and unique
+    s_renders.clear();
+    std::set<std::pair<float, float>> slots;
+    for (int i = 0; i < 200; i += 10) {
+        frame(1000 + i, 10);
+    }
+    for (const auto& runs : s_renders) {
+        for (const auto& run : runs) {
+            float top = run.y - TEXT_RUN_BASELINE;
+            CHECK(run.x >= 0 && run.x + TEXT_RUN_SLOT_WIDTH <= TEXT_RUN_ATLAS_WIDTH);
+            CHECK(top >= 0 && top + TEXT_RUN_SLOT_HEIGHT <= TEXT_RUN_ATLAS_HEIGHT);
+            CHECK_EQ((int)top % TEXT_RUN_SLOT_HEIGHT, 0);
+            slots.insert(std::make_pair(run.x, top));
+        }
+    }
+    size_t slot_count = (TEXT_RUN_ATLAS_WIDTH / TEXT_RUN_SLOT_WIDTH) * (TEXT_RUN_ATLAS_HEIGHT / TEXT_RUN_SLOT_HEIGHT);
+    CHECK_EQ(slots.size(), slot_count);
+    CHECK(text_run_cache_stats().evictions > 0);
+}
+
+static void test_lru() {
+    text_run_cache_shutdown();
+    text_run_cache_init(recording_backend());
+    size_t slot_count = (TEXT_RUN_ATLAS_WIDTH / TEXT_RUN_SLOT_WIDTH) * (TEXT_RUN_ATLAS_HEIGHT / TEXT_RUN_SLOT_HEIGHT);
+
+    // Fill the atlas over two frames, then touch the first half again
+    int half = (int)slot_count / 2;
+    frame(0, half);
+    frame(half, (int)slot_count - half);
+    frame(0, half);
+
+    // New lines take the slots of the second half, not the recently used first half
+    s_renders.clear();
+    frame(5000, 3);
+    CHECK_EQ(s_renders.size(), 1u);
+    s_renders.clear();
+    CHECK(!frame(0, half));
+    CHECK(s_renders.empty());
+
+    // More lines on screen than slots: the rest are drawn directly
+    s_drawn_text = 0;
+    frame(7000, (int)slot_count + 5);
+    CHECK_EQ(s_drawn_text, 5);
+
+    // Lines too wide for a slot are never cached
+    s_drawn_text = 0;
+    std::string wide(TEXT_RUN_SLOT_WIDTH, 'w');
+    text_run_cache_request(wide);
+    text_run_cache_update();
+    text_run_draw(0, 20, 0xFFFFFFFF, wide);
+    CHECK_EQ(s_drawn_text, 1);
+}
+
+int main() {
+    TextMetricsSource metrics;
+    metrics.advance = [](unsigned int, float) { return 8; };
+    text_metrics_init(metrics);
+    CHECK(text_run_cache_init(recording_backend()));
+
+    test_renders_new_lines_only();
+    test_slots();
+    test_lru();
+
+    text_run_cache_shutdown();
+    text_metrics_shutdown();
+    return test_result();
+}
@@ -0,0 +1,191 @@
+// The texture cache over a fake allocator: least recently used entries go
+// first once over budget, textures drawn this frame are never evicted, and
+// evicted or replaced textures are only freed by texture_cache_collect.
+
+#include "texture_cache.h"
+#include "test.h"
+#include <map>
+#include <set>
+
+struct vita2d_texture {
+    std::string path;
+};
+
+// Textures are 100 bytes, or the size in a path like "big:250"
+static std::set<vita2d_texture*> s_live;
+static std::map<std::string, int> s_loads;
+
+static size_t size_for(const std::string& path) {
+    return path.compare(0, 4, "big:") == 0 ? std::stoul(path.substr(4)) : 100;
+}
+
+static vita2d_texture* make_texture(const std::string& path) {
+    vita2d_texture* texture = new vita2d_texture;
+    texture->path = path;
+    s_live.insert(texture);
+    return texture;
+}
+
+static TextureAllocator fake_allocator() {
+    TextureAllocator allocator;
+    allocator.load = [](const std::string& path, size_t& bytes) -> vita2d_texture* {
+        s_loads[path]++;
+        if (path == "missing") {
+            return NULL;
+        }
+        bytes = size_for(path);
+        return make_texture(path);
+    };
+    allocator.free = [](vita2d_texture* texture) {
+        CHECK(s_live.erase(texture) == 1);
+        delete texture;
+    };
+    return allocator;
+}
+
+static void reset(size_t budget) {
+    texture_cache_shutdown();
+    CHECK(s_live.empty());
+    s_loads.clear();
+    texture_cache_init(fake_allocator(), budget);
+}
+
+static void test_lru_eviction() {
+    reset(300);
+    texture_cache_get("a");
+    texture_cache_get("b");
+    texture_cache_get("c");
+    texture_cache_collect();
+
+    // a is used again, so b is now the least recently used
+    CHECK(texture_cache_get("a") != NULL);
+    texture_cache_get("d");
+    TextureCacheStats stats = texture_cache_stats();
+    CHECK_EQ(stats.entries, 3u);
+    CHECK_EQ(stats.bytes, 300u);
+    CHECK_EQ(stats.evictions, 1u);
+    CHECK_EQ(stats.hits, 1u);
+    CHECK_EQ(stats.misses, 4u);
+
+    // b waits for the GPU to be done with the frame before it is freed
+    CHECK_EQ(texture_cache_pending_frees(), 1u);
+    CHECK_EQ(s_live.size(), 4u);
+    texture_cache_collect();
+    CHECK_EQ(texture_cache_pending_frees(), 0u);
+    CHECK_EQ(s_live.size(), 3u);
+
+    texture_cache_get("b");
+    texture_cache_get("a");
+    CHECK_EQ(s_loads["b"], 2);
+    CHECK_EQ(s_loads["a"], 1);
+}
+
+static void test_drawn_this_frame_is_pinned() {
+    reset(300);
+    for (int i = 0; i < 5; i++) {
+        CHECK(texture_cache_get("pinned " + std::to_string(i)) != NULL);
+    }
+
+    // Everything was drawn this frame, so the cache runs over budget for now
+    TextureCacheStats stats = texture_cache_stats();
+    CHECK_EQ(stats.entries, 5u);
+    CHECK_EQ(stats.bytes, 500u);
+    CHECK_EQ(stats.evictions, 0u);
+    CHECK_EQ(texture_cache_pending_frees(), 0u);
+
+    // The next frame drops the two least recently used, freed a frame later
+    texture_cache_collect();
+    stats = texture_cache_stats();
+    CHECK_EQ(stats.entries, 3u);
+    CHECK_EQ(stats.bytes, 300u);
+    CHECK_EQ(stats.evictions, 2u);
+    CHECK_EQ(texture_cache_pending_frees(), 2u);
+    CHECK_EQ(s_live.size(), 5u);
+    texture_cache_collect();
+    CHECK_EQ(s_live.size(), 3u);
+
+    // A big texture needed this frame stays, and the others make room for it
+    texture_cache_get("pinned 4");
+    texture_cache_get("big:250");
+    stats = texture_cache_stats();
+    CHECK_EQ(stats.entries, 2u);
+    CHECK_EQ(stats.bytes, 350u);
+}
+
+static void test_load_failures_are_remembered() {
+    reset(300);
+    CHECK(texture_cache_get("missing") == NULL);
+    CHECK(texture_cache_get("missing") == NULL);
+    TextureCacheStats stats = texture_cache_stats();
+    CHECK_EQ(s_loads["missing"], 1);
+    CHECK_EQ(stats.load_failures, 1u);
+    CHECK_EQ(stats.bytes, 0u);
+}
+
+static void test_insert_replaces() {
+    reset(300);
+    vita2d_texture* first = make_texture("photo");
+    texture_cache_insert("photo", first, 100);
+    texture_cache_get("other");
+
+    vita2d_texture* second = make_texture("photo");
+    texture_cache_insert("photo", second, 150);
+
+    // The old texture is dropped without counting as an eviction
+    TextureCacheStats stats = texture_cache_stats();
+    CHECK_EQ(stats.entries, 2u);
+    CHECK_EQ(stats.bytes, 250u);
+    CHECK_EQ(stats.evictions, 0u);
+    CHECK_EQ(texture_cache_pending_frees(), 1u);
+    CHECK(texture_cache_get("photo") == second);
+
+    texture_cache_collect();
+    CHECK(s_live.count(first) == 0);
+    CHECK(s_live.count(second) == 1);
+
+    // Over budget, the replaced entry is treated like any other
+    texture_cache_collect();
+    texture_cache_insert("photo", make_texture("photo"), 250);
+    stats = texture_cache_stats();
+    CHECK_EQ(stats.entries, 1u);
+    CHECK_EQ(stats.bytes, 250u);
+    CHECK_EQ(stats.evictions, 1u);
+}
+
+// A texture the cache never held is freed with the evicted ones
+static void test_release() {
+    reset(300);
+    vita2d_texture* photo = make_texture("photo");
+    texture_cache_release(photo);
+    CHECK_EQ(texture_cache_pending_frees(), 1u);
+    CHECK_EQ(texture_cache_stats().entries, 0u);
+    CHECK(s_live.count(photo) == 1);
+    texture_cache_collect();
+    CHECK(s_live.count(photo) == 0);
+}
+
+static void test_clear() {
+    reset(300);
+    texture_cache_get("a");
+    texture_cache_get("b");
+    texture_cache_clear();
+    TextureCacheStats stats = texture_cache_stats();
+    CHECK_EQ(stats.entries, 0u);
+    CHECK_EQ(stats.bytes, 0u);
+    CHECK_EQ(texture_cache_pending_frees(), 2u);
+    texture_cache_collect();
+    CHECK(s_live.empty());
+}
+
+int main() {
+    test_lru_eviction();
+    test_drawn_this_frame_is_pinned();
+    test_load_failures_are_remembered();
+    test_insert_replaces();
+    test_release();
+    test_clear();
+
+    texture_cache_shutdown();
+    CHECK(s_live.empty());
+    return test_result();
+}
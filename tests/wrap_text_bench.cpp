@@ -0,0 +1,91 @@
+#include "test.h"
+#include "ui.h"
+#include "text_metrics.h"
+
+// wrap_text on large replies of mixed prose, fenced code and CJK, against
+// the word-at-a-time wrapper of earlier builds, which measured the whole
+// candidate line again for every word. Both measure through the cached
+// advance table; the characters the old wrapper measured are counted to
+// show the work it repeats. On the Vita each of those went through
+// vita2d_pgf_text_width.
+
+std::string thumbnail_path_for(const std::string& image_path) {
+    return image_path + ".thumb";
+}
+
+static size_t s_measured = 0;
+
+static std::vector<std::string> reference_wrap(const std::string& text, int max_width) {
+    std::vector<std::string> lines;
+    std::string current_line;
+    std::string word;
+    for (size_t i = 0; i <= text.size(); i++) {
+        char c = i < text.size() ? text[i] : '\n';
+        if (c != ' ' && c != '\n') {
+            word += c;
+            continue;
+        }
+        if (!word.empty()) {
+            std::string candidate = current_line + (current_line.empty() ? "" : " ") + word;
+            s_measured += candidate.size();
+            if (text_metrics_width(candidate) > max_width) {
+                lines.push_back(current_line);
+                current_line = word;
+            } else {
+                current_line = candidate;
+            }
+            word.clear();
+        }
+        if (c == '\n' && (i < text.size() || !current_line.empty())) {
+            lines.push_back(current_line);
+            current_line.clear();
+        }
+    }
+    return lines;
+}
+
+static std::string make_reply(size_t size) {
+    static const char* paragraphs[] = {
+        "The answer depends on how the request is framed, so here is a short overview of the options and what each one costs.\n\n",
+        "```cpp\nfor (int i = 0; i < count; i++) {\n    total += values[i] * weights[i];\n}\n```\n",
+        "\xe6\x9d\xb1\xe4\xba\xac\xe3\x81\xaf\xe6\x97\xa5\xe6\x9c\xac\xe3\x81\xae\xe9\xa6\x96\xe9\x83\xbd\xe3\x81\xa7\xe3\x81\x99\xe3\x80\x82"
+        "\xe4\xba\xba\xe5\x8f\xa3\xe3\x81\xaf\xe5\xa4\x9a\xe3\x81\x84\xe3\x81\xa7\xe3\x81\x99\xe3\x80\x82\n",
+        "- See https://example.com/docs/reference/wrapping?section=long-lines for details.\n",
+    };
+    std::string reply;
+    for (int i = 0; reply.size() < size; i++) {
+        reply += paragraphs[i % 4];
+    }
+    return reply;
+}
+
+static void run(size_t size) {
+    std::string reply = make_reply(size);
+    const int runs = 5;
+
+    std::vector<std::string> lines;
+    double start = now_us();
+    for (int i = 0; i < runs; i++) {
+        lines = wrap_text(NULL, reply, BUBBLE_CONTENT_WIDTH);
+    }
+    double wrap_us = (now_us() - start) / runs;
+
+    s_measured = 0;
+    start = now_us();
+    for (int i = 0; i < runs; i++) {
+        reference_wrap(reply, BUBBLE_CONTENT_WIDTH);
+    }
+    double reference_us = (now_us() - start) / runs;
+
+    printf("%4zu KB reply, %zu lines: wrap_text %7.0f us, %zu bytes measured; old wrapper %7.0f us, %zu bytes measured\n",
+           size / 1024, lines.size(), wrap_us, reply.size(), reference_us, s_measured / runs);
+}
+
+int main() {
+    text_metrics_init(native_text_metrics_source(NULL));
+    run(64 * 1024);
+    run(256 * 1024);
+    run(1024 * 1024);
+    text_metrics_shutdown();
+    return test_result();
+}
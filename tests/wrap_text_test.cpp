@@ -0,0 +1,198 @@
+// wrap_text from ui.cpp, measured through the text metrics with wide CJK
+// and emoji glyphs: lines never break inside a UTF-8 sequence or run past
+// the width, no text is lost, code blocks keep their line breaks, and text
+// without overlong words wraps as the word-at-a-time wrapper of earlier
+// builds did.
+
+#include "ui.h"
+#include "text_metrics.h"
+#include "test.h"
+
+std::string thumbnail_path_for(const std::string& image_path) {
+    return image_path + ".thumb";
+}
+
+// Spaces 5 px, full-width CJK 20 px, emoji and other astral code points 24 px, the rest 10 px
+static int advance(unsigned int codepoint, float) {
+    if (codepoint == ' ') return 5;
+    if ((codepoint >= 0x3000 && codepoint < 0xA000) || (codepoint >= 0xAC00 && codepoint < 0xD7B0) ||
+        (codepoint >= 0xFF00 && codepoint < 0xFFF0)) return 20;
+    if (codepoint >= 0x10000) return 24;
+    return 10;
+}
+
+static bool valid_utf8(const std::string& line) {
+    for (size_t i = 0; i < line.size();) {
+        unsigned char c = line[i];
+        size_t length = c < 0x80 ? 1 : c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+        if (c >= 0x80 && c < 0xC0) return false;
+        if (i + length > line.size()) return false;
+        for (size_t k = 1; k < length; k++) {
+            if (((unsigned char)line[i + k] & 0xC0) != 0x80) return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+static std::string without_whitespace(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c != ' ' && c != '\n') out += c;
+    }
+    return out;
+}
+
+// Checks what every wrap must hold and returns the lines
+static std::vector<std::string> wrap(const std::string& text, int width, bool check_utf8 = true) {
+    std::vector<float> widths;
+    std::vector<std::string> lines = wrap_text(NULL, text, width, &widths);
+    CHECK_EQ(widths.size(), lines.size());
+
+    std::string joined;
+    for (size_t i = 0; i < lines.size(); i++) {
+        CHECK(lines[i].size() <= text.size());
+        if (check_utf8) {
+            CHECK(valid_utf8(lines[i]));
+        }
+        if (i < widths.size()) {
+            CHECK_EQ(widths[i], (float)text_metrics_width(lines[i]));
+            CHECK(widths[i] <= width || lines[i].find(' ') == std::string::npos);
+        }
+        joined += lines[i];
+    }
+    CHECK_EQ(without_whitespace(joined), without_whitespace(text));
+    return lines;
+}
+
+static void test_words() {
+    CHECK(wrap("", 100).empty());
+
+    // 30 + 5 + 30 + 5 + 30 = 100 fits exactly; a fourth word moves down
+    std::vector<std::string> lines = wrap("aaa bbb ccc ddd", 100);
+    CHECK_EQ(lines.size(), 2u);
+    CHECK_EQ(lines[0], "aaa bbb ccc");
+    CHECK_EQ(lines[1], "ddd");
+
+    // Blank lines stay
+    lines = wrap("one\n\ntwo\n", 100);
+    CHECK_EQ(lines.size(), 3u);
+    CHECK_EQ(lines[1], "");
+}
+
+static void test_cjk() {
+    // Ten 20 px characters per 200 px line, broken between characters
+    std::string text;
+    for (int i = 0; i < 25; i++) {
+        text += "\xe6\xbc\xa2";  // 漢
+    }
+    std::vector<std::string> lines = wrap(text, 200);
+    CHECK_EQ(lines.size(), 3u);
+    CHECK_EQ(lines[0].size(), 30u);
+    CHECK_EQ(lines[2].size(), 15u);
+
+    // Mixed with Latin words, Hangul and full-width punctuation
+    wrap("Tokyo \xe6\x9d\xb1\xe4\xba\xac\xe3\x81\xaf\xe6\x97\xa5\xe6\x9c\xac\xe3\x81\xae\xe9\xa6\x96\xe9\x83\xbd\xe3\x80\x82 "
+         "\xec\x84\x9c\xec\x9a\xb8\xec\x9d\x80 \xed\x95\x9c\xea\xb5\xad\xec\x9d\x98 \xec\x88\x98\xeb\x8f\x84\xef\xbc\x81", 90);
+}
+
+static void test_emoji() {
+    std::string face = "\xf0\x9f\x98\x80";  // 😀, 24 px
+    std::string text;
+    for (int i = 0; i < 9; i++) {
+        text += face;
+    }
+    std::vector<std::string> lines = wrap(text, 100);
+    CHECK_EQ(lines.size(), 3u);
+    CHECK_EQ(lines[0], face + face + face + face);
+
+    // ZWJ sequences and flags are several code points; each still stays whole
+    wrap("ok \xf0\x9f\x91\xa9\xe2\x80\x8d\xf0\x9f\x92\xbb\xf0\x9f\x87\xaf\xf0\x9f\x87\xb5 done " + text, 60);
+}
+
+static void test_code_block() {
+    std::string url = "https://example.com/a/very/long/path/that/cannot/fit/on/one/line?query=1";
+    std::string text = "Run this:\n```\nint main() {\n    return 0;\n}\n```\nSee " + url;
+    std::vector<std::string> lines = wrap(text, 200);
+    CHECK(lines.size() >= 9u);
+    CHECK_EQ(lines[0], "Run this:");
+    CHECK_EQ(lines[1], "```");
+    CHECK_EQ(lines[2], "int main() {");
+    CHECK(lines[3].find("return 0;") != std::string::npos);
+    CHECK_EQ(lines[4], "}");
+    CHECK_EQ(lines[5], "```");
+    CHECK_EQ(lines[6], "See");
+
+    // The URL is broken between characters and fills each line
+    for (size_t i = 7; i + 1 < lines.size(); i++) {
+        CHECK_EQ(text_metrics_width(lines[i]), 200);
+    }
+}
+
+static void test_malformed() {
+    // Stray continuation bytes, a truncated sequence and bytes from 0xF8 up pass through one at a time
+    std::string text = std::string("ab\x80\x80 cd\xe6\xbc xy\xff\xfe z") + std::string(40, '\xf9');
+    wrap(text, 50, false);
+}
+
+// The wrapper of earlier builds: each word is appended to the line and the
+// whole candidate measured again
+static std::vector<std::string> reference_wrap(const std::string& text, int max_width) {
+    std::vector<std::string> lines;
+    std::string current_line;
+    std::string word;
+    for (size_t i = 0; i <= text.size(); i++) {
+        char c = i < text.size() ? text[i] : '\n';
+        if (c != ' ' && c != '\n') {
+            word += c;
+            continue;
+        }
+        if (!word.empty()) {
+            std::string candidate = current_line + (current_line.empty() ? "" : " ") + word;
+            if (text_metrics_width(candidate) > max_width) {
+                lines.push_back(current_line);
+                current_line = word;
+            } else {
+                current_line = candidate;
+            }
+            word.clear();
+        }
+        if (c == '\n' && (i < text.size() || !current_line.empty())) {
+            lines.push_back(current_line);
+            current_line.clear();
+        }
+    }
+    return lines;
+}
+
+static void test_matches_reference() {
+    static const char* words[] = { "a", "to", "the", "wrap", "model", "answer", "Vita", "screen", "quickly", "\xe6\xbc\xa2\xe5\xad\x97" };
+    unsigned int seed = 7;
+    for (int round = 0; round < 200; round++) {
+        std::string text;
+        int count = 1 + round % 60;
+        for (int i = 0; i < count; i++) {
+            seed = seed * 1103515245 + 12345;
+            text += words[(seed >> 16) % 10];
+            text += (seed >> 8) % 9 == 0 ? "\n" : " ";
+        }
+        int width = 80 + round % 200;
+        CHECK(wrap(text, width) == reference_wrap(text, width));
+    }
+}
+
+int main() {
+    TextMetricsSource metrics;
+    metrics.advance = advance;
+    text_metrics_init(metrics);
+
+    test_words();
+    test_cjk();
+    test_emoji();
+    test_code_block();
+    test_malformed();
+    test_matches_reference();
+
+    text_metrics_shutdown();
+    return test_result();
+}